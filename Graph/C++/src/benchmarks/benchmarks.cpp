@@ -0,0 +1,1521 @@
+#include "benchmarks.hpp"
+#include "graph.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <shared_mutex>
+#include <sstream>
+#include <span>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// bytes currently allocated with operator new (replaced below), to measure the memory of node-based containers
+std::atomic<size_t> allocatedBytes{0};
+
+// size of the header in front of every allocation, which records its size and keeps the alignment of operator new
+constexpr size_t ALLOCATION_HEADER = alignof(std::max_align_t);
+
+/**
+ * Get the number of bytes currently allocated with operator new.
+ * @return The number of bytes requested by live allocations, without the allocator overhead.
+ */
+size_t allocated_bytes() {
+    return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+/**
+ * Time a benchmark body and print the average time per operation.
+ * @param name The name of the measurement.
+ * @param operations The number of operations the body performs.
+ * @param body The function to time, returning a checksum that keeps the work from being optimized away.
+ */
+template <typename F>
+void report(const std::string& name, const size_t operations, F body) {
+    const Clock::time_point start = Clock::now();
+    const size_t checksum = body();
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    std::cout << std::left << std::setw(56) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << elapsed.count() / static_cast<double>(operations) << " ns/op"
+              << "  (checksum " << checksum << ")\n";
+}
+
+/**
+ * Generate a scale-free graph with the R-MAT model: every edge picks a quadrant of the adjacency matrix
+ * at every level, with probabilities (0.57, 0.19, 0.19, 0.05). Repeated edges are merged.
+ * @param scale The base 2 logarithm of the number of vertices.
+ * @param edgeFactor The number of edges generated per vertex.
+ * @return The graph, whose vertices are 0 to 2^scale - 1.
+ */
+GraphAdjacencyList<size_t> rmat_graph(const size_t scale, const size_t edgeFactor) {
+    const size_t vertexCount = size_t{1} << scale;
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (size_t i = 0; i < vertexCount * edgeFactor; ++i) {
+        size_t source = 0;
+        size_t target = 0;
+        for (size_t bit = 0; bit < scale; ++bit) {
+            const double quadrant = uniform(random);
+            source = (source << 1U) | (quadrant >= 0.76 ? 1U : 0U);
+            target = (target << 1U) | ((quadrant >= 0.57 && quadrant < 0.76) || quadrant >= 0.95 ? 1U : 0U);
+        }
+        graph.set_edge_weight(source, target, 1.0);
+    }
+    return graph;
+}
+
+/**
+ * Generate a road-like graph: a square grid where neighboring vertices are linked in both directions
+ * by edges of the same random weight in [1, 2), except on every 10th row and column, which are highways
+ * with 5 times smaller weights.
+ * @param width The number of vertices on a side of the grid.
+ * @return The graph, whose vertex y * width + x is at row y and column x.
+ */
+GraphAdjacencyList<size_t> grid_graph(const size_t width) {
+    constexpr size_t highwaySpacing = 10;
+    constexpr double highwaySpeed = 5.0;
+
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < width * width; ++i) {
+        graph.add_vertex(i);
+    }
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> weight(1.0, 2.0);
+    for (size_t i = 0; i < width * width; ++i) {
+        if ((i + 1) % width != 0) {
+            const double w = weight(random) / ((i / width) % highwaySpacing == 0 ? highwaySpeed : 1.0);
+            graph.set_edge_weight(i, i + 1, w);
+            graph.set_edge_weight(i + 1, i, w);
+        }
+        if (i + width < width * width) {
+            const double w = weight(random) / (i % highwaySpacing == 0 ? highwaySpeed : 1.0);
+            graph.set_edge_weight(i, i + width, w);
+            graph.set_edge_weight(i + width, i, w);
+        }
+    }
+    return graph;
+}
+
+/**
+ * State of recursive_tarjan().
+ */
+struct TarjanState {
+    std::vector<size_t> orders;
+    std::vector<size_t> lowLinks;
+    std::vector<bool> onStack;
+    std::vector<VertexId> pending;
+    size_t order = 0;
+    size_t count = 0;
+};
+
+/**
+ * Recursive Tarjan's algorithm over neighbors(), as a baseline: the depth of the recursion is the depth of the graph,
+ * and every step allocates a vector of neighbors. Vertices must be equal to their ids.
+ * @param graph The graph.
+ * @param id The id of the vertex to visit.
+ * @param state The state of the search, which counts the components.
+ */
+void recursive_tarjan(const GraphAdjacencyList<size_t>& graph, const VertexId id, TarjanState& state) {
+    state.orders[id] = state.lowLinks[id] = state.order++;
+    state.pending.push_back(id);
+    state.onStack[id] = true;
+    for (const VertexId neighbor : graph.neighbors(id)) {
+        if (state.orders[neighbor] == NO_COMPONENT) {
+            recursive_tarjan(graph, neighbor, state);
+            state.lowLinks[id] = std::min(state.lowLinks[id], state.lowLinks[neighbor]);
+        } else if (state.onStack[neighbor]) {
+            state.lowLinks[id] = std::min(state.lowLinks[id], state.orders[neighbor]);
+        }
+    }
+    if (state.lowLinks[id] == state.orders[id]) {
+        VertexId member = NO_VERTEX;
+        do {
+            member = state.pending.back();
+            state.pending.pop_back();
+            state.onStack[member] = false;
+        } while (member != id);
+        ++state.count;
+    }
+}
+
+/**
+ * Time neighbor scans and Dijkstra on an adjacency matrix with the given weight type.
+ * @param name The name of the weight type.
+ * @param vertexCount The number of vertices.
+ * @param edges The edges, with integer weights that fit in every weight type.
+ */
+template <typename W>
+void report_weight_type(const std::string& name, const size_t vertexCount, const std::vector<Edge<size_t>>& edges) {
+    GraphAdjacencyMatrix<size_t, W> graph;
+    graph.reserve(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    for (const Edge<size_t>& edge : edges) {
+        if constexpr (std::is_empty_v<W>) {
+            graph.set_edge_weight(edge.source, edge.target, W{});
+        } else {
+            graph.set_edge_weight(edge.source, edge.target, static_cast<W>(edge.weight));
+        }
+    }
+
+    std::cout << "  " << name << ": matrix of " << graph.matrix_bytes() / 1024 << " KiB\n";
+    report("for_each_neighbor() over all rows (" + name + ")", vertexCount, [&graph, vertexCount] {
+        double total = 0.0;
+        for (VertexId id = 0; id < vertexCount; ++id) {
+            graph.for_each_neighbor(id, [&total](VertexId, const W weight) {
+                total += weight;
+            });
+        }
+        return static_cast<size_t>(total);
+    });
+    constexpr size_t sourceCount = 4;
+    report("dijkstra() (" + name + ")", sourceCount, [&graph] {
+        double total = 0.0;
+        for (VertexId source = 0; source < sourceCount; ++source) {
+            const ShortestPaths paths = dijkstra(graph, source);
+            total += std::accumulate(paths.distances.begin(), paths.distances.end(), 0.0);
+        }
+        return static_cast<size_t>(total);
+    });
+}
+
+} // namespace
+
+void* operator new(const size_t size) {
+    // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+    void* block = std::malloc(size + ALLOCATION_HEADER);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return static_cast<std::byte*>(block) + ALLOCATION_HEADER;
+}
+
+void operator delete(void* pointer) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+    void* block = static_cast<std::byte*>(pointer) - ALLOCATION_HEADER;
+    allocatedBytes.fetch_sub(*static_cast<size_t*>(block), std::memory_order_relaxed);
+    // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+    std::free(block);
+}
+
+void operator delete(void* pointer, size_t /*size*/) noexcept {
+    operator delete(pointer);
+}
+
+// NOLINTBEGIN(bugprone-exception-escape)
+int main(const int argc, char *argv[]) {
+    if (argc != 2) {
+        return -2;
+    }
+
+    const std::string arg(argv[1]);
+
+    if (arg == "LookupMiss") {
+        benchmark_LookupMiss();
+    } else if (arg == "VertexRemoval") {
+        benchmark_VertexRemoval();
+    } else if (arg == "MatrixGrowth") {
+        benchmark_MatrixGrowth();
+    } else if (arg == "IncidenceEdges") {
+        benchmark_IncidenceEdges();
+    } else if (arg == "NeighborIteration") {
+        benchmark_NeighborIteration();
+    } else if (arg == "TraversalReset") {
+        benchmark_TraversalReset();
+    } else if (arg == "DirectionOptimizingBfs") {
+        benchmark_DirectionOptimizingBfs();
+    } else if (arg == "ConcurrentGraph") {
+        benchmark_ConcurrentGraph();
+    } else if (arg == "BitMatrix") {
+        benchmark_BitMatrix();
+    } else if (arg == "BulkEdges") {
+        benchmark_BulkEdges();
+    } else if (arg == "BinaryFile") {
+        benchmark_BinaryFile();
+    } else if (arg == "EdgeListReader") {
+        benchmark_EdgeListReader();
+    } else if (arg == "ConnectedComponents") {
+        benchmark_ConnectedComponents();
+    } else if (arg == "FloydWarshall") {
+        benchmark_FloydWarshall();
+    } else if (arg == "PageRank") {
+        benchmark_PageRank();
+    } else if (arg == "PointToPoint") {
+        benchmark_PointToPoint();
+    } else if (arg == "ContractionHierarchy") {
+        benchmark_ContractionHierarchy();
+    } else if (arg == "StronglyConnectedComponents") {
+        benchmark_StronglyConnectedComponents();
+    } else if (arg == "MinimumSpanningForest") {
+        benchmark_MinimumSpanningForest();
+    } else if (arg == "EdgeWeights") {
+        benchmark_EdgeWeights();
+    } else if (arg == "PredecessorIndex") {
+        benchmark_PredecessorIndex();
+    } else if (arg == "NeighborTables") {
+        benchmark_NeighborTables();
+    } else {
+        return -3;
+    }
+
+    return 0;
+}
+// NOLINTEND(bugprone-exception-escape)
+
+void benchmark_LookupMiss() {
+    // Compare the cost of exception-based and optional-based lookups on queries that miss
+    constexpr size_t vertexCount = 1000;
+    constexpr size_t queryCount = 200000;
+
+    GraphAdjacencyList<std::string> graph;
+    std::vector<std::string> vertices;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        vertices.push_back("vertex" + std::to_string(i));
+        graph.add_vertex(vertices.back());
+    }
+    for (size_t i = 0; i < vertexCount; ++i) {
+        for (size_t j = 1; j <= 4; ++j) {
+            graph.set_edge_weight(vertices[i], vertices[(i + j) % vertexCount], 1.0);
+        }
+    }
+    std::vector<std::string> missing;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        missing.push_back("missing" + std::to_string(i));
+    }
+
+    std::cout << "Vertex misses (" << queryCount << " queries):\n";
+    report("adjacent() + catch VertexNotFoundException", queryCount, [&] {
+        size_t misses = 0;
+        for (size_t i = 0; i < queryCount; ++i) {
+            try {
+                static_cast<void>(graph.adjacent(vertices[i % vertexCount], missing[i % vertexCount]));
+            } catch (const VertexNotFoundException& _) {
+                ++misses;
+            }
+        }
+        return misses;
+    });
+    report("try_get_edge_weight()", queryCount, [&] {
+        size_t misses = 0;
+        for (size_t i = 0; i < queryCount; ++i) {
+            if (!graph.try_get_edge_weight(vertices[i % vertexCount], missing[i % vertexCount]).has_value()) {
+                ++misses;
+            }
+        }
+        return misses;
+    });
+
+    // edge misses: both vertices exist, but there is no edge between them
+    std::unordered_map<size_t, double> neighbors;
+    for (size_t j = 1; j <= 4; ++j) {
+        neighbors[j] = 1.0;
+    }
+    std::cout << "Edge misses (" << queryCount << " queries):\n";
+    report("unordered_map::at() + catch (previous implementation)", queryCount, [&] {
+        size_t misses = 0;
+        for (size_t i = 0; i < queryCount; ++i) {
+            try {
+                static_cast<void>(neighbors.at(5 + (i % vertexCount)));
+            } catch (const std::out_of_range& _) {
+                ++misses;
+            }
+        }
+        return misses;
+    });
+    report("unordered_map::find()", queryCount, [&] {
+        size_t misses = 0;
+        for (size_t i = 0; i < queryCount; ++i) {
+            if (neighbors.find(5 + (i % vertexCount)) == neighbors.end()) {
+                ++misses;
+            }
+        }
+        return misses;
+    });
+    report("get_edge_weight()", queryCount, [&] {
+        size_t misses = 0;
+        for (size_t i = 0; i < queryCount; ++i) {
+            if (graph.get_edge_weight(vertices[i % vertexCount], vertices[(i + 500) % vertexCount]) == 0.0) {
+                ++misses;
+            }
+        }
+        return misses;
+    });
+    report("try_get_edge_weight()", queryCount, [&] {
+        size_t misses = 0;
+        for (size_t i = 0; i < queryCount; ++i) {
+            if (!graph.try_get_edge_weight(vertices[i % vertexCount], vertices[(i + 500) % vertexCount]).has_value()) {
+                ++misses;
+            }
+        }
+        return misses;
+    });
+}
+
+void benchmark_VertexRemoval() {
+    // Compare removing vertices with renumbering and with tombstones
+    constexpr size_t vertexCount = 10000;
+    constexpr size_t degree = 8;
+    constexpr size_t removalCount = 500;
+
+    for (const RemovalMode mode : {RemovalMode::Renumber, RemovalMode::Tombstone}) {
+        GraphAdjacencyList<size_t> graph;
+        for (size_t i = 0; i < vertexCount; ++i) {
+            graph.add_vertex(i);
+        }
+        for (size_t i = 0; i < vertexCount; ++i) {
+            for (size_t j = 1; j <= degree; ++j) {
+                graph.add_edge(i, (i + (j * j)) % vertexCount);
+            }
+        }
+        graph.set_removal_mode(mode);
+
+        const std::string name = mode == RemovalMode::Renumber ? "remove_vertex() (renumber)" : "remove_vertex() (tombstone)";
+        report(name, removalCount, [&graph] {
+            for (size_t i = 0; i < removalCount; ++i) {
+                graph.remove_vertex(i * (vertexCount / removalCount));
+            }
+            return graph.size();
+        });
+        if (mode == RemovalMode::Tombstone) {
+            report("compact()", 1, [&graph] {
+                return graph.compact().size();
+            });
+        }
+    }
+}
+
+void benchmark_MatrixGrowth() {
+    // Compare building a dense adjacency matrix vertex by vertex, in bulk, and after reserving
+    constexpr size_t vertexCount = 4000;
+
+    std::vector<size_t> vertices(vertexCount);
+    std::iota(vertices.begin(), vertices.end(), size_t{0});
+
+    report("add_vertex()", vertexCount, [&vertices] {
+        GraphAdjacencyMatrix<size_t> graph;
+        for (const size_t vertex : vertices) {
+            graph.add_vertex(vertex);
+        }
+        return graph.capacity();
+    });
+    report("reserve() + add_vertex()", vertexCount, [&vertices] {
+        GraphAdjacencyMatrix<size_t> graph;
+        graph.reserve(vertexCount);
+        for (const size_t vertex : vertices) {
+            graph.add_vertex(vertex);
+        }
+        return graph.capacity();
+    });
+    report("add_vertices()", vertexCount, [&vertices] {
+        GraphAdjacencyMatrix<size_t> graph;
+        return graph.add_vertices(vertices).size() + graph.capacity();
+    });
+}
+
+void benchmark_IncidenceEdges() {
+    // Compare adding and removing edges with the dense and the sparse incidence storage
+    constexpr size_t vertexCount = 300;
+    constexpr size_t edgeCount = 1500;
+
+    for (const IncidenceStorage storage : {IncidenceStorage::Dense, IncidenceStorage::Sparse}) {
+        const std::string suffix = storage == IncidenceStorage::Dense ? " (dense)" : " (sparse)";
+        GraphIncidenceMatrix<size_t> graph{storage};
+        for (size_t i = 0; i < vertexCount; ++i) {
+            graph.add_vertex(i);
+        }
+        report("set_edge_weight()" + suffix, edgeCount, [&graph] {
+            for (size_t i = 0; i < edgeCount; ++i) {
+                graph.set_edge_weight(i % vertexCount, (i + i / vertexCount + 1) % vertexCount, 1.0);
+            }
+            return graph.edge_count();
+        });
+        report("remove_edge()" + suffix, edgeCount, [&graph] {
+            for (size_t i = 0; i < edgeCount; ++i) {
+                graph.remove_edge(i % vertexCount, (i + i / vertexCount + 1) % vertexCount);
+            }
+            return graph.edge_count();
+        });
+    }
+}
+
+void benchmark_NeighborIteration() {
+    // Compare breadth-first searches using neighbors(), for_each_neighbor() and neighbor_range() on string vertices
+    constexpr size_t vertexCount = 20000;
+    constexpr size_t degree = 8;
+
+    GraphAdjacencyList<std::string> graph;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex("vertex" + std::to_string(i));
+    }
+    for (size_t i = 0; i < vertexCount; ++i) {
+        for (size_t j = 1; j <= degree; ++j) {
+            graph.set_edge_weight(graph.value_of(i), graph.value_of((i * j + j * j) % vertexCount), 1.0);
+        }
+    }
+
+    std::cout << "Breadth-first search (" << vertexCount << " vertices, " << graph.size() * degree << " edges):\n";
+    report("neighbors() (values)", vertexCount, [&graph] {
+        std::unordered_map<std::string, bool> visited;
+        std::vector<std::string> queue{graph.value_of(0)};
+        visited[queue.front()] = true;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            for (const std::string& neighbor : graph.neighbors(queue[head])) {
+                if (!visited[neighbor]) {
+                    visited[neighbor] = true;
+                    queue.push_back(neighbor);
+                }
+            }
+        }
+        return queue.size();
+    });
+    report("for_each_neighbor()", vertexCount, [&graph] {
+        std::vector<bool> visited(graph.id_bound());
+        std::vector<VertexId> queue{0};
+        visited[0] = true;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            graph.for_each_neighbor(queue[head], [&visited, &queue](const VertexId neighbor, double) {
+                if (!visited[neighbor]) {
+                    visited[neighbor] = true;
+                    queue.push_back(neighbor);
+                }
+            });
+        }
+        return queue.size();
+    });
+    report("neighbor_range()", vertexCount, [&graph] {
+        std::vector<bool> visited(graph.id_bound());
+        std::vector<VertexId> queue{0};
+        visited[0] = true;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            for (const Neighbor<std::string>& neighbor : graph.neighbor_range(queue[head])) {
+                if (!visited[neighbor.id]) {
+                    visited[neighbor.id] = true;
+                    queue.push_back(neighbor.id);
+                }
+            }
+        }
+        return queue.size();
+    });
+}
+
+void benchmark_TraversalReset() {
+    // Compare many small searches using the visited flags of the graph and a traversal state
+    constexpr size_t vertexCount = 100000;
+    constexpr size_t queryCount = 2000;
+    constexpr size_t chainLength = 8;
+
+    // short chains, so every search only reaches a few vertices
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    for (size_t i = 0; i < vertexCount; ++i) {
+        if ((i + 1) % chainLength != 0) {
+            graph.add_edge(i, i + 1);
+        }
+    }
+
+    std::cout << "Small searches (" << queryCount << " queries, " << vertexCount << " vertices):\n";
+    report("set_vertex_visited() + reset_vertices_visited()", queryCount, [&graph] {
+        size_t visitedCount = 0;
+        for (size_t i = 0; i < queryCount; ++i) {
+            graph.reset_vertices_visited();
+            std::vector<size_t> queue{(i * 7919) % vertexCount};
+            graph.set_vertex_visited(queue.front(), true);
+            for (size_t head = 0; head < queue.size(); ++head) {
+                ++visitedCount;
+                for (const size_t neighbor : graph.neighbors(queue[head])) {
+                    if (!graph.get_vertex_visited(neighbor)) {
+                        graph.set_vertex_visited(neighbor, true);
+                        queue.push_back(neighbor);
+                    }
+                }
+            }
+        }
+        return visitedCount;
+    });
+    report("TraversalState + breadth_first_search()", queryCount, [&graph] {
+        size_t visitedCount = 0;
+        TraversalState state;
+        for (size_t i = 0; i < queryCount; ++i) {
+            state.reset();
+            breadth_first_search(graph, graph.id_of((i * 7919) % vertexCount), state, [&visitedCount](VertexId) { ++visitedCount; });
+        }
+        return visitedCount;
+    });
+}
+
+void benchmark_DirectionOptimizingBfs() {
+    // Compare breadth-first searches on a scale-free (R-MAT) graph
+    constexpr size_t scale = 16;
+    constexpr size_t vertexCount = size_t{1} << scale;
+    constexpr size_t edgeFactor = 16;
+
+    const GraphAdjacencyList<size_t> graph = rmat_graph(scale, edgeFactor);
+    const GraphCSR<size_t> csr = graph.freeze();
+    const GraphCSR<size_t> transpose = csr.transpose();
+    std::vector<size_t> threadCounts{1};
+    if (resolve_thread_count(0) > 1) {
+        threadCounts.push_back(resolve_thread_count(0));
+    }
+
+    std::cout << "Breadth-first search (R-MAT, " << vertexCount << " vertices, " << csr.edge_count() << " edges, time per edge):\n";
+    report("neighbors() (values, adjacency list)", csr.edge_count(), [&graph] {
+        std::vector<size_t> distances(graph.id_bound(), UNREACHABLE);
+        std::vector<size_t> queue{0};
+        distances[0] = 0;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            for (const size_t neighbor : graph.neighbors(queue[head])) {
+                if (distances[neighbor] == UNREACHABLE) {
+                    distances[neighbor] = distances[queue[head]] + 1;
+                    queue.push_back(neighbor);
+                }
+            }
+        }
+        return queue.size();
+    });
+    report("breadth_first_search() (CSR)", csr.edge_count(), [&csr] {
+        TraversalState state;
+        size_t visitedCount = 0;
+        breadth_first_search(csr, 0, state, [&visitedCount](VertexId) { ++visitedCount; });
+        return visitedCount;
+    });
+    for (const size_t threads : threadCounts) {
+        report("direction_optimizing_bfs() (" + std::to_string(threads) + " threads)", csr.edge_count(), [&csr, &transpose, threads] {
+            const BreadthFirstTree tree = direction_optimizing_bfs(csr, transpose, 0, threads);
+            return static_cast<size_t>(std::ranges::count_if(tree.distances, [](const size_t distance) { return distance != UNREACHABLE; }));
+        });
+    }
+}
+
+void benchmark_ConcurrentGraph() {
+    // Compare the read throughput of a concurrent graph and of a graph behind a reader-writer lock,
+    // while a writer thread applies batches of edge weight updates at different rates
+    constexpr size_t vertexCount = 10000;
+    constexpr size_t degree = 8;
+    constexpr size_t readsPerReader = 400000;
+    constexpr size_t updatesPerBatch = 100;
+    const size_t readerCount = std::max<size_t>(resolve_thread_count(0), 2);
+
+    GraphAdjacencyList<size_t> initial;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        initial.add_vertex(i);
+    }
+    for (size_t i = 0; i < vertexCount; ++i) {
+        for (size_t j = 1; j <= degree; ++j) {
+            initial.set_edge_weight(i, (i * j + 1) % vertexCount, 1.0);
+        }
+    }
+    const auto applyBatch = [](GraphAdjacencyList<size_t>& graph, const size_t batch) {
+        for (size_t i = 0; i < updatesPerBatch; ++i) {
+            const size_t source = (batch * updatesPerBatch + i) % vertexCount;
+            graph.set_edge_weight(source, (source + 1) % vertexCount, static_cast<double>(batch));
+        }
+    };
+
+    // run the readers while a writer publishes a batch every interval (no writer for a negative interval),
+    // returning the number of published batches
+    const auto run = [readerCount](const std::chrono::microseconds interval, const auto& read, const auto& write) {
+        std::atomic<bool> stop = false;
+        size_t batchCount = 0;
+        std::jthread writer([&stop, &batchCount, &write, interval] {
+            while (interval.count() >= 0 && !stop.load()) {
+                write(++batchCount);
+                std::this_thread::sleep_for(interval);
+            }
+        });
+        std::vector<std::jthread> readers;
+        for (size_t r = 0; r < readerCount; ++r) {
+            readers.emplace_back([&read, r] {
+                for (size_t i = 0; i < readsPerReader; ++i) {
+                    read((r * readsPerReader + i * 7919) % vertexCount);
+                }
+            });
+        }
+        readers.clear();
+        stop = true;
+        writer.join();
+        return batchCount;
+    };
+
+    std::cout << "Concurrent reads (" << readerCount << " readers, " << updatesPerBatch << " updates per batch):\n";
+    for (const long long interval : {-1LL, 10000LL, 1000LL, 0LL}) {
+        std::string rate = interval < 0 ? "no writer" : "batch every " + std::to_string(interval) + " us";
+        if (interval == 0) {
+            rate = "batches back to back";
+        }
+
+        ConcurrentGraph<GraphAdjacencyList<size_t>> concurrent{initial};
+        report("ConcurrentGraph::snapshot() + read (" + rate + ")", readerCount * readsPerReader, [&] {
+            return run(
+                std::chrono::microseconds(interval),
+                [&concurrent](const VertexId id) {
+                    const auto snapshot = concurrent.snapshot();
+                    static_cast<void>(snapshot->graph.try_get_edge_weight(id, (id + 1) % vertexCount));
+                },
+                [&concurrent, &applyBatch](const size_t batch) {
+                    concurrent.update([&applyBatch, batch](GraphAdjacencyList<size_t>& graph) { applyBatch(graph, batch); });
+                });
+        });
+
+        GraphAdjacencyList<size_t> locked{initial};
+        std::shared_mutex mutex;
+        report("shared_mutex + read (" + rate + ")", readerCount * readsPerReader, [&] {
+            return run(
+                std::chrono::microseconds(interval),
+                [&locked, &mutex](const VertexId id) {
+                    const std::shared_lock lock(mutex);
+                    static_cast<void>(locked.try_get_edge_weight(id, (id + 1) % vertexCount));
+                },
+                [&locked, &mutex, &applyBatch](const size_t batch) {
+                    const std::unique_lock lock(mutex);
+                    applyBatch(locked, batch);
+                });
+        });
+    }
+}
+
+void benchmark_BitMatrix() {
+    // Compare neighborhood intersections on a dense undirected graph stored as a bit matrix and as a CSR snapshot
+    constexpr size_t vertexCount = 4000;
+    constexpr size_t pairCount = 200000;
+    constexpr double density = 0.05;
+
+    GraphAdjacencyBitMatrix<size_t> bits;
+    GraphAdjacencyList<size_t> list;
+    std::mt19937_64 random(7);
+    std::bernoulli_distribution coin(density);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        bits.add_vertex(i);
+        list.add_vertex(i);
+    }
+    for (size_t u = 0; u < vertexCount; ++u) {
+        for (size_t v = u + 1; v < vertexCount; ++v) {
+            if (coin(random)) {
+                bits.add_edge(u, v);
+                bits.add_edge(v, u);
+                list.set_edge_weight(u, v, 1.0);
+                list.set_edge_weight(v, u, 1.0);
+            }
+        }
+    }
+    const GraphCSR<size_t> csr = list.freeze();
+
+    std::cout << "Dense graph (" << vertexCount << " vertices, " << csr.edge_count() << " edges), matrix memory: "
+              << bits.capacity() * bits.capacity() / 8 << " bytes (bits), " << bits.capacity() * bits.capacity() * sizeof(double)
+              << " bytes (doubles)\n";
+    report("common_neighbor_count() (bit matrix)", pairCount, [&bits] {
+        size_t total = 0;
+        for (size_t i = 0; i < pairCount; ++i) {
+            total += bits.common_neighbor_count(i % vertexCount, (i * 7919) % vertexCount);
+        }
+        return total;
+    });
+    report("sorted merge of neighbor_ids() (CSR)", pairCount, [&csr] {
+        size_t total = 0;
+        for (size_t i = 0; i < pairCount; ++i) {
+            const std::span<const VertexId> first = csr.neighbor_ids(i % vertexCount);
+            const std::span<const VertexId> second = csr.neighbor_ids((i * 7919) % vertexCount);
+            std::vector<VertexId> common;
+            std::ranges::set_intersection(first, second, std::back_inserter(common));
+            total += common.size();
+        }
+        return total;
+    });
+    report("triangle_count() (bit matrix)", 1, [&bits] {
+        return bits.triangle_count();
+    });
+    report("triangle count by sorted merges (CSR)", 1, [&csr] {
+        size_t total = 0;
+        for (VertexId u = 0; u < vertexCount; ++u) {
+            for (const VertexId v : csr.neighbor_ids(u)) {
+                if (v <= u) {
+                    continue;
+                }
+                const std::span<const VertexId> first = csr.neighbor_ids(u);
+                const std::span<const VertexId> second = csr.neighbor_ids(v);
+                auto it1 = std::ranges::upper_bound(first, v);
+                auto it2 = std::ranges::upper_bound(second, v);
+                while (it1 != first.end() && it2 != second.end()) {
+                    if (*it1 < *it2) {
+                        ++it1;
+                    } else if (*it2 < *it1) {
+                        ++it2;
+                    } else {
+                        ++total;
+                        ++it1;
+                        ++it2;
+                    }
+                }
+            }
+        }
+        return total;
+    });
+}
+
+void benchmark_BulkEdges() {
+    // Compare adding edges one by one and in bulk, with and without threads
+    constexpr size_t vertexCount = size_t{1} << 16;
+    constexpr size_t edgeCount = size_t{1} << 20;
+
+    std::vector<Edge<size_t>> edges;
+    edges.reserve(edgeCount);
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<size_t> vertex(0, vertexCount - 1);
+    for (size_t i = 0; i < edgeCount; ++i) {
+        edges.push_back({vertex(random), vertex(random), 1.0});
+    }
+    GraphAdjacencyList<size_t> empty;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        empty.add_vertex(i);
+    }
+    std::vector<size_t> threadCounts{1};
+    if (resolve_thread_count(0) > 1) {
+        threadCounts.push_back(resolve_thread_count(0));
+    }
+
+    std::cout << "Adjacency list (" << vertexCount << " vertices, " << edgeCount << " edges, time per edge):\n";
+    report("adjacent() + add_edge()", edgeCount, [&empty, &edges] {
+        GraphAdjacencyList<size_t> graph = empty;
+        for (const Edge<size_t>& edge : edges) {
+            if (!graph.adjacent(edge.source, edge.target)) {
+                graph.add_edge(edge.source, edge.target);
+            }
+        }
+        return graph.size();
+    });
+    for (const size_t threads : threadCounts) {
+        report("add_edges() (" + std::to_string(threads) + " threads)", edgeCount, [&empty, &edges, threads] {
+            GraphAdjacencyList<size_t> graph = empty;
+            graph.add_edges(edges, DuplicatePolicy::KeepFirst, threads);
+            return graph.size();
+        });
+    }
+    report("GraphBuilder::build()", edgeCount, [&edges] {
+        GraphBuilder<size_t> builder;
+        builder.add_edges(edges);
+        return builder.build<GraphAdjacencyList<size_t>>(DuplicatePolicy::KeepFirst).size();
+    });
+
+    constexpr size_t incidenceVertexCount = 300;
+    constexpr size_t incidenceEdgeCount = 1500;
+    std::vector<Edge<size_t>> incidenceEdges;
+    for (size_t i = 0; i < incidenceEdgeCount; ++i) {
+        incidenceEdges.push_back({edges[i].source % incidenceVertexCount, edges[i].target % incidenceVertexCount, 1.0});
+    }
+    GraphIncidenceMatrix<size_t> incidence;
+    for (size_t i = 0; i < incidenceVertexCount; ++i) {
+        incidence.add_vertex(i);
+    }
+    std::cout << "Dense incidence matrix (" << incidenceVertexCount << " vertices, " << incidenceEdgeCount << " edges, time per edge):\n";
+    report("adjacent() + add_edge()", incidenceEdgeCount, [&incidence, &incidenceEdges] {
+        GraphIncidenceMatrix<size_t> graph = incidence;
+        for (const Edge<size_t>& edge : incidenceEdges) {
+            if (!graph.adjacent(edge.source, edge.target)) {
+                graph.add_edge(edge.source, edge.target);
+            }
+        }
+        return graph.edge_count();
+    });
+    report("add_edges()", incidenceEdgeCount, [&incidence, &incidenceEdges] {
+        GraphIncidenceMatrix<size_t> graph = incidence;
+        graph.add_edges(incidenceEdges, DuplicatePolicy::KeepFirst);
+        return graph.edge_count();
+    });
+}
+
+void benchmark_BinaryFile() {
+    // Compare getting a graph ready to traverse by rebuilding it from its edges and by mapping a saved file
+    constexpr size_t vertexCount = size_t{1} << 18;
+    constexpr size_t edgeCount = size_t{1} << 22;
+
+    GraphBuilder<size_t> builder;
+    builder.reserve(edgeCount);
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<size_t> vertex(0, vertexCount - 1);
+    for (size_t i = 0; i < edgeCount; ++i) {
+        builder.add_edge(vertex(random), vertex(random));
+    }
+    const std::string path = std::filesystem::temp_directory_path() / "graph_benchmark_BinaryFile.bin";
+
+    std::cout << "Loading a graph (" << vertexCount << " vertices, " << edgeCount << " edges, time per edge):\n";
+    report("GraphBuilder::build() + freeze()", edgeCount, [&builder, &path] {
+        const GraphCSR<size_t> csr = builder.build<GraphAdjacencyList<size_t>>(DuplicatePolicy::KeepFirst).freeze();
+        csr.save_binary(path);
+        return csr.edge_count();
+    });
+    report("load_mmap()", edgeCount, [&path] {
+        return GraphCSR<size_t>::load_mmap(path).edge_count();
+    });
+    report("load_mmap() + breadth-first search", edgeCount, [&path] {
+        const GraphCSR<size_t> csr = GraphCSR<size_t>::load_mmap(path);
+        TraversalState state;
+        size_t visitedCount = 0;
+        breadth_first_search(csr, 0, state, [&visitedCount](VertexId) { ++visitedCount; });
+        return visitedCount;
+    });
+    std::filesystem::remove(path);
+}
+
+void benchmark_EdgeListReader() {
+    // Compare the parse throughput of reading an edge list with std::ifstream and with EdgeListReader
+    constexpr size_t vertexCount = size_t{1} << 20;
+    constexpr size_t edgeCount = size_t{1} << 22;
+
+    const std::string path = std::filesystem::temp_directory_path() / "graph_benchmark_EdgeListReader.txt";
+    {
+        std::ofstream file(path);
+        file << "# Directed graph\n# FromNodeId\tToNodeId\tWeight\n";
+        std::mt19937_64 random(42);
+        std::uniform_int_distribution<size_t> vertex(0, vertexCount - 1);
+        for (size_t i = 0; i < edgeCount; ++i) {
+            file << vertex(random) << '\t' << vertex(random) << '\t' << 0.25 * static_cast<double>(i % 16) + 0.5 << '\n';
+        }
+    }
+    const double megabytes = static_cast<double>(std::filesystem::file_size(path)) / 1e6;
+    std::vector<size_t> threadCounts{1};
+    if (resolve_thread_count(0) > 1) {
+        threadCounts.push_back(resolve_thread_count(0));
+    }
+
+    std::cout << "Reading an edge list (" << std::fixed << std::setprecision(1) << megabytes << " MB, " << edgeCount << " edges):\n";
+    const Clock::time_point start = Clock::now();
+    std::ifstream file(path);
+    std::string line;
+    GraphBuilder<size_t> streamBuilder;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line[0] != '#') {
+            std::istringstream fields(line);
+            size_t source = 0;
+            size_t target = 0;
+            double weight = 1.0;
+            fields >> source >> target >> weight;
+            streamBuilder.add_edge(source, target, weight);
+        }
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    std::cout << std::left << std::setw(56) << "std::getline() + std::istringstream" << std::right << std::setw(12)
+              << megabytes / elapsed.count() << " MB/s  (checksum " << streamBuilder.edge_count() << ")\n";
+
+    for (const size_t threads : threadCounts) {
+        GraphBuilder<size_t> builder;
+        const EdgeListStats stats = EdgeListReader<size_t>(EdgeListFormat::Snap, threads).read(path, builder);
+        std::cout << std::left << std::setw(56) << "EdgeListReader (" + std::to_string(threads) + " threads)" << std::right << std::setw(12)
+                  << stats.megabytes_per_second() << " MB/s  (checksum " << builder.edge_count() << ")\n";
+    }
+    std::filesystem::remove(path);
+}
+
+void benchmark_ConnectedComponents() {
+    // Compare connected components with sequential traversals and with the parallel union-find, from 1 to N threads
+    constexpr size_t scale = 17;
+    constexpr size_t edgeFactor = 8;
+
+    const GraphCSR<size_t> csr = rmat_graph(scale, edgeFactor).freeze();
+    const GraphCSR<size_t> transpose = csr.transpose();
+    std::cout << "Connected components (R-MAT, " << csr.size() << " vertices, " << csr.edge_count() << " edges, time per edge):\n";
+    report("breadth-first searches (both directions)", csr.edge_count(), [&csr, &transpose] {
+        std::vector<size_t> labels(csr.id_bound(), NO_COMPONENT);
+        std::vector<VertexId> queue;
+        size_t count = 0;
+        for (VertexId start = 0; start < csr.id_bound(); ++start) {
+            if (labels[start] != NO_COMPONENT) {
+                continue;
+            }
+            queue.assign(1, start);
+            labels[start] = count;
+            for (size_t head = 0; head < queue.size(); ++head) {
+                for (const GraphCSR<size_t>* side : {&csr, &transpose}) {
+                    for (const VertexId neighbor : side->neighbor_ids(queue[head])) {
+                        if (labels[neighbor] == NO_COMPONENT) {
+                            labels[neighbor] = count;
+                            queue.push_back(neighbor);
+                        }
+                    }
+                }
+            }
+            ++count;
+        }
+        return count;
+    });
+    for (size_t threads = 1;; threads = std::min(2 * threads, resolve_thread_count(0))) {
+        report("connected_components() (" + std::to_string(threads) + " threads)", csr.edge_count(), [&csr, threads] {
+            return connected_components(csr, threads).count;
+        });
+        if (threads == resolve_thread_count(0)) {
+            break;
+        }
+    }
+}
+
+void benchmark_FloydWarshall() {
+    // Compare the textbook Floyd-Warshall triple loop with the tiled one, on a dense random graph
+    constexpr size_t vertexCount = 1000;
+
+    GraphAdjacencyMatrix<size_t> graph;
+    graph.reserve(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<size_t> vertex(0, vertexCount - 1);
+    std::uniform_real_distribution<double> weight(1.0, 100.0);
+    for (size_t i = 0; i < vertexCount * 20; ++i) {
+        graph.set_edge_weight(vertex(random), vertex(random), weight(random));
+    }
+    std::vector<size_t> threadCounts{1};
+    if (resolve_thread_count(0) > 1) {
+        threadCounts.push_back(resolve_thread_count(0));
+    }
+
+    constexpr size_t updateCount = vertexCount * vertexCount * vertexCount;
+    std::cout << "All-pairs shortest paths (" << vertexCount << " vertices, time per relaxation):\n";
+    report("triple loop", updateCount, [&graph] {
+        std::vector<double> distances(vertexCount * vertexCount, std::numeric_limits<double>::infinity());
+        std::vector<VertexId> next(vertexCount * vertexCount, NO_VERTEX);
+        for (VertexId i = 0; i < vertexCount; ++i) {
+            distances[i * vertexCount + i] = 0.0;
+            next[i * vertexCount + i] = i;
+            graph.for_each_neighbor(i, [&distances, &next, i](const VertexId j, const double w) {
+                distances[i * vertexCount + j] = std::min(distances[i * vertexCount + j], w);
+                next[i * vertexCount + j] = j;
+            });
+        }
+        for (size_t k = 0; k < vertexCount; ++k) {
+            for (size_t i = 0; i < vertexCount; ++i) {
+                for (size_t j = 0; j < vertexCount; ++j) {
+                    if (distances[i * vertexCount + k] + distances[k * vertexCount + j] < distances[i * vertexCount + j]) {
+                        distances[i * vertexCount + j] = distances[i * vertexCount + k] + distances[k * vertexCount + j];
+                        next[i * vertexCount + j] = next[i * vertexCount + k];
+                    }
+                }
+            }
+        }
+        return static_cast<size_t>(std::ranges::count(next, NO_VERTEX));
+    });
+    for (const size_t threads : threadCounts) {
+        report("floyd_warshall() (" + std::to_string(threads) + " threads)", updateCount, [&graph, threads] {
+            return static_cast<size_t>(std::ranges::count(floyd_warshall(graph, threads).next, NO_VERTEX));
+        });
+    }
+}
+
+void benchmark_PageRank() {
+    // Compare a sequential push-based PageRank with the parallel pull-based one, from 1 to N threads
+    constexpr size_t scale = 17;
+    constexpr size_t edgeFactor = 8;
+    constexpr size_t iterationCount = 20;
+
+    const GraphCSR<size_t> csr = rmat_graph(scale, edgeFactor).freeze();
+    const GraphCSR<size_t> transpose = csr.transpose();
+    const size_t vertexCount = csr.id_bound();
+    // the checksum is the id of the highest ranked vertex
+    const auto top = [](const std::vector<double>& ranks) {
+        return static_cast<size_t>(std::ranges::max_element(ranks) - ranks.begin());
+    };
+    std::cout << "PageRank (R-MAT, " << csr.size() << " vertices, " << csr.edge_count() << " edges, " << iterationCount
+              << " iterations, time per edge per iteration):\n";
+    report("push-based power iteration", csr.edge_count() * iterationCount, [&] {
+        std::vector<double> ranks(vertexCount, 1.0 / static_cast<double>(vertexCount));
+        std::vector<double> next(vertexCount);
+        for (size_t iteration = 0; iteration < iterationCount; ++iteration) {
+            double dangling = 0.0;
+            std::ranges::fill(next, 0.0);
+            for (VertexId id = 0; id < vertexCount; ++id) {
+                const std::span<const VertexId> targets = csr.neighbor_ids(id);
+                if (targets.empty()) {
+                    dangling += ranks[id];
+                }
+                for (const VertexId target : targets) {
+                    next[target] += ranks[id] / static_cast<double>(targets.size());
+                }
+            }
+            for (VertexId id = 0; id < vertexCount; ++id) {
+                ranks[id] = (0.15 + 0.85 * dangling) / static_cast<double>(vertexCount) + 0.85 * next[id];
+            }
+        }
+        return top(ranks);
+    });
+    for (size_t threads = 1;; threads = std::min(2 * threads, resolve_thread_count(0))) {
+        double edgesPerSecond = 0.0;
+        report("pagerank() (" + std::to_string(threads) + " threads)", csr.edge_count() * iterationCount, [&, threads] {
+            const PageRanks result = pagerank(csr, transpose, 0.85, 0.0, iterationCount, threads);
+            edgesPerSecond = result.edges_per_second();
+            return top(result.ranks);
+        });
+        std::cout << "    " << std::setprecision(1) << edgesPerSecond / 1e6 << " million edges/s per iteration\n";
+        if (threads == resolve_thread_count(0)) {
+            break;
+        }
+    }
+}
+
+void benchmark_PointToPoint() {
+    // Compare point-to-point searches on a road-like grid: Dijkstra with early exit, A* with the Manhattan distance, and bidirectional Dijkstra
+    constexpr size_t width = 400;
+    constexpr size_t queryCount = 100;
+
+    const GraphCSR<size_t> csr = grid_graph(width).freeze();
+    const GraphCSR<size_t> transpose = csr.transpose();
+    std::mt19937_64 random(7);
+    std::uniform_int_distribution<VertexId> vertex(0, width * width - 1);
+    std::vector<std::pair<VertexId, VertexId>> queries;
+    for (size_t i = 0; i < queryCount; ++i) {
+        queries.emplace_back(vertex(random), vertex(random));
+    }
+    // vertices were added in order, so the id of a vertex is its position in the grid,
+    // and edges weigh at least 0.2 (on highways), so 0.2 times the Manhattan distance never overestimates
+    const auto manhattan = [](const VertexId target) {
+        return [target](const VertexId id) {
+            const auto distance = [](const size_t a, const size_t b) {
+                return a < b ? b - a : a - b;
+            };
+            return 0.2 * static_cast<double>(distance(id % width, target % width) + distance(id / width, target / width));
+        };
+    };
+
+    std::cout << "Point-to-point shortest paths (" << width << "x" << width << " grid, time per query):\n";
+    report("dijkstra() with a target", queryCount, [&] {
+        double total = 0.0;
+        for (const auto& [source, target] : queries) {
+            total += dijkstra(csr, source, target).distances[target];
+        }
+        return static_cast<size_t>(total);
+    });
+    const auto search = [&](const std::string& name, const auto& query) {
+        size_t settled = 0;
+        report(name, queryCount, [&] {
+            double total = 0.0;
+            for (const auto& [source, target] : queries) {
+                const PointToPointPath path = query(source, target);
+                total += path.distance;
+                settled += path.settled;
+            }
+            return static_cast<size_t>(total);
+        });
+        std::cout << "    " << settled / queryCount << " vertices settled per query\n";
+    };
+    search("a_star() with a zero heuristic", [&csr](const VertexId source, const VertexId target) {
+        return a_star(csr, source, target, [](VertexId) {
+            return 0.0;
+        });
+    });
+    search("a_star() with the Manhattan distance", [&csr, &manhattan](const VertexId source, const VertexId target) {
+        return a_star(csr, source, target, manhattan(target));
+    });
+    search("bidirectional_dijkstra()", [&csr, &transpose](const VertexId source, const VertexId target) {
+        return bidirectional_dijkstra(csr, transpose, source, target);
+    });
+}
+
+void benchmark_ContractionHierarchy() {
+    // Compare the preprocessing and queries of a contraction hierarchy with Dijkstra and bidirectional Dijkstra on a road-like grid
+    constexpr size_t width = 300;
+    constexpr size_t queryCount = 1000;
+
+    const GraphAdjacencyList<size_t> graph = grid_graph(width);
+    const GraphCSR<size_t> csr = graph.freeze();
+    const GraphCSR<size_t> transpose = csr.transpose();
+    std::mt19937_64 random(7);
+    std::uniform_int_distribution<VertexId> vertex(0, width * width - 1);
+    std::vector<std::pair<VertexId, VertexId>> queries;
+    for (size_t i = 0; i < queryCount; ++i) {
+        queries.emplace_back(vertex(random), vertex(random));
+    }
+
+    std::cout << "Contraction hierarchy (" << width << "x" << width << " grid):\n";
+    std::optional<ContractionHierarchy> hierarchy;
+    report("preprocessing (time per vertex)", graph.size(), [&graph, &hierarchy] {
+        hierarchy.emplace(graph);
+        return hierarchy->shortcut_count();
+    });
+    std::cout << "    " << hierarchy->shortcut_count() << " shortcuts\n";
+
+    // the checksum is the sum of the distances, rounded down
+    report("dijkstra() with a target (time per query)", queryCount / 10, [&csr, &queries] {
+        double total = 0.0;
+        for (size_t i = 0; i < queryCount / 10; ++i) {
+            total += dijkstra(csr, queries[i].first, queries[i].second).distances[queries[i].second];
+        }
+        return static_cast<size_t>(total);
+    });
+    const auto search = [&queries](const std::string& name, const auto& query) {
+        size_t settled = 0;
+        report(name, queryCount, [&] {
+            double total = 0.0;
+            for (const auto& [source, target] : queries) {
+                const PointToPointPath path = query(source, target);
+                total += path.distance;
+                settled += path.settled;
+            }
+            return static_cast<size_t>(total);
+        });
+        std::cout << "    " << settled / queryCount << " vertices settled per query\n";
+    };
+    search("bidirectional_dijkstra() (time per query)", [&csr, &transpose](const VertexId source, const VertexId target) {
+        return bidirectional_dijkstra(csr, transpose, source, target);
+    });
+    ContractionHierarchy::Query query(*hierarchy);
+    search("ContractionHierarchy::Query (time per query)", [&query](const VertexId source, const VertexId target) {
+        return query.shortest_path(source, target);
+    });
+}
+
+void benchmark_StronglyConnectedComponents() {
+    // Compare a recursive Tarjan's algorithm with the iterative one and with Kahn's topological sort, on chains
+    constexpr size_t shortLength = 10000;
+    constexpr size_t longLength = 1000000;
+
+    const auto chain = [](const size_t length) {
+        GraphAdjacencyList<size_t> graph;
+        for (size_t i = 0; i < length; ++i) {
+            graph.add_vertex(i);
+        }
+        for (size_t i = 0; i + 1 < length; ++i) {
+            graph.add_edge(i, i + 1);
+        }
+        return graph;
+    };
+    const GraphAdjacencyList<size_t> shortChain = chain(shortLength);
+    const GraphAdjacencyList<size_t> longChain = chain(longLength);
+    const GraphCSR<size_t> longCsr = longChain.freeze();
+
+    std::cout << "Strongly connected components and topological sort (chains, time per vertex):\n";
+    report("recursive Tarjan (" + std::to_string(shortLength) + " vertices)", shortLength, [&shortChain] {
+        TarjanState state{std::vector<size_t>(shortLength, NO_COMPONENT), std::vector<size_t>(shortLength), std::vector<bool>(shortLength), {}};
+        for (VertexId id = 0; id < shortLength; ++id) {
+            if (state.orders[id] == NO_COMPONENT) {
+                recursive_tarjan(shortChain, id, state);
+            }
+        }
+        return state.count;
+    });
+    report("strongly_connected_components() (" + std::to_string(shortLength) + " vertices)", shortLength, [&shortChain] {
+        return strongly_connected_components(shortChain).count;
+    });
+    report("strongly_connected_components() (" + std::to_string(longLength) + " vertices)", longLength, [&longChain] {
+        return strongly_connected_components(longChain).count;
+    });
+    report("strongly_connected_components() (" + std::to_string(longLength) + ", GraphCSR)", longLength, [&longCsr] {
+        return strongly_connected_components(longCsr).count;
+    });
+    report("topological_sort() (" + std::to_string(longLength) + " vertices)", longLength, [&longChain] {
+        return topological_sort(longChain)->back();
+    });
+    report("topological_sort() (" + std::to_string(longLength) + ", GraphCSR)", longLength, [&longCsr] {
+        return topological_sort(longCsr)->back();
+    });
+}
+
+void benchmark_MinimumSpanningForest() {
+    // Compare Kruskal's algorithm with Borůvka's algorithm on a random graph with random weights, from 1 to N threads
+    constexpr size_t vertexCount = 1U << 17U;
+    constexpr size_t edgeFactor = 8;
+
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<size_t> vertex(0, vertexCount - 1);
+    std::uniform_real_distribution<double> weight(0.0, 1.0);
+    for (size_t i = 0; i < vertexCount * edgeFactor; ++i) {
+        graph.set_edge_weight(vertex(random), vertex(random), weight(random));
+    }
+    const GraphCSR<size_t> csr = graph.freeze();
+
+    std::cout << "Minimum spanning forest (" << vertexCount << " vertices, " << csr.edge_count() << " edges, time per edge):\n";
+    for (size_t threads = 1;; threads = std::min(2 * threads, resolve_thread_count(0))) {
+        // the checksum is the number of edges of the forest
+        report("kruskal() on the adjacency list (" + std::to_string(threads) + " threads)", csr.edge_count(), [&graph, threads] {
+            return kruskal(graph, threads).edges.size();
+        });
+        report("kruskal() on the snapshot (" + std::to_string(threads) + " threads)", csr.edge_count(), [&csr, threads] {
+            return kruskal(csr, threads).edges.size();
+        });
+        report("boruvka() on the adjacency list (" + std::to_string(threads) + " threads)", csr.edge_count(), [&graph, threads] {
+            return boruvka(graph, threads).edges.size();
+        });
+        report("boruvka() on the snapshot (" + std::to_string(threads) + " threads)", csr.edge_count(), [&csr, threads] {
+            return boruvka(csr, threads).edges.size();
+        });
+        if (threads == resolve_thread_count(0)) {
+            break;
+        }
+    }
+}
+
+void benchmark_EdgeWeights() {
+    // Compare the memory and the speed of adjacency matrices with narrower weight types than double
+    constexpr size_t vertexCount = 3000;
+    constexpr double density = 0.05;
+
+    std::mt19937_64 random(23);
+    std::bernoulli_distribution coin(density);
+    std::uniform_int_distribution<int> weight(1, 255);
+    std::vector<Edge<size_t>> edges;
+    for (size_t u = 0; u < vertexCount; ++u) {
+        for (size_t v = 0; v < vertexCount; ++v) {
+            if (coin(random)) {
+                edges.push_back({u, v, static_cast<double>(weight(random))});
+            }
+        }
+    }
+
+    std::cout << "Adjacency matrix weight types (" << vertexCount << " vertices, " << edges.size() << " edges):\n";
+    report_weight_type<double>("double", vertexCount, edges);
+    report_weight_type<float>("float", vertexCount, edges);
+    report_weight_type<std::uint32_t>("uint32_t", vertexCount, edges);
+    report_weight_type<std::uint8_t>("uint8_t", vertexCount, edges);
+    report_weight_type<Unweighted>("Unweighted", vertexCount, edges);
+}
+
+void benchmark_PredecessorIndex() {
+    // Measure the memory and the update cost of the predecessor index, and the predecessor queries it speeds up
+    constexpr size_t scale = 16;
+    constexpr size_t sampleCount = 50;
+    constexpr size_t updateCount = 200000;
+    constexpr size_t queryCount = 20;
+
+    const size_t before = allocated_bytes();
+    GraphAdjacencyList<size_t> graph = rmat_graph(scale, 16);
+    const size_t graphBytes = allocated_bytes() - before;
+    const size_t vertexCount = graph.id_bound();
+    size_t edgeCount = 0;
+    for (VertexId id = 0; id < vertexCount; ++id) {
+        graph.for_each_neighbor(id, [&edgeCount](VertexId, double) {
+            ++edgeCount;
+        });
+    }
+    std::mt19937_64 random(5);
+    std::uniform_int_distribution<VertexId> vertex(0, vertexCount - 1);
+    std::vector<VertexId> samples(sampleCount);
+    std::ranges::generate(samples, [&] {
+        return vertex(random);
+    });
+    std::vector<std::pair<VertexId, VertexId>> updates(updateCount);
+    std::ranges::generate(updates, [&] {
+        return std::pair{vertex(random), vertex(random)};
+    });
+    const auto update = [&updates](GraphAdjacencyList<size_t>& updated) {
+        return [&updates, &updated] {
+            for (const auto& [source, target] : updates) {
+                updated.set_edge_weight(source, target, 2.0);
+            }
+            return updated.size();
+        };
+    };
+    const auto in_degrees = [&graph, &samples] {
+        size_t total = 0;
+        for (const VertexId id : samples) {
+            total += graph.in_degree(id);
+        }
+        return total;
+    };
+
+    std::cout << "Predecessor index (R-MAT scale " << scale << ", " << vertexCount << " vertices, " << edgeCount << " edges):\n";
+    report("in_degree() without the index", sampleCount, in_degrees);
+    GraphAdjacencyList<size_t> unindexed = graph;
+    report("set_edge_weight() without the index", updateCount, update(unindexed));
+
+    const size_t unindexedBytes = allocated_bytes();
+    report("set_predecessor_index(true) per edge", edgeCount, [&graph] {
+        graph.set_predecessor_index(true);
+        return graph.size();
+    });
+    const size_t indexBytes = allocated_bytes() - unindexedBytes;
+    std::cout << "  graph: " << graphBytes / edgeCount << " bytes per edge, index: " << indexBytes / edgeCount << " more bytes per edge (+"
+              << 100 * indexBytes / graphBytes << "%)\n";
+    report("in_degree() with the index", sampleCount, in_degrees);
+    report("for_each_predecessor() over all vertices per edge", edgeCount, [&graph, vertexCount] {
+        double total = 0.0;
+        for (VertexId id = 0; id < vertexCount; ++id) {
+            graph.for_each_predecessor(id, [&total](VertexId, const double weight) {
+                total += weight;
+            });
+        }
+        return static_cast<size_t>(total);
+    });
+    report("set_edge_weight() with the index", updateCount, update(graph));
+
+    std::vector<std::pair<VertexId, VertexId>> queries(queryCount);
+    std::ranges::generate(queries, [&] {
+        return std::pair{vertex(random), vertex(random)};
+    });
+    report("bidirectional_dijkstra() building the transpose", queryCount, [&unindexed, &queries] {
+        size_t settled = 0;
+        for (const auto& [source, target] : queries) {
+            settled += bidirectional_dijkstra(unindexed, source, target).settled;
+        }
+        return settled;
+    });
+    const GraphCSR<size_t> transpose = unindexed.freeze().transpose();
+    report("bidirectional_dijkstra() on a prebuilt transpose", queryCount, [&unindexed, &transpose, &queries] {
+        size_t settled = 0;
+        for (const auto& [source, target] : queries) {
+            settled += bidirectional_dijkstra(unindexed, transpose, source, target).settled;
+        }
+        return settled;
+    });
+    report("bidirectional_dijkstra() on reverse_view()", queryCount, [&graph, &queries] {
+        size_t settled = 0;
+        for (const auto& [source, target] : queries) {
+            settled += bidirectional_dijkstra(graph, graph.reverse_view(), source, target).settled;
+        }
+        return settled;
+    });
+
+    unindexed.set_removal_mode(RemovalMode::Tombstone);
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    const auto remove = [&samples](GraphAdjacencyList<size_t>& removed) {
+        return [&samples, &removed] {
+            for (const VertexId id : samples) {
+                removed.remove_vertex(removed.value_of(id));
+            }
+            return removed.size();
+        };
+    };
+    report("remove_vertex() without the index (tombstones)", sampleCount, remove(unindexed));
+    report("remove_vertex() with the index (edges unlinked)", sampleCount, remove(graph));
+}
+
+void benchmark_NeighborTables() {
+    // Compare the flat vertex array and neighbor tables of GraphAdjacencyList with the node-based hash maps they replaced
+    constexpr size_t scale = 16;
+    constexpr size_t lookupCount = 1000000;
+
+    std::vector<Edge<size_t>> edges;
+    {
+        const GraphAdjacencyList<size_t> rmat = rmat_graph(scale, 16);
+        for (VertexId id = 0; id < rmat.id_bound(); ++id) {
+            rmat.for_each_neighbor(id, [&edges, id](const VertexId neighbor, const double weight) {
+                edges.push_back({id, neighbor, weight});
+            });
+        }
+    }
+    const size_t vertexCount = size_t{1} << scale;
+    std::mt19937_64 random(13);
+    std::uniform_int_distribution<size_t> edge(0, edges.size() - 1);
+    std::uniform_int_distribution<size_t> vertex(0, vertexCount - 1);
+    std::vector<std::pair<size_t, size_t>> hits(lookupCount);
+    std::vector<std::pair<size_t, size_t>> misses(lookupCount);
+    std::ranges::generate(hits, [&] {
+        const Edge<size_t>& hit = edges[edge(random)];
+        return std::pair{hit.source, hit.target};
+    });
+    std::ranges::generate(misses, [&] {
+        return std::pair{vertex(random), vertex(random)};
+    });
+    std::cout << "Neighbor tables (R-MAT scale " << scale << ", " << vertexCount << " vertices, " << edges.size() << " edges):\n";
+
+    // the previous layout of GraphAdjacencyList: vertex values to ids, and ids to vertices with their neighbors, in std::unordered_map
+    struct NodeBasedVertex {
+        size_t value;
+        std::unordered_map<size_t, double> neighbors;
+    };
+    std::unordered_map<size_t, size_t> values2ids;
+    std::unordered_map<size_t, NodeBasedVertex> vertices;
+    size_t before = allocated_bytes();
+    report("unordered_map: insert per edge", edges.size(), [&values2ids, &vertices, &edges, vertexCount] {
+        for (size_t id = 0; id < vertexCount; ++id) {
+            values2ids[id] = id;
+            vertices[id] = NodeBasedVertex{id, {}};
+        }
+        for (const Edge<size_t>& inserted : edges) {
+            vertices.find(values2ids.find(inserted.source)->second)->second.neighbors.insert_or_assign(values2ids.find(inserted.target)->second, inserted.weight);
+        }
+        return vertices.size();
+    });
+    std::cout << "  unordered_map: " << (allocated_bytes() - before) / edges.size() << " bytes per edge\n";
+    const auto mapLookups = [&values2ids, &vertices](const std::vector<std::pair<size_t, size_t>>& queries) {
+        return [&values2ids, &vertices, &queries] {
+            size_t found = 0;
+            for (const auto& [source, target] : queries) {
+                const std::unordered_map<size_t, double>& neighbors = vertices.find(values2ids.find(source)->second)->second.neighbors;
+                found += neighbors.contains(values2ids.find(target)->second) ? 1 : 0;
+            }
+            return found;
+        };
+    };
+    report("unordered_map: lookup hit", lookupCount, mapLookups(hits));
+    report("unordered_map: lookup miss", lookupCount, mapLookups(misses));
+    report("unordered_map: scan per edge", edges.size(), [&vertices, vertexCount] {
+        double total = 0.0;
+        for (size_t id = 0; id < vertexCount; ++id) {
+            for (const auto& [neighbor, weight] : vertices.find(id)->second.neighbors) {
+                total += weight;
+            }
+        }
+        return static_cast<size_t>(total);
+    });
+    values2ids.clear();
+    vertices.clear();
+
+    GraphAdjacencyList<size_t> graph;
+    before = allocated_bytes();
+    report("GraphAdjacencyList: insert per edge", edges.size(), [&graph, &edges, vertexCount] {
+        for (size_t id = 0; id < vertexCount; ++id) {
+            graph.add_vertex(id);
+        }
+        for (const Edge<size_t>& inserted : edges) {
+            graph.set_edge_weight(inserted.source, inserted.target, inserted.weight);
+        }
+        return graph.size();
+    });
+    std::cout << "  GraphAdjacencyList: " << (allocated_bytes() - before) / edges.size() << " bytes per edge\n";
+    const auto graphLookups = [&graph](const std::vector<std::pair<size_t, size_t>>& queries) {
+        return [&graph, &queries] {
+            size_t found = 0;
+            for (const auto& [source, target] : queries) {
+                found += graph.try_get_edge_weight(source, target).has_value() ? 1 : 0;
+            }
+            return found;
+        };
+    };
+    report("GraphAdjacencyList: lookup hit", lookupCount, graphLookups(hits));
+    report("GraphAdjacencyList: lookup miss", lookupCount, graphLookups(misses));
+    report("GraphAdjacencyList: scan per edge", edges.size(), [&graph, vertexCount] {
+        double total = 0.0;
+        for (VertexId id = 0; id < vertexCount; ++id) {
+            graph.for_each_neighbor(id, [&total](VertexId, const double weight) {
+                total += weight;
+            });
+        }
+        return static_cast<size_t>(total);
+    });
+
+    // add_edges() reserves every neighbor table at its final size
+    GraphAdjacencyList<size_t> bulk;
+    before = allocated_bytes();
+    for (size_t id = 0; id < vertexCount; ++id) {
+        bulk.add_vertex(id);
+    }
+    bulk.add_edges(edges);
+    std::cout << "  GraphAdjacencyList built with add_edges(): " << (allocated_bytes() - before) / edges.size() << " bytes per edge\n";
+}
@@ -0,0 +1,27 @@
+#ifndef GRAPH_BENCHMARKS_HPP
+#define GRAPH_BENCHMARKS_HPP
+
+void benchmark_LookupMiss();
+void benchmark_VertexRemoval();
+void benchmark_MatrixGrowth();
+void benchmark_IncidenceEdges();
+void benchmark_NeighborIteration();
+void benchmark_TraversalReset();
+void benchmark_DirectionOptimizingBfs();
+void benchmark_ConcurrentGraph();
+void benchmark_BitMatrix();
+void benchmark_BulkEdges();
+void benchmark_BinaryFile();
+void benchmark_EdgeListReader();
+void benchmark_ConnectedComponents();
+void benchmark_FloydWarshall();
+void benchmark_PageRank();
+void benchmark_PointToPoint();
+void benchmark_ContractionHierarchy();
+void benchmark_StronglyConnectedComponents();
+void benchmark_MinimumSpanningForest();
+void benchmark_EdgeWeights();
+void benchmark_PredecessorIndex();
+void benchmark_NeighborTables();
+
+#endif // GRAPH_BENCHMARKS_HPP
@@ -1,15 +1,43 @@
 #ifndef GRAPH_HPP
 #define GRAPH_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <exception>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
 #include <ranges>
-#include <stdexcept>
+#include <span>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 /**
  * Base class for exceptions thrown by the graph classes.
  */
@@ -56,12 +84,313 @@ public:
     explicit EdgeAlreadyExistsException(const std::string& message) : GraphException(message) {}
 };
 
+/**
+ * Exception thrown when an algorithm that requires non-negative edge weights encounters a negative one.
+ */
+class NegativeEdgeWeightException final : public GraphException {
+public:
+    explicit NegativeEdgeWeightException(const std::string& message) : GraphException(message) {}
+};
 
 /**
- * The base class for directed, weighted graphs.
+ * Exception thrown when a graph file can't be read or written, or has an invalid format.
+ */
+class GraphFileException final : public GraphException {
+public:
+    explicit GraphFileException(const std::string& message) : GraphException(message) {}
+};
+
+
+/**
+ * Integer id of a vertex inside a graph.
+ *
+ * Ids are smaller than the id bound of the graph (see Graph::id_bound()), so they can be used to index plain arrays.
+ * Unless vertices are removed in the tombstone mode, ids are dense (0 to size() - 1).
+ */
+using VertexId = std::size_t;
+
+/**
+ * Id used to mark the absence of a vertex (e.g. the predecessor of the source in a shortest path tree).
+ */
+inline constexpr VertexId NO_VERTEX = std::numeric_limits<VertexId>::max();
+
+/**
+ * Non-owning reference to a callable object.
+ *
+ * Used to pass callbacks through virtual functions without the allocation std::function may do.
+ * The referenced callable must outlive the FunctionRef.
+ */
+template <typename Signature>
+class FunctionRef;
+
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+private:
+    void* _callable;
+    R (*_invoke)(void*, Args...);
+public:
+    template <typename F>
+        requires (!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> && std::is_invocable_r_v<R, F&, Args...>)
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions,bugprone-forwarding-reference-overload)
+    FunctionRef(F&& callable) noexcept
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        : _callable(const_cast<void*>(static_cast<const void*>(std::addressof(callable)))),
+          _invoke([](void* callablePtr, Args... args) -> R {
+              return std::invoke(*static_cast<std::remove_reference_t<F>*>(callablePtr), std::forward<Args>(args)...);
+          }) {}
+
+    R operator()(Args... args) const {
+        return _invoke(_callable, std::forward<Args>(args)...);
+    }
+};
+
+/**
+ * Weight type of unweighted graphs, for example GraphAdjacencyMatrix<T, Unweighted>.
+ *
+ * It holds no value, so the matrix representations only store whether each edge is present.
+ * An unweighted edge converts to a length of 1, so the shortest path and spanning tree algorithms
+ * work on unweighted graphs as they do on graphs with unit weights.
+ */
+struct Unweighted {
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    constexpr operator double() const {
+        return 1.0;
+    }
+
+    bool operator==(const Unweighted& other) const = default;
+};
+
+/**
+ * Weight of the edges added without one (1, or Unweighted{} for unweighted graphs).
+ */
+template <typename W>
+inline constexpr W UNIT_WEIGHT = W{1};
+
+template <>
+inline constexpr Unweighted UNIT_WEIGHT<Unweighted>{};
+
+/**
+ * Callback receiving the id of a neighbor and the weight of the edge leading to it.
+ */
+template <typename W = double>
+using NeighborVisitor = FunctionRef<void(VertexId, W)>;
+
+/**
+ * An outgoing edge of a vertex, as yielded by neighbor_range().
+ */
+template <typename T, typename W = double>
+struct Neighbor {
+    VertexId id;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+    const T& value;
+    W weight;
+};
+
+/**
+ * Lazy view over the outgoing edges of a vertex, yielding Neighbor<T, W> entries.
+ *
+ * Nothing is allocated or copied: the entries are read from the graph as the view is iterated.
+ * The cursor walks the edges of one graph representation, it provides done(), advance() and current().
+ * The view is invalidated by any modification of the graph.
+ */
+template <typename T, typename Cursor, typename W = double>
+class NeighborRange : public std::ranges::view_interface<NeighborRange<T, Cursor, W>> {
+private:
+    Cursor _first;
+public:
+    class Iterator {
+    private:
+        Cursor _cursor;
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = Neighbor<T, W>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        explicit Iterator(const Cursor& cursor) : _cursor(cursor) {}
+
+        Neighbor<T, W> operator*() const {
+            return _cursor.current();
+        }
+
+        Iterator& operator++() {
+            _cursor.advance();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            _cursor.advance();
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const = default;
+
+        bool operator==(std::default_sentinel_t /*sentinel*/) const {
+            return _cursor.done();
+        }
+    };
+
+    NeighborRange() = default;
+
+    explicit NeighborRange(const Cursor& first) : _first(first) {}
+
+    [[nodiscard]] Iterator begin() const {
+        return Iterator{_first};
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const {
+        return std::default_sentinel;
+    }
+};
+
+/**
+ * How ids are handled when a vertex is removed from a graph.
+ */
+enum class RemovalMode : std::uint8_t {
+    // ids greater than the id of the removed vertex are decremented, so ids stay dense (O(V + E) per removal)
+    Renumber,
+    // the id is freed for reuse and no other id changes until compact() is called (amortized O(1) per removal)
+    Tombstone
+};
+
+/**
+ * Get the number of threads a parallel algorithm should use.
+ * @param threadCount The requested number of threads, 0 for one per hardware thread.
+ * @return The number of threads to use (at least 1).
+ */
+inline size_t resolve_thread_count(const size_t threadCount) {
+    if (threadCount != 0) {
+        return threadCount;
+    }
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+/**
+ * Split the range [0, count) into contiguous blocks, one per thread, and process them in parallel.
+ *
+ * The calling thread processes the first block and returns when all blocks are done.
+ * The body must not throw.
+ * @param count The size of the range.
+ * @param threadCount The number of threads to use (at least 1).
+ * @param body Called as body(thread, first, last) for every block, where thread is the index of the block.
+ */
+template <typename F>
+void parallel_blocks(const size_t count, const size_t threadCount, F body) {
+    const size_t blockCount = std::max<size_t>(std::min(threadCount, count), 1);
+    std::vector<std::jthread> threads;
+    threads.reserve(blockCount - 1);
+    for (size_t block = 1; block < blockCount; ++block) {
+        threads.emplace_back([&body, block, blockCount, count] {
+            std::invoke(body, block, count * block / blockCount, count * (block + 1) / blockCount);
+        });
+    }
+    std::invoke(body, size_t{0}, size_t{0}, count / blockCount);
+}
+
+/**
+ * Sort a range in parallel, keeping the relative order of equal elements.
+ *
+ * The range is split into one block per thread, the blocks are sorted in parallel,
+ * and then merged pairwise in parallel rounds.
+ * @param first The beginning of the range.
+ * @param last The end of the range.
+ * @param compare The strict weak ordering to sort by.
+ * @param threadCount The number of threads to use (at least 1).
+ */
+template <std::random_access_iterator I, typename C>
+void parallel_stable_sort(const I first, const I last, C compare, const size_t threadCount) {
+    // below this size, a block is not worth a thread
+    constexpr size_t minBlockSize = 1 << 14;
+    const size_t count = static_cast<size_t>(last - first);
+    const size_t blockCount = std::max<size_t>(std::min(threadCount, count / minBlockSize), 1);
+    if (blockCount == 1) {
+        std::stable_sort(first, last, compare);
+        return;
+    }
+
+    std::vector<size_t> boundaries(blockCount + 1);
+    for (size_t block = 0; block <= blockCount; ++block) {
+        boundaries[block] = count * block / blockCount;
+    }
+    const auto at = [first](const size_t offset) {
+        return first + static_cast<std::iter_difference_t<I>>(offset);
+    };
+    parallel_blocks(blockCount, blockCount, [&](size_t, const size_t firstBlock, const size_t lastBlock) {
+        for (size_t block = firstBlock; block < lastBlock; ++block) {
+            std::stable_sort(at(boundaries[block]), at(boundaries[block + 1]), compare);
+        }
+    });
+    while (boundaries.size() > 2) {
+        const size_t pairCount = (boundaries.size() - 1) / 2;
+        parallel_blocks(pairCount, threadCount, [&](size_t, const size_t firstPair, const size_t lastPair) {
+            for (size_t pair = firstPair; pair < lastPair; ++pair) {
+                std::inplace_merge(at(boundaries[2 * pair]), at(boundaries[2 * pair + 1]), at(boundaries[2 * pair + 2]), compare);
+            }
+        });
+        std::vector<size_t> merged;
+        for (size_t i = 0; i < boundaries.size(); i += 2) {
+            merged.push_back(boundaries[i]);
+        }
+        if (merged.back() != count) {
+            merged.push_back(count);
+        }
+        boundaries = std::move(merged);
+    }
+}
+
+/**
+ * A weighted edge between two vertices, for adding edges in bulk.
+ */
+template <typename T, typename W = double>
+struct Edge {
+    T source;
+    T target;
+    W weight = UNIT_WEIGHT<W>;
+};
+
+/**
+ * How edges added in bulk are combined with other edges between the same vertices
+ * (in the same batch or already in the graph).
+ */
+enum class DuplicatePolicy : std::uint8_t {
+    // throw EdgeAlreadyExistsException, as add_edge does
+    Error,
+    // keep the edge already in the graph, or else the first edge of the batch
+    KeepFirst,
+    // add up the weights
+    Sum
+};
+
+/**
+ * Types of vertices that can be saved to binary files: types whose bytes determine their value
+ * (for example integers, but not floating-point numbers), which are stored as they are,
+ * and strings, which are stored in a table of characters.
  */
 template <typename T>
+concept BinaryVertex = std::has_unique_object_representations_v<T> || std::same_as<T, std::string> || std::same_as<T, std::string_view>;
+
+template <typename T, typename W = double>
+class GraphCSR;
+
+
+/**
+ * The base class for directed, weighted graphs.
+ *
+ * Weights are of type W: double by default, a narrower type (for example float or std::uint32_t)
+ * to save memory, or Unweighted. Whether an edge exists is stored apart from its weight,
+ * so edges of weight 0 are allowed.
+ *
+ * Vertices can be passed either as values or as ids, and no method name takes both, so an integer
+ * argument is never silently taken for the wrong one: methods whose name ends with _by_id take ids,
+ * the other edge queries and updates take values, and traversals (for_each_neighbor(), neighbor_range(), ...)
+ * take ids only.
+ */
+template <typename T, typename W = double>
 class Graph {
+private:
+    RemovalMode _removalMode = RemovalMode::Renumber;
 public:
     // constructor
     Graph() = default;
@@ -95,6 +424,81 @@ public:
         return size() == 0;
     }
 
+    /**
+     * Get the id bound of the graph.
+     *
+     * All ids in the graph are smaller than the id bound, so it is the size
+     * of the arrays that are indexed by vertex id. It is equal to size() unless
+     * there are ids freed by removals in the tombstone mode.
+     * @return The id bound of the graph.
+     */
+    [[nodiscard]] virtual size_t id_bound() const = 0;
+
+    /**
+     * Check if there is a vertex with the given id.
+     * @param id The id to check.
+     * @return true if there is a vertex with the given id, false otherwise.
+     */
+    [[nodiscard]] virtual bool contains_id(VertexId id) const = 0;
+
+    /**
+     * Get the removal mode of the graph.
+     * @return The removal mode of the graph.
+     */
+    [[nodiscard]] RemovalMode removal_mode() const {
+        return _removalMode;
+    }
+
+    /**
+     * Set how ids are handled when vertices are removed.
+     * @param mode The new removal mode.
+     */
+    void set_removal_mode(const RemovalMode mode) {
+        _removalMode = mode;
+    }
+
+    /**
+     * Renumber the vertices so that ids are dense again (0 to size() - 1).
+     *
+     * The relative order of ids is kept. All ids freed by removals
+     * in the tombstone mode are reclaimed in a single O(V + E) pass.
+     * @return A vector, indexed by old id, with the new id of every vertex (NO_VERTEX for freed ids).
+     */
+    virtual std::vector<VertexId> compact() = 0;
+
+    /**
+     * Get the id of a vertex.
+     * @throws VertexNotFoundException If the vertex doesn't exist.
+     * @param vertex The vertex to get the id of.
+     * @return The id of the vertex.
+     */
+    [[nodiscard]] virtual VertexId id_of(const T& vertex) const = 0;
+
+    /**
+     * Find the id of a vertex without throwing.
+     * @param vertex The vertex to find.
+     * @return The id of the vertex, or an empty optional if the vertex doesn't exist.
+     */
+    [[nodiscard]] virtual std::optional<VertexId> find_vertex(const T& vertex) const = 0;
+
+    /**
+     * Get the vertex with the given id.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return The vertex with the given id.
+     */
+    [[nodiscard]] virtual const T& value_of(VertexId id) const = 0;
+
+    /**
+     * Call a function for every outgoing edge of a vertex.
+     *
+     * Works directly on ids, so no vertex values are hashed or copied.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @param visitor Called with the id of the neighbor and the weight of the edge for every outgoing edge.
+     */
+    virtual void for_each_neighbor(VertexId id, NeighborVisitor<W> visitor) const = 0;
+
     /**
      * Check if the vertices are adjacent in the graph.
      * @throws VertexNotFoundException If any of the vertices don't exist.
@@ -104,6 +508,15 @@ public:
      */
     [[nodiscard]] virtual bool adjacent(const T& vertex1, const T& vertex2) const = 0;
 
+    /**
+     * Check if the vertices with the given ids are adjacent in the graph.
+     * @throws VertexNotFoundException If there is no vertex with any of the given ids.
+     * @param id1 The id of the first vertex.
+     * @param id2 The id of the second vertex.
+     * @return true if the vertices are adjacent, false otherwise.
+     */
+    [[nodiscard]] virtual bool adjacent_by_id(VertexId id1, VertexId id2) const = 0;
+
     /**
      * Get the neighbors of a vertex.
      * @throws VertexNotFoundException If the vertex doesn't exist.
@@ -112,15 +525,27 @@ public:
      */
     [[nodiscard]] virtual std::vector<T> neighbors(const T& vertex) const = 0;
 
+    /**
+     * Get the ids of the neighbors of the vertex with the given id.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex to get the neighbors of.
+     * @return A vector with the ids of the neighbors of the vertex.
+     */
+    [[nodiscard]] virtual std::vector<VertexId> neighbors_by_id(VertexId id) const = 0;
+
     /**
      * Add a vertex to the graph.
      * @throws VertexAlreadyExistsException If the vertex already exists.
      * @param vertex The vertex to add.
+     * @return The id of the added vertex.
      */
-    virtual void add_vertex(const T& vertex) = 0;
+    virtual VertexId add_vertex(const T& vertex) = 0;
 
     /**
      * Remove a vertex from the graph.
+     *
+     * In the renumber mode, the ids of the vertices after the removed one are decremented.
+     * In the tombstone mode, no other ids change and the id of the removed vertex may be reused by add_vertex().
      * @throws VertexNotFoundException If the vertex doesn't exist.
      * @param vertex The vertex to remove.
      */
@@ -136,14 +561,89 @@ public:
      * @throws VertexNotFoundException If any of the vertices don't exist.
      */
     virtual void add_edge(const T& vertex1, const T& vertex2) {
-        if (this->get_edge_weight(vertex1, vertex2) != 0.0) {
+        if (this->adjacent(vertex1, vertex2)) {
             throw EdgeAlreadyExistsException("Edge already exists");
         }
-        this->set_edge_weight(vertex1, vertex2, 1.0);
+        this->set_edge_weight(vertex1, vertex2, UNIT_WEIGHT<W>);
+    }
+
+    /**
+     * Add a batch of edges to the graph.
+     *
+     * Much faster than calling add_edge for every edge: the vertices are looked up once,
+     * the edges are sorted by (source, target) in parallel so duplicates are adjacent,
+     * and the edges of every vertex are inserted together, with a single allocation.
+     * If an exception is thrown, the graph is unchanged.
+     * @param edges The edges to add.
+     * @param policy How edges between the same vertices are combined.
+     * @param threadCount The number of threads to use, 0 for one per hardware thread.
+     * @throws EdgeAlreadyExistsException If the policy is Error and an edge is repeated or already exists.
+     * @throws VertexNotFoundException If any of the vertices don't exist.
+     */
+    void add_edges(const std::span<const Edge<T, W>> edges, const DuplicatePolicy policy = DuplicatePolicy::Error, const size_t threadCount = 0) {
+        // unweighted edges have nothing to add up
+        const auto sum = [](const W weight1, const W weight2) {
+            if constexpr (std::is_empty_v<W>) {
+                return weight1;
+            } else {
+                return static_cast<W>(weight1 + weight2);
+            }
+        };
+
+        const size_t threads = resolve_thread_count(threadCount);
+        std::vector<Edge<VertexId, W>> resolved(edges.size());
+        std::atomic<bool> missing = false;
+        parallel_blocks(edges.size(), threads, [&](size_t, const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                const std::optional<VertexId> source = find_vertex(edges[i].source);
+                const std::optional<VertexId> target = find_vertex(edges[i].target);
+                if (!source || !target) {
+                    missing.store(true, std::memory_order_relaxed);
+                    return;
+                }
+                resolved[i] = {*source, *target, edges[i].weight};
+            }
+        });
+        if (missing.load(std::memory_order_relaxed)) {
+            throw VertexNotFoundException("Vertex not found");
+        }
+
+        parallel_stable_sort(resolved.begin(), resolved.end(), [](const Edge<VertexId, W>& edge1, const Edge<VertexId, W>& edge2) {
+            return edge1.source != edge2.source ? edge1.source < edge2.source : edge1.target < edge2.target;
+        }, threads);
+
+        // combine the runs of equal edges and the edges already in the graph, before changing anything
+        size_t unique = 0;
+        for (size_t i = 0; i < resolved.size();) {
+            Edge<VertexId, W> edge = resolved[i];
+            size_t next = i + 1;
+            for (; next < resolved.size() && resolved[next].source == edge.source && resolved[next].target == edge.target; ++next) {
+                if (policy == DuplicatePolicy::Error) {
+                    throw EdgeAlreadyExistsException("Edge already exists");
+                }
+                if (policy == DuplicatePolicy::Sum) {
+                    edge.weight = sum(edge.weight, resolved[next].weight);
+                }
+            }
+            i = next;
+
+            if (adjacent_by_id(edge.source, edge.target)) {
+                if (policy == DuplicatePolicy::Error) {
+                    throw EdgeAlreadyExistsException("Edge already exists");
+                }
+                if (policy == DuplicatePolicy::KeepFirst) {
+                    continue;
+                }
+                edge.weight = sum(edge.weight, get_edge_weight_by_id(edge.source, edge.target));
+            }
+            resolved[unique++] = edge;
+        }
+        resolved.resize(unique);
+        insert_edges(resolved);
     }
 
     /**
-     * Remove an edge (set its weight to 0) from the graph.
+     * Remove an edge from the graph.
      *
      * The order of the vertices matters since the graph is directed.
      * @param vertex1 The first vertex.
@@ -152,10 +652,21 @@ public:
      * @throws VertexNotFoundException If any of the vertices don't exist.
      */
     virtual void remove_edge(const T& vertex1, const T& vertex2) {
-        if (this->get_edge_weight(vertex1, vertex2) == 0.0) {
+        remove_edge_by_id(id_of(vertex1), id_of(vertex2));
+    }
+
+    /**
+     * Remove the edge between the vertices with the given ids.
+     * @param id1 The id of the first vertex.
+     * @param id2 The id of the second vertex.
+     * @throws EdgeNotFoundException If the edge does not exist.
+     * @throws VertexNotFoundException If there is no vertex with any of the given ids.
+     */
+    void remove_edge_by_id(const VertexId id1, const VertexId id2) {
+        if (!adjacent_by_id(id1, id2)) {
             throw EdgeNotFoundException("Edge not found");
         }
-        this->set_edge_weight(vertex1, vertex2, 0.0);
+        remove_existing_edge(id1, id2);
     }
 
     /**
@@ -165,23 +676,56 @@ public:
      * @param vertex1 The first vertex.
      * @param vertex2 The second vertex.
      * @throws VertexNotFoundException If any of the vertices don't exist.
-     * @return The weight of the edge (0 if the edge doesn't exist).
+     * @return The weight of the edge (W{}, that is 0, if the edge doesn't exist: use adjacent() or
+     *         try_get_edge_weight() to tell a missing edge from an edge of weight 0).
+     */
+    [[nodiscard]] virtual W get_edge_weight(const T& vertex1, const T& vertex2) const = 0;
+
+    /**
+     * Get the weight of the edge between the vertices with the given ids.
+     * @param id1 The id of the first vertex.
+     * @param id2 The id of the second vertex.
+     * @throws VertexNotFoundException If there is no vertex with any of the given ids.
+     * @return The weight of the edge (W{} if the edge doesn't exist).
+     */
+    [[nodiscard]] virtual W get_edge_weight_by_id(VertexId id1, VertexId id2) const = 0;
+
+    /**
+     * Get the weight of an edge without throwing.
+     *
+     * The order of the vertices matters since the graph is directed.
+     * Meant for queries that often miss, since no exception is thrown if a vertex doesn't exist.
+     * @param vertex1 The first vertex.
+     * @param vertex2 The second vertex.
+     * @return The weight of the edge, or an empty optional if any of the vertices or the edge don't exist.
      */
-    [[nodiscard]] virtual double get_edge_weight(const T& vertex1, const T& vertex2) const = 0;
+    [[nodiscard]] virtual std::optional<W> try_get_edge_weight(const T& vertex1, const T& vertex2) const = 0;
 
     /**
-     * Set the weight of an edge.
+     * Set the weight of an edge, adding the edge if it doesn't exist.
      *
      * The order of the vertices matters since the graph is directed.
      * @param vertex1 The first vertex.
      * @param vertex2 The second vertex.
-     * @param weight The weight of the edge (0 to remove the edge).
+     * @param weight The weight of the edge (which may be 0, use remove_edge() to remove the edge).
      * @throws VertexNotFoundException If any of the vertices don't exist.
      */
-    virtual void set_edge_weight(const T& vertex1, const T& vertex2, double weight) = 0;
+    virtual void set_edge_weight(const T& vertex1, const T& vertex2, W weight) = 0;
+
+    /**
+     * Set the weight of the edge between the vertices with the given ids, adding the edge if it doesn't exist.
+     * @param id1 The id of the first vertex.
+     * @param id2 The id of the second vertex.
+     * @param weight The weight of the edge (which may be 0, use remove_edge_by_id() to remove the edge).
+     * @throws VertexNotFoundException If there is no vertex with any of the given ids.
+     */
+    virtual void set_edge_weight_by_id(VertexId id1, VertexId id2, W weight) = 0;
 
     /**
      * Get the visited status of a vertex.
+     *
+     * The status is stored in the graph, so only one traversal can use it at a time,
+     * and resetting it takes O(V). Traversals that may run concurrently should use a TraversalState.
      * @param vertex The vertex to get the visited status of.
      * @throws VertexNotFoundException If the vertex does not exist.
      * @return The visited status of the vertex.
@@ -200,415 +744,631 @@ public:
      * Reset the visited status of all vertices (to false).
      */
     virtual void reset_vertices_visited() = 0;
-};
 
-template <typename T>
-class GraphAdjacencyList : public Graph<T> {
-private:
-    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
-    struct Vertex {
-        T _value;
-        std::unordered_map<size_t, double> _neighbors;
-        bool _visited = false;
-        Vertex() : _value(T{}) {}
-        explicit Vertex(const T& value) : _value(value) {}
-    };
-    // NOLINTEND(misc-non-private-member-variables-in-classes)
+    /**
+     * Create an immutable compressed sparse row (CSR) snapshot of the graph.
+     *
+     * Later changes to the graph are not reflected in the snapshot.
+     * @return The snapshot of the graph.
+     */
+    [[nodiscard]] GraphCSR<T, W> freeze() const {
+        return GraphCSR<T, W>(*this);
+    }
 
-    std::unordered_map<T, size_t> _vertices2ids;
-    std::unordered_map<size_t, Vertex> _vertices;
-public:
-    // constructor
-    GraphAdjacencyList() = default;
+    /**
+     * Save the graph to a binary file in the compressed sparse row (CSR) format.
+     *
+     * The file can be loaded back, without parsing, with GraphCSR<T, W>::load_mmap().
+     * @param path The path of the file, which is overwritten if it exists.
+     * @throws GraphFileException If the file can't be written.
+     */
+    void save_binary(const std::string& path) const requires BinaryVertex<T> && std::is_trivially_copyable_v<W> {
+        freeze().save_binary(path);
+    }
+protected:
+    // remove an edge that exists
+    virtual void remove_existing_edge(VertexId id1, VertexId id2) = 0;
 
-    // copy constructor
-    GraphAdjacencyList(const GraphAdjacencyList& other) : _vertices2ids(other._vertices2ids), _vertices(other._vertices) {}
+    // set the weights of edges sorted by (source, target), without duplicates, for add_edges()
+    virtual void insert_edges(const std::span<const Edge<VertexId, W>> edges) {
+        for (const Edge<VertexId, W>& edge : edges) {
+            set_edge_weight_by_id(edge.source, edge.target, edge.weight);
+        }
+    }
+};
 
-    // move constructor
-    // NOLINTNEXTLINE(bugprone-exception-escape)
-    GraphAdjacencyList(GraphAdjacencyList&& other) noexcept : _vertices2ids(std::move(other._vertices2ids)), _vertices(std::move(other._vertices)) {}
+/**
+ * Collects vertices and edges, then builds a graph from them in one go with Graph::add_edges().
+ *
+ * The vertices of the edges don't need to be added explicitly: they are added to the graph
+ * in the order they are first seen, after the explicitly added ones.
+ */
+template <typename T, typename W = double>
+class GraphBuilder {
+private:
+    std::vector<T> _vertices;
+    std::vector<Edge<T, W>> _edges;
+public:
+    /**
+     * Add a vertex, even if it has no edges.
+     * @param vertex The vertex to add.
+     * @return A reference to the builder.
+     */
+    GraphBuilder& add_vertex(const T& vertex) {
+        _vertices.push_back(vertex);
+        return *this;
+    }
 
-    // copy assignment
-    GraphAdjacencyList& operator=(const GraphAdjacencyList& other) {
-        if (this == &other) {
-            return *this;
-        }
-        _vertices2ids = other._vertices2ids;
-        _vertices = other._vertices;
+    /**
+     * Add an edge.
+     * @param source The source of the edge.
+     * @param target The target of the edge.
+     * @param weight The weight of the edge.
+     * @return A reference to the builder.
+     */
+    GraphBuilder& add_edge(const T& source, const T& target, const W weight = UNIT_WEIGHT<W>) {
+        _edges.push_back({source, target, weight});
         return *this;
     }
 
-    // move assignment
-    GraphAdjacencyList& operator=(GraphAdjacencyList&& other) noexcept {
-        if (this == &other) {
-            return *this;
-        }
-        _vertices2ids = std::move(other._vertices2ids);
-        _vertices = std::move(other._vertices);
+    /**
+     * Add a batch of edges.
+     * @param edges The edges to add.
+     * @return A reference to the builder.
+     */
+    GraphBuilder& add_edges(const std::span<const Edge<T, W>> edges) {
+        _edges.insert(_edges.end(), edges.begin(), edges.end());
         return *this;
     }
 
-    // destructor
-    ~GraphAdjacencyList() override = default;
+    /**
+     * Reserve memory for edges, to avoid reallocations while they are added.
+     * @param edgeCount The number of edges to reserve memory for.
+     */
+    void reserve(const size_t edgeCount) {
+        _edges.reserve(edgeCount);
+    }
 
-    [[nodiscard]] size_t size() const override {
-        return _vertices.size();
+    /**
+     * Get the number of edges added so far (including duplicates).
+     * @return The number of edges.
+     */
+    [[nodiscard]] size_t edge_count() const {
+        return _edges.size();
     }
 
-    [[nodiscard]] bool adjacent(const T& vertex1, const T& vertex2) const override {
-        size_t id1 = 0;
-        size_t id2 = 0;
-        try {
-            id1 = _vertices2ids.at(vertex1);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex1 not found");
+    /**
+     * Add the vertices and edges to a graph.
+     *
+     * Vertices that are already in the graph are kept. If an exception is thrown,
+     * the vertices have been added but the edges haven't.
+     * @param graph The graph to add the vertices and edges to.
+     * @param policy How edges between the same vertices are combined.
+     * @param threadCount The number of threads to use, 0 for one per hardware thread.
+     * @throws EdgeAlreadyExistsException If the policy is Error and an edge is repeated or already exists.
+     */
+    void build_into(Graph<T, W>& graph, const DuplicatePolicy policy = DuplicatePolicy::Error, const size_t threadCount = 0) const {
+        const auto addMissing = [&graph](const T& vertex) {
+            if (!graph.find_vertex(vertex)) {
+                graph.add_vertex(vertex);
+            }
+        };
+        for (const T& vertex : _vertices) {
+            addMissing(vertex);
         }
-        try {
-            id2 = _vertices2ids.at(vertex2);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex2 not found");
+        for (const Edge<T, W>& edge : _edges) {
+            addMissing(edge.source);
+            addMissing(edge.target);
         }
-        return _vertices.at(id1)._neighbors.contains(id2);
+        graph.add_edges(_edges, policy, threadCount);
     }
 
-    [[nodiscard]] std::vector<T> neighbors(const T& vertex) const override {
-        size_t id = 0;
-        try {
-            id = _vertices2ids.at(vertex);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
-        }
-        std::vector<T> neighborsVec;
-        for (const std::pair<const size_t, double>& neighbor : _vertices.at(id)._neighbors) {
-            neighborsVec.push_back(_vertices.at(neighbor.first)._value);
-        }
-        return neighborsVec;
+    /**
+     * Build a new graph from the vertices and edges.
+     * @tparam G The type of the graph, for example GraphAdjacencyList<T, W>.
+     * @param policy How edges between the same vertices are combined.
+     * @param threadCount The number of threads to use, 0 for one per hardware thread.
+     * @throws EdgeAlreadyExistsException If the policy is Error and an edge is repeated.
+     * @return The graph.
+     */
+    template <std::derived_from<Graph<T, W>> G>
+    [[nodiscard]] G build(const DuplicatePolicy policy = DuplicatePolicy::Error, const size_t threadCount = 0) const {
+        G graph;
+        build_into(graph, policy, threadCount);
+        return graph;
     }
+};
 
-    void add_vertex(const T& vertex) override {
-        if (_vertices2ids.contains(vertex)) {
-            throw VertexAlreadyExistsException("vertex already exists");
-        }
-        const size_t newId = size();
-        _vertices2ids[vertex] = newId;
-        _vertices[newId] = Vertex{vertex};
+/**
+ * Format of a text file listing the edges of a graph.
+ */
+enum class EdgeListFormat : std::uint8_t {
+    // SNAP: one "source target [weight]" line per edge, and comment lines starting with '#'
+    Snap,
+    // Matrix Market coordinate format: a "%%MatrixMarket matrix coordinate ..." header,
+    // comment lines starting with '%', a "rows columns entries" line, then one "row column [value]" line per edge
+    MatrixMarket
+};
+
+/**
+ * Statistics of reading an edge list.
+ */
+struct EdgeListStats {
+    // size of the file
+    size_t bytes = 0;
+    // number of edges read (including the mirrored edges of symmetric Matrix Market files)
+    size_t edges = 0;
+    // time spent reading, parsing and passing the edges to the builder
+    double seconds = 0.0;
+
+    /**
+     * Get the parse throughput.
+     * @return The number of megabytes (10^6 bytes) read per second.
+     */
+    [[nodiscard]] double megabytes_per_second() const {
+        return seconds > 0.0 ? static_cast<double>(bytes) / 1e6 / seconds : 0.0;
     }
+};
 
-    void remove_vertex(const T& vertex) override {
-        size_t id = 0;
-        try {
-            id = _vertices2ids.at(vertex);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
+/**
+ * Reads graphs from text edge lists, with integer vertices.
+ *
+ * The file is streamed in chunks of whole lines, so only one chunk is in memory at a time.
+ * Every chunk is split between the threads, which parse their lines in place
+ * (with std::from_chars, which ignores the locale and never allocates) into a batch of edges per thread,
+ * and the batches are then passed to a GraphBuilder in the order of the file.
+ * Vertices are the numbers found in the file (so they start at 1 in Matrix Market files).
+ * Edges without a weight get a weight of 1.
+ */
+template <std::integral V>
+class EdgeListReader {
+private:
+    // Matrix Market symmetry: for every entry (i, j, w) off the diagonal, also add (j, i, w) or (j, i, -w)
+    enum class Mirror : std::uint8_t {
+        None,
+        Symmetric,
+        SkewSymmetric
+    };
+
+    EdgeListFormat _format;
+    size_t _threadCount;
+    size_t _chunkSize;
+
+    // state of the Matrix Market header, which is parsed before the edges
+    bool _headerDone = false;
+    bool _sizeDone = false;
+    bool _pattern = false;
+    Mirror _mirror = Mirror::None;
+
+    [[nodiscard]] static const char* skip_blanks(const char* position, const char* end) {
+        while (position != end && (*position == ' ' || *position == '\t' || *position == '\r')) {
+            ++position;
         }
-        const size_t oldSize = size();
-        _vertices2ids.erase(vertex);
-        _vertices.erase(id);
+        return position;
+    }
 
-        // update ids in _vertices2ids
-        for (std::pair<const T, size_t>& vertex2id : _vertices2ids) {
-            if (vertex2id.second > id) {
-                --vertex2id.second;
-            }
+    [[nodiscard]] static bool is_comment(const char* position, const char* end) {
+        return position == end || *position == '#' || *position == '%';
+    }
+
+    // parse a number and the blanks after it, or return nullptr
+    template <typename N>
+    [[nodiscard]] static const char* parse_number(const char* position, const char* end, N& number) {
+        const std::from_chars_result result = std::from_chars(position, end, number);
+        if (result.ec != std::errc{} || (result.ptr != end && *result.ptr != ' ' && *result.ptr != '\t' && *result.ptr != '\r')) {
+            return nullptr;
         }
+        return skip_blanks(result.ptr, end);
+    }
 
-        // update ids in _vertices
-        for (size_t i = id + 1; i < oldSize; ++i) {
-            auto node = _vertices.extract(i);
-            node.key() = i - 1;
-            _vertices.insert(std::move(node));
+    [[nodiscard]] static std::string describe(const char* first, const char* last) {
+        return "malformed edge list line: " + std::string(first, std::min<size_t>(static_cast<size_t>(last - first), 80));
+    }
+
+    // lowercase words of a Matrix Market header line
+    [[nodiscard]] static std::vector<std::string> header_words(const std::string_view line) {
+        std::vector<std::string> words;
+        for (const auto word : std::views::split(line, ' ')) {
+            if (!word.empty()) {
+                std::string lower(word.begin(), word.end());
+                std::ranges::transform(lower, lower.begin(), [](const char c) {
+                    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+                });
+                words.push_back(lower);
+            }
         }
+        return words;
+    }
 
-        // update ids in neighbors lists
-        for (std::pair<const size_t, Vertex>& vertexGraph : _vertices) {
-            vertexGraph.second._neighbors.erase(id);
-            std::unordered_map<size_t, double> newNeighbors;
-            while (!vertexGraph.second._neighbors.empty()) {
-                auto node = vertexGraph.second._neighbors.extract(vertexGraph.second._neighbors.begin());
-                if (node.key() > id) {
-                    node.key() -= 1; // decrement id for neighbors with id greater than removed vertex
+    // parse the Matrix Market header and size lines at the start of [first, last), and return where the edges start
+    const char* parse_preamble(const char* first, const char* last, GraphBuilder<V>& builder) {
+        while (first != last && !_sizeDone) {
+            const char* lineEnd = std::find(first, last, '\n');
+            const std::string_view line(first, static_cast<size_t>(lineEnd - first));
+            if (!_headerDone) {
+                const std::vector<std::string> words = header_words(line.substr(0, line.find_last_not_of('\r') + 1));
+                if (words.size() != 5 || words[0] != "%%matrixmarket" || words[1] != "matrix" || words[2] != "coordinate" ||
+                    (words[3] != "real" && words[3] != "integer" && words[3] != "pattern") ||
+                    (words[4] != "general" && words[4] != "symmetric" && words[4] != "skew-symmetric")) {
+                    throw GraphFileException("unsupported Matrix Market header: " + std::string(line));
                 }
-                newNeighbors.insert(std::move(node));
+                _pattern = words[3] == "pattern";
+                _mirror = words[4] == "general" ? Mirror::None : words[4] == "symmetric" ? Mirror::Symmetric : Mirror::SkewSymmetric;
+                _headerDone = true;
+            } else if (const char* position = skip_blanks(first, lineEnd); !is_comment(position, lineEnd)) {
+                V rows{};
+                V columns{};
+                size_t entries = 0;
+                position = parse_number(position, lineEnd, rows);
+                position = position == nullptr ? nullptr : parse_number(position, lineEnd, columns);
+                position = position == nullptr ? nullptr : parse_number(position, lineEnd, entries);
+                if (position != lineEnd) {
+                    throw GraphFileException(describe(first, lineEnd));
+                }
+                // rows and columns are both vertices of the graph, even if they have no entries
+                for (V vertex = 1; vertex <= std::max(rows, columns); ++vertex) {
+                    builder.add_vertex(vertex);
+                }
+                builder.reserve(builder.edge_count() + (_mirror == Mirror::None ? entries : 2 * entries));
+                _sizeDone = true;
             }
-            vertexGraph.second._neighbors = std::move(newNeighbors);
+            first = lineEnd == last ? last : lineEnd + 1;
         }
+        return first;
     }
 
-    [[nodiscard]] double get_edge_weight(const T& vertex1, const T& vertex2) const override {
-        size_t id1 = 0;
-        size_t id2 = 0;
-        try {
-            id1 = _vertices2ids.at(vertex1);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex1 not found");
-        }
-        try {
-            id2 = _vertices2ids.at(vertex2);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex2 not found");
+    // parse the edges of the lines in [first, last), or return the first malformed line
+    std::optional<std::string> parse_lines(const char* first, const char* last, std::vector<Edge<V>>& edges) const {
+        while (first != last) {
+            const char* lineEnd = std::find(first, last, '\n');
+            const char* position = skip_blanks(first, lineEnd);
+            if (!is_comment(position, lineEnd)) {
+                Edge<V> edge{};
+                position = parse_number(position, lineEnd, edge.source);
+                position = position == nullptr ? nullptr : parse_number(position, lineEnd, edge.target);
+                if (position != nullptr && position != lineEnd && !_pattern) {
+                    position = parse_number(position, lineEnd, edge.weight);
+                }
+                if (position == nullptr) {
+                    return describe(first, lineEnd);
+                }
+                // extra columns (such as timestamps) are ignored
+                edges.push_back(edge);
+                if (_mirror != Mirror::None && edge.source != edge.target) {
+                    edges.push_back({edge.target, edge.source, _mirror == Mirror::Symmetric ? edge.weight : -edge.weight});
+                }
+            }
+            first = lineEnd == last ? last : lineEnd + 1;
         }
-
-        double weight = 0.0;
-        try {
-            weight = _vertices.at(id1)._neighbors.at(id2);
-        } catch (const std::out_of_range& _) {}
-
-        return weight;
+        return std::nullopt;
     }
 
-    void set_edge_weight(const T& vertex1, const T& vertex2, double weight) override {
-        size_t id1 = 0;
-        size_t id2 = 0;
-        try {
-            id1 = _vertices2ids.at(vertex1);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex1 not found");
-        }
-        try {
-            id2 = _vertices2ids.at(vertex2);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex2 not found");
+    // parse whole lines in parallel and pass their edges to the builder
+    void parse_chunk(const char* first, const char* last, GraphBuilder<V>& builder, EdgeListStats& stats) {
+        if (_format == EdgeListFormat::MatrixMarket && !_sizeDone) {
+            first = parse_preamble(first, last, builder);
         }
 
-        if (weight == 0.0) {
-            _vertices.at(id1)._neighbors.erase(id2);
-        } else {
-            _vertices.at(id1)._neighbors[id2] = weight;
+        // split at line ends
+        const auto size = static_cast<size_t>(last - first);
+        const size_t blockCount = std::max<size_t>(std::min(_threadCount, size / 4096), 1);
+        std::vector<const char*> boundaries{first};
+        for (size_t block = 1; block < blockCount; ++block) {
+            const char* boundary = std::max(first + static_cast<std::ptrdiff_t>(size * block / blockCount), boundaries.back());
+            boundary = std::find(boundary, last, '\n');
+            boundaries.push_back(boundary == last ? last : boundary + 1);
         }
-    }
+        boundaries.push_back(last);
 
-    [[nodiscard]] bool get_vertex_visited(const T& vertex) const override {
-        try {
-            const size_t id = _vertices2ids.at(vertex);
-            return _vertices.at(id)._visited;
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
+        std::vector<std::vector<Edge<V>>> edges(blockCount);
+        std::vector<std::optional<std::string>> errors(blockCount);
+        parallel_blocks(blockCount, blockCount, [&](const size_t block, size_t, size_t) {
+            edges[block].reserve(static_cast<size_t>(boundaries[block + 1] - boundaries[block]) / 8);
+            errors[block] = parse_lines(boundaries[block], boundaries[block + 1], edges[block]);
+        });
+        for (size_t block = 0; block < blockCount; ++block) {
+            if (errors[block]) {
+                throw GraphFileException(*errors[block]);
+            }
+            builder.add_edges(edges[block]);
+            stats.edges += edges[block].size();
         }
     }
+public:
+    /**
+     * Create a reader.
+     * @param format The format of the files to read.
+     * @param threadCount The number of threads to parse with, 0 for one per hardware thread.
+     * @param chunkSize The number of bytes read from the file at a time.
+     */
+    explicit EdgeListReader(const EdgeListFormat format = EdgeListFormat::Snap, const size_t threadCount = 0, const size_t chunkSize = size_t{1} << 24)
+        : _format(format), _threadCount(resolve_thread_count(threadCount)), _chunkSize(std::max<size_t>(chunkSize, 1)) {}
 
-    void set_vertex_visited(const T& vertex, bool visited) override {
-        try {
-            _vertices.at(_vertices2ids.at(vertex))._visited = visited;
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
+    /**
+     * Read the edges of a file into a builder.
+     *
+     * Vertices that appear in the file are added to the builder too (with their edges, or explicitly for
+     * the rows and columns of a Matrix Market file). Edges are only added to a graph when the builder builds it,
+     * so the duplicate policy is chosen then.
+     * @param path The path of the file.
+     * @param builder The builder to add the edges to.
+     * @throws GraphFileException If the file can't be read or a line is malformed.
+     * @return The statistics of the read, including the parse throughput.
+     */
+    EdgeListStats read(const std::string& path, GraphBuilder<V>& builder) {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw GraphFileException("cannot open " + path);
         }
-    }
+        _headerDone = false;
+        _sizeDone = false;
+        _pattern = false;
+        _mirror = Mirror::None;
 
-    void reset_vertices_visited() override {
-        for (std::pair<const size_t, Vertex>& vertex : _vertices) {
-            vertex.second._visited = false;
+        EdgeListStats stats;
+        // the end of the previous chunk, after its last line end, is carried over to the start of the next one
+        std::vector<char> buffer;
+        size_t carried = 0;
+        bool atEnd = false;
+        while (!atEnd) {
+            buffer.resize(carried + _chunkSize);
+            file.read(buffer.data() + carried, static_cast<std::streamsize>(_chunkSize));
+            const auto readSize = static_cast<size_t>(file.gcount());
+            if (file.bad()) {
+                throw GraphFileException("cannot read " + path);
+            }
+            atEnd = readSize < _chunkSize;
+            stats.bytes += readSize;
+            const size_t filled = carried + readSize;
+
+            const char* first = buffer.data();
+            const char* last = first + filled;
+            if (!atEnd) {
+                // a line longer than a chunk is completed by the next chunk
+                const auto lineEnd = std::find(std::make_reverse_iterator(last), std::make_reverse_iterator(first), '\n');
+                last = lineEnd.base();
+            }
+            parse_chunk(first, last, builder, stats);
+            carried = filled - static_cast<size_t>(last - first);
+            std::copy(last, first + filled, buffer.begin());
         }
+        if (_format == EdgeListFormat::MatrixMarket && !_sizeDone) {
+            throw GraphFileException("missing Matrix Market size line: " + path);
+        }
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
     }
 };
 
-template <typename T>
-class GraphAdjacencyMatrix : public Graph<T> {
+/**
+ * Map from neighbor ids to edge weights, stored as one contiguous array of (id, weight) entries.
+ *
+ * While there are at most SMALL_SIZE entries, lookups scan the array, which beats hashing at the low degrees
+ * most vertices have. Past that, an open-addressing hash index (linear probing over Fibonacci hashes of the ids,
+ * at most 3/4 full) maps ids to positions in the array; it is dropped again when the table shrinks back.
+ * Iteration always walks the array. A removal moves the last entry into the hole, so the order is unspecified.
+ */
+template <typename W>
+class NeighborTable {
 private:
-    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
-    struct Vertex {
-        T _value;
-        bool _visited = false;
-        Vertex() : _value(T{}) {}
-        explicit Vertex(const T& value) : _value(value) {}
-    };
-    // NOLINTEND(misc-non-private-member-variables-in-classes)
+    static constexpr size_t SMALL_SIZE = 16;
+    static constexpr std::uint32_t EMPTY_SLOT = 0;
+    static constexpr std::uint64_t FIBONACCI_MULTIPLIER = 0x9E3779B97F4A7C15ULL;
 
-    std::unordered_map<T, size_t> _vertices2ids;
-    std::unordered_map<size_t, Vertex> _vertices;
-    std::unique_ptr<double[]> _adj_matrix;
-public:
-    // constructor
-    GraphAdjacencyMatrix() = default;
+    std::vector<std::pair<VertexId, W>> _entries;
 
-    // copy constructor
-    GraphAdjacencyMatrix(const GraphAdjacencyMatrix& other) : _vertices2ids(other._vertices2ids), _vertices(other._vertices), _adj_matrix(std::make_unique<double[]>(other.size() * other.size())) {
-        std::copy(other._adj_matrix.get(), other._adj_matrix.get() + other.size() * other.size(), _adj_matrix.get());
-    }
+    // hash index of the entries, holding their position + 1 (EMPTY_SLOT in free slots),
+    // a power of two slots long, or empty while lookups scan the entries
+    std::vector<std::uint32_t> _slots;
 
-    // move constructor
-    // NOLINTNEXTLINE(bugprone-exception-escape)
-    GraphAdjacencyMatrix(GraphAdjacencyMatrix&& other) noexcept : _vertices2ids(std::move(other._vertices2ids)), _vertices(std::move(other._vertices)), _adj_matrix(std::move(other._adj_matrix)) {}
+    // 64 minus the base 2 logarithm of the number of slots
+    std::uint32_t _shift = 0;
 
-    // copy assignment
-    GraphAdjacencyMatrix& operator=(const GraphAdjacencyMatrix& other) {
-        if (this == &other) {
-            return *this;
-        }
-        _vertices2ids = other._vertices2ids;
-        _vertices = other._vertices;
-        _adj_matrix = std::make_unique<double[]>(other.size() * other.size());
-        std::copy(other._adj_matrix.get(), other._adj_matrix.get() + other.size() * other.size(), _adj_matrix.get());
-        return *this;
+    [[nodiscard]] size_t home(const VertexId id) const {
+        // the high bits of the product depend on all the bits of the id, so consecutive ids are spread out
+        return static_cast<size_t>((static_cast<std::uint64_t>(id) * FIBONACCI_MULTIPLIER) >> _shift);
     }
 
-    // move assignment
-    GraphAdjacencyMatrix& operator=(GraphAdjacencyMatrix&& other) noexcept {
-        if (this == &other) {
-            return *this;
+    // find the slot holding the id, or the free slot where it would be inserted
+    [[nodiscard]] size_t slot_of(const VertexId id) const {
+        const size_t mask = _slots.size() - 1;
+        size_t slot = home(id);
+        while (_slots[slot] != EMPTY_SLOT && _entries[_slots[slot] - 1].first != id) {
+            slot = (slot + 1) & mask;
         }
-        _vertices2ids = std::move(other._vertices2ids);
-        _vertices = std::move(other._vertices);
-        _adj_matrix = std::move(other._adj_matrix);
-        return *this;
+        return slot;
     }
 
-    // destructor
-    ~GraphAdjacencyMatrix() override = default;
-
-    [[nodiscard]] size_t size() const override {
-        return _vertices.size();
+    // position of the entry with the id, _entries.size() if there is none
+    [[nodiscard]] size_t position_of(const VertexId id) const {
+        if (_slots.empty()) {
+            const auto entryIt = std::ranges::find(_entries, id, &std::pair<VertexId, W>::first);
+            return static_cast<size_t>(entryIt - _entries.begin());
+        }
+        const std::uint32_t slot = _slots[slot_of(id)];
+        return slot == EMPTY_SLOT ? _entries.size() : slot - 1;
     }
 
-    [[nodiscard]] bool adjacent(const T& vertex1, const T& vertex2) const override {
-        size_t id1 = 0;
-        size_t id2 = 0;
-        try {
-            id1 = _vertices2ids.at(vertex1);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex1 not found");
+    // rebuild the hash index with room for entryCount entries, or drop it if the table is small enough to be scanned
+    void rehash(const size_t entryCount) {
+        if (entryCount <= SMALL_SIZE / 2) {
+            _slots = std::vector<std::uint32_t>{};
+            return;
         }
-        try {
-            id2 = _vertices2ids.at(vertex2);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex2 not found");
+        const size_t slotCount = std::bit_ceil((entryCount * 4 / 3) + 1);
+        _slots.assign(slotCount, EMPTY_SLOT);
+        _shift = static_cast<std::uint32_t>(64 - std::countr_zero(slotCount));
+        for (size_t position = 0; position < _entries.size(); ++position) {
+            _slots[slot_of(_entries[position].first)] = static_cast<std::uint32_t>(position + 1);
         }
-        return _adj_matrix[id1 * size() + id2] != 0;
     }
 
-    [[nodiscard]] std::vector<T> neighbors(const T& vertex) const override {
-        size_t id = 0;
-        try {
-            id = _vertices2ids.at(vertex);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
-        }
-
-        std::vector<T> neighboursVec;
-        for (size_t i = id * size(); i < (id + 1) * size(); ++i) {
-            if (_adj_matrix[i] != 0) {
-                neighboursVec.push_back(_vertices.at(i % size())._value);
+    // empty a slot, moving later entries of its probe sequence back so that no lookup stops early
+    void free_slot(size_t slot) {
+        const size_t mask = _slots.size() - 1;
+        for (size_t next = (slot + 1) & mask; _slots[next] != EMPTY_SLOT; next = (next + 1) & mask) {
+            // the entry can fill the hole if its home slot is not in the cyclic range (slot, next]
+            const size_t wanted = home(_entries[_slots[next] - 1].first);
+            if (((next - wanted) & mask) >= ((next - slot) & mask)) {
+                _slots[slot] = _slots[next];
+                slot = next;
             }
         }
-        return neighboursVec;
+        _slots[slot] = EMPTY_SLOT;
     }
+public:
+    using const_iterator = std::vector<std::pair<VertexId, W>>::const_iterator;
 
-    void add_vertex(const T& vertex) override {
-        if (_vertices2ids.contains(vertex)) {
-            throw VertexAlreadyExistsException("vertex already exists");
-        }
-        const size_t oldSize = size();
-        _vertices2ids[vertex] = oldSize;
-        _vertices[oldSize] = Vertex{vertex};
+    [[nodiscard]] const_iterator begin() const {
+        return _entries.begin();
+    }
 
-        auto newAdjMatrix = std::make_unique<double[]>(size() * size());
-        for (size_t i = 0; i < oldSize; i++) {
-            std::move(_adj_matrix.get() + i * oldSize, _adj_matrix.get() + (i + 1) * oldSize, newAdjMatrix.get() + i * size());
-            newAdjMatrix[(i + 1) * size() - 1] = 0.0;
-        }
-        std::fill(newAdjMatrix.get() + (size() - 1) * size(), newAdjMatrix.get() + size() * size(), 0.0);
-        _adj_matrix = std::move(newAdjMatrix);
+    [[nodiscard]] const_iterator end() const {
+        return _entries.end();
     }
 
-    void remove_vertex(const T& vertex) override {
-        size_t id = 0;
-        try {
-            id = _vertices2ids.at(vertex);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
-        }
-        const size_t oldSize = size();
-        _vertices2ids.erase(vertex);
-        _vertices.erase(id);
+    [[nodiscard]] size_t size() const {
+        return _entries.size();
+    }
 
-        // update ids in _vertices2ids
-        for (std::pair<const T, size_t>& vertex2id : _vertices2ids) {
-            if (vertex2id.second > id) {
-                --vertex2id.second;
-            }
-        }
+    [[nodiscard]] bool empty() const {
+        return _entries.empty();
+    }
 
-        // update ids in _vertices
-        for (size_t i = id + 1; i < oldSize; ++i) {
-            auto node = _vertices.extract(i);
-            node.key() = i - 1;
-            _vertices.insert(std::move(node));
-        }
+    /**
+     * Check if there is an entry for an id.
+     * @param id The id to look for.
+     * @return true if there is an entry for the id, false otherwise.
+     */
+    [[nodiscard]] bool contains(const VertexId id) const {
+        return position_of(id) != _entries.size();
+    }
 
-        // update adjacency matrix (remove row and column for the removed vertex)
-        auto newAdjMatrix = std::make_unique<double[]>(size() * size());
-        for (size_t i = 0, j = 0; i < oldSize; i++) {
-            if (i != id) {
-                std::move(_adj_matrix.get() + i * oldSize, _adj_matrix.get() + i * oldSize + id, &newAdjMatrix[j]);
-                j += id;
-                std::move(_adj_matrix.get() + i * oldSize + id + 1, _adj_matrix.get() + (i + 1) * oldSize, &newAdjMatrix[j]);
-                j += oldSize - id - 1;
-            }
-        }
-        _adj_matrix = std::move(newAdjMatrix);
+    /**
+     * Find the weight of the entry for an id.
+     * @param id The id to look for.
+     * @return A pointer to the weight, valid until the table is modified, or nullptr if there is no entry for the id.
+     */
+    [[nodiscard]] const W* find(const VertexId id) const {
+        const size_t position = position_of(id);
+        return position == _entries.size() ? nullptr : &_entries[position].second;
     }
 
-    [[nodiscard]] double get_edge_weight(const T& vertex1, const T& vertex2) const override {
-        size_t id1 = 0;
-        size_t id2 = 0;
-        try {
-            id1 = _vertices2ids.at(vertex1);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex1 not found");
-        }
-        try {
-            id2 = _vertices2ids.at(vertex2);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex2 not found");
+    /**
+     * Reserve room for a number of entries, building the hash index at once if they will need it.
+     * @param entryCount The number of entries.
+     */
+    void reserve(const size_t entryCount) {
+        _entries.reserve(entryCount);
+        if (entryCount > SMALL_SIZE && entryCount * 4 > _slots.size() * 3) {
+            rehash(entryCount);
         }
-        return _adj_matrix[id1 * size() + id2];
     }
 
-    void set_edge_weight(const T& vertex1, const T& vertex2, const double weight) override {
-        size_t id1 = 0;
-        size_t id2 = 0;
-        try {
-            id1 = _vertices2ids.at(vertex1);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex1 not found");
+    /**
+     * Add an entry, or replace the weight of the entry already there for the id.
+     * @param id The id.
+     * @param weight The weight.
+     */
+    void insert_or_assign(const VertexId id, const W weight) {
+        if (_slots.empty()) {
+            const size_t position = position_of(id);
+            if (position != _entries.size()) {
+                _entries[position].second = weight;
+                return;
+            }
+            _entries.emplace_back(id, weight);
+            if (_entries.size() > SMALL_SIZE) {
+                rehash(_entries.size());
+            }
+            return;
         }
-        try {
-            id2 = _vertices2ids.at(vertex2);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex2 not found");
+        const size_t slot = slot_of(id);
+        if (_slots[slot] != EMPTY_SLOT) {
+            _entries[_slots[slot] - 1].second = weight;
+            return;
+        }
+        _entries.emplace_back(id, weight);
+        if (_entries.size() * 4 > _slots.size() * 3) {
+            rehash(_entries.size());
+        } else {
+            _slots[slot] = static_cast<std::uint32_t>(_entries.size());
         }
-        _adj_matrix[id1 * size() + id2] = weight;
     }
 
-    [[nodiscard]] bool get_vertex_visited(const T& vertex) const override {
-        try {
-            const size_t id = _vertices2ids.at(vertex);
-            return _vertices.at(id)._visited;
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
+    /**
+     * Remove the entry for an id, if there is one.
+     * @param id The id.
+     * @return true if an entry was removed, false otherwise.
+     */
+    bool erase(const VertexId id) {
+        size_t position = 0;
+        if (_slots.empty()) {
+            position = position_of(id);
+            if (position == _entries.size()) {
+                return false;
+            }
+        } else {
+            const size_t slot = slot_of(id);
+            if (_slots[slot] == EMPTY_SLOT) {
+                return false;
+            }
+            position = _slots[slot] - 1;
+            free_slot(slot);
+        }
+        if (position != _entries.size() - 1) {
+            _entries[position] = _entries.back();
+            if (!_slots.empty()) {
+                // the slot of the moved entry still points to the last position, which holds the same id
+                _slots[slot_of(_entries[position].first)] = static_cast<std::uint32_t>(position + 1);
+            }
+        }
+        _entries.pop_back();
+        if (!_slots.empty() && _entries.size() <= SMALL_SIZE / 2) {
+            rehash(_entries.size());
         }
+        return true;
     }
 
-    void set_vertex_visited(const T& vertex, bool visited) override {
-        try {
-            _vertices.at(_vertices2ids.at(vertex))._visited = visited;
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
+    /**
+     * Replace every id by its new id, removing the entries whose new id is NO_VERTEX.
+     * @param newIds The new id of every id.
+     */
+    void renumber(const std::span<const VertexId> newIds) {
+        std::erase_if(_entries, [newIds](const std::pair<VertexId, W>& entry) {
+            return newIds[entry.first] == NO_VERTEX;
+        });
+        for (std::pair<VertexId, W>& entry : _entries) {
+            entry.first = newIds[entry.first];
+        }
+        if (!_slots.empty()) {
+            rehash(_entries.size());
         }
     }
 
-    void reset_vertices_visited() override {
-        for (std::pair<const size_t, Vertex>& vertex : _vertices) {
-            vertex.second._visited = false;
+    /**
+     * Remove all entries matching a predicate, in one pass.
+     * @param predicate The predicate, called with each (id, weight) entry.
+     * @return The number of entries removed.
+     */
+    template <typename P>
+    size_t erase_if(P predicate) {
+        const size_t removed = std::erase_if(_entries, predicate);
+        if (removed != 0 && !_slots.empty()) {
+            rehash(_entries.size());
         }
+        return removed;
     }
 };
 
-template <typename T>
-class GraphIncidenceMatrix : public Graph<T> {
+template <typename T, typename W = double>
+class GraphAdjacencyList : public Graph<T, W> {
 private:
     // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
     struct Vertex {
         T _value;
+        NeighborTable<W> _neighbors;
         bool _visited = false;
         Vertex() : _value(T{}) {}
         explicit Vertex(const T& value) : _value(value) {}
@@ -616,287 +1376,4542 @@ private:
     // NOLINTEND(misc-non-private-member-variables-in-classes)
 
     std::unordered_map<T, size_t> _vertices2ids;
-    std::unordered_map<size_t, Vertex> _vertices;
-    size_t _edgeCount = 0;
+    // vertices indexed by id, empty at the ids of removed vertices
+    std::vector<std::optional<Vertex>> _vertices;
+    size_t _vertexCount = 0;
+
+    // ids of removed vertices, ready to be reused by add_vertex
+    std::vector<VertexId> _freeIds;
+
+    // ids of vertices removed in the tombstone mode, which may still be targets of (stale) edges in neighbor maps
+    std::vector<VertexId> _tombstones;
+    std::vector<bool> _isTombstone;
+
+    // sources and weights of the incoming edges of every id, kept in step with the neighbor maps
+    // while the predecessor index is enabled (empty otherwise)
+    std::vector<NeighborTable<W>> _predecessors;
+    bool _indexPredecessors = false;
+
+    [[nodiscard]] size_t checked_id(const T& vertex, const char* message) const {
+        const auto vertexIt = _vertices2ids.find(vertex);
+        if (vertexIt == _vertices2ids.end()) {
+            throw VertexNotFoundException(message);
+        }
+        return vertexIt->second;
+    }
+
+    [[nodiscard]] const Vertex& checked_vertex(const VertexId id, const char* message) const {
+        if (!contains_id(id)) {
+            throw VertexNotFoundException(message);
+        }
+        return *_vertices[id];
+    }
+
+    [[nodiscard]] Vertex& checked_vertex(const VertexId id, const char* message) {
+        if (!contains_id(id)) {
+            throw VertexNotFoundException(message);
+        }
+        return *_vertices[id];
+    }
+
+    // remove the vertex with the given id from the vertex array, freeing its neighbor table
+    void erase_vertex(const T& vertex, const size_t id) {
+        _vertices2ids.erase(vertex);
+        _vertices[id].reset();
+        --_vertexCount;
+    }
+
+    // check if an edge points to a removed vertex and must be skipped
+    [[nodiscard]] bool is_stale(const VertexId neighbor) const {
+        return !_tombstones.empty() && _isTombstone[neighbor];
+    }
+
+    // remove the vertex without touching the edges pointing to it, which are skipped until purge_tombstones()
+    void bury(const T& vertex, const size_t id) {
+        erase_vertex(vertex, id);
+        _tombstones.push_back(id);
+        _isTombstone[id] = true;
+    }
+
+    // remove the vertex and every edge from or to it through the predecessor index, freeing its id right away
+    void unlink(const T& vertex, const size_t id) {
+        for (const std::pair<VertexId, W>& neighbor : _vertices[id]->_neighbors) {
+            _predecessors[neighbor.first].erase(id);
+        }
+        for (const std::pair<VertexId, W>& predecessor : _predecessors[id]) {
+            _vertices[predecessor.first]->_neighbors.erase(id);
+        }
+        _predecessors[id] = NeighborTable<W>{};
+        erase_vertex(vertex, id);
+        _freeIds.push_back(id);
+    }
+
+    // remove all stale edges and make the ids of removed vertices available for reuse
+    void purge_tombstones() {
+        for (std::optional<Vertex>& vertex : _vertices) {
+            if (vertex) {
+                vertex->_neighbors.erase_if([this](const std::pair<VertexId, W>& neighbor) {
+                    return _isTombstone[neighbor.first];
+                });
+            }
+        }
+        for (const VertexId id : _tombstones) {
+            _isTombstone[id] = false;
+            _freeIds.push_back(id);
+        }
+        _tombstones.clear();
+    }
+
+    // walks the neighbor map of a vertex for neighbor_range(), skipping stale edges
+    class NeighborCursor {
+    private:
+        const GraphAdjacencyList* _graph = nullptr;
+        typename NeighborTable<W>::const_iterator _it;
+        typename NeighborTable<W>::const_iterator _end;
+
+        void skip_stale() {
+            while (_it != _end && _graph->is_stale(_it->first)) {
+                ++_it;
+            }
+        }
+    public:
+        NeighborCursor() = default;
+
+        NeighborCursor(const GraphAdjacencyList* graph, const Vertex& vertex) : _graph(graph), _it(vertex._neighbors.begin()), _end(vertex._neighbors.end()) {
+            skip_stale();
+        }
+
+        [[nodiscard]] bool done() const {
+            return _it == _end;
+        }
+
+        void advance() {
+            ++_it;
+            skip_stale();
+        }
+
+        [[nodiscard]] Neighbor<T, W> current() const {
+            return {_it->first, _graph->_vertices[_it->first]->_value, _it->second};
+        }
 
-    // (weight, outgoing edge)
-    std::unique_ptr<std::pair<double, bool>[]> _inc_matrix = nullptr;
+        bool operator==(const NeighborCursor& other) const = default;
+    };
 public:
+    using Graph<T, W>::adjacent;
+    using Graph<T, W>::neighbors;
+    using Graph<T, W>::get_edge_weight;
+    using Graph<T, W>::set_edge_weight;
+    using Graph<T, W>::for_each_neighbor;
+
     // constructor
-    GraphIncidenceMatrix() = default;
+    GraphAdjacencyList() = default;
 
     // copy constructor
-    GraphIncidenceMatrix(const GraphIncidenceMatrix& other) : _vertices2ids(other._vertices2ids), _vertices(other._vertices), _edgeCount(other._edgeCount), _inc_matrix(std::make_unique<std::pair<double, bool>[]>(other.size() * other.edge_count())) {
-        std::copy(other._inc_matrix.get(), other._inc_matrix.get() + other.size() * other.edge_count(), _inc_matrix.get());
-    }
+    GraphAdjacencyList(const GraphAdjacencyList& other) :
+        Graph<T, W>(other), _vertices2ids(other._vertices2ids), _vertices(other._vertices), _vertexCount(other._vertexCount),
+        _freeIds(other._freeIds), _tombstones(other._tombstones), _isTombstone(other._isTombstone),
+        _predecessors(other._predecessors), _indexPredecessors(other._indexPredecessors) {}
 
     // move constructor
     // NOLINTNEXTLINE(bugprone-exception-escape)
-    GraphIncidenceMatrix(GraphIncidenceMatrix&& other) noexcept : _vertices2ids(std::move(other._vertices2ids)), _vertices(std::move(other._vertices)), _edgeCount(other._edgeCount), _inc_matrix(std::move(other._inc_matrix)) {}
+    GraphAdjacencyList(GraphAdjacencyList&& other) noexcept :
+        Graph<T, W>(other), _vertices2ids(std::move(other._vertices2ids)), _vertices(std::move(other._vertices)), _vertexCount(other._vertexCount),
+        _freeIds(std::move(other._freeIds)), _tombstones(std::move(other._tombstones)), _isTombstone(std::move(other._isTombstone)),
+        _predecessors(std::move(other._predecessors)), _indexPredecessors(other._indexPredecessors) {
+        other._vertexCount = 0;
+        other._indexPredecessors = false;
+    }
 
     // copy assignment
-    GraphIncidenceMatrix& operator=(const GraphIncidenceMatrix& other) {
+    GraphAdjacencyList& operator=(const GraphAdjacencyList& other) {
         if (this == &other) {
             return *this;
         }
+        Graph<T, W>::operator=(other);
         _vertices2ids = other._vertices2ids;
         _vertices = other._vertices;
-        _edgeCount = other._edgeCount;
-        _inc_matrix = std::make_unique<std::pair<double, bool>[]>(other.size() * other.edge_count());
-        std::copy(other._inc_matrix.get(), other._inc_matrix.get() + other.size() * other.edge_count(), _inc_matrix.get());
+        _vertexCount = other._vertexCount;
+        _freeIds = other._freeIds;
+        _tombstones = other._tombstones;
+        _isTombstone = other._isTombstone;
+        _predecessors = other._predecessors;
+        _indexPredecessors = other._indexPredecessors;
         return *this;
     }
 
     // move assignment
-    GraphIncidenceMatrix& operator=(GraphIncidenceMatrix&& other) noexcept {
+    GraphAdjacencyList& operator=(GraphAdjacencyList&& other) noexcept {
         if (this == &other) {
             return *this;
         }
+        Graph<T, W>::operator=(other);
         _vertices2ids = std::move(other._vertices2ids);
         _vertices = std::move(other._vertices);
-        _edgeCount = other._edgeCount;
-        _inc_matrix = std::move(other._inc_matrix);
+        _vertexCount = other._vertexCount;
+        _freeIds = std::move(other._freeIds);
+        _tombstones = std::move(other._tombstones);
+        _isTombstone = std::move(other._isTombstone);
+        _predecessors = std::move(other._predecessors);
+        _indexPredecessors = other._indexPredecessors;
+        other._vertexCount = 0;
+        other._indexPredecessors = false;
         return *this;
     }
 
     // destructor
-    ~GraphIncidenceMatrix() override = default;
+    ~GraphAdjacencyList() override = default;
 
-    /**
-     * Get the number of edges in the graph.
-     * @return The number of edges in the graph.
-     */
-    [[nodiscard]] size_t edge_count() const {
-        return _edgeCount;
+    [[nodiscard]] size_t size() const override {
+        return _vertexCount;
     }
 
-    [[nodiscard]] size_t size() const override {
+    [[nodiscard]] size_t id_bound() const override {
         return _vertices.size();
     }
 
+    [[nodiscard]] bool contains_id(const VertexId id) const override {
+        return id < _vertices.size() && _vertices[id].has_value();
+    }
+
+    [[nodiscard]] VertexId id_of(const T& vertex) const override {
+        return checked_id(vertex, "vertex not found");
+    }
+
+    [[nodiscard]] std::optional<VertexId> find_vertex(const T& vertex) const override {
+        const auto vertexIt = _vertices2ids.find(vertex);
+        if (vertexIt == _vertices2ids.end()) {
+            return std::nullopt;
+        }
+        return vertexIt->second;
+    }
+
+    [[nodiscard]] const T& value_of(const VertexId id) const override {
+        return checked_vertex(id, "vertex not found")._value;
+    }
+
     [[nodiscard]] bool adjacent(const T& vertex1, const T& vertex2) const override {
-        size_t id1 = 0;
-        size_t id2 = 0;
-        try {
-            id1 = _vertices2ids.at(vertex1);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex1 not found");
+        return adjacent_by_id(checked_id(vertex1, "vertex1 not found"), checked_id(vertex2, "vertex2 not found"));
+    }
+
+    [[nodiscard]] std::vector<T> neighbors(const T& vertex) const override {
+        const size_t id = checked_id(vertex, "vertex not found");
+        std::vector<T> neighborsVec;
+        for (const std::pair<VertexId, W>& neighbor : _vertices[id]->_neighbors) {
+            if (!is_stale(neighbor.first)) {
+                neighborsVec.push_back(_vertices[neighbor.first]->_value);
+            }
         }
-        try {
-            id2 = _vertices2ids.at(vertex2);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex2 not found");
+        return neighborsVec;
+    }
+
+    void for_each_neighbor(const VertexId id, const NeighborVisitor<W> visitor) const override {
+        for (const std::pair<VertexId, W>& neighbor : checked_vertex(id, "vertex not found")._neighbors) {
+            if (!is_stale(neighbor.first)) {
+                visitor(neighbor.first, neighbor.second);
+            }
         }
+    }
 
-        for (size_t j = 0; j < edge_count(); j++) {
-            if (_inc_matrix[j * size() + id1].second && !_inc_matrix[j * size() + id2].second &&
-                _inc_matrix[j * size() + id1].first == _inc_matrix[j * size() + id2].first &&
-                _inc_matrix[j * size() + id1].first != 0.0) {
-                return true;
+    /**
+     * Get a lazy view over the outgoing edges of a vertex.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return A view yielding the id and the value of each neighbor and the weight of the edge leading to it.
+     */
+    [[nodiscard]] NeighborRange<T, NeighborCursor, W> neighbor_range(const VertexId id) const {
+        return NeighborRange<T, NeighborCursor, W>{NeighborCursor{this, checked_vertex(id, "vertex not found")}};
+    }
+
+    /**
+     * Check if the predecessor index is enabled.
+     * @return true if the incoming edges of every vertex are indexed, false otherwise.
+     */
+    [[nodiscard]] bool has_predecessor_index() const {
+        return _indexPredecessors;
+    }
+
+    /**
+     * Enable or disable the predecessor index, which stores the incoming edges of every vertex next to its outgoing ones.
+     *
+     * With the index, the predecessor queries take O(in-degree) time instead of probing every neighbor map,
+     * and remove_vertex() deletes the edges to the vertex right away in O(degree + in-degree), freeing its id without tombstones.
+     * It costs a second hash map entry per edge, and every edge insertion, update and removal also updates it.
+     * Enabling the index builds it in O(V + E), disabling it frees it.
+     * @param enabled true to maintain the index, false to drop it.
+     */
+    void set_predecessor_index(const bool enabled) {
+        if (enabled == _indexPredecessors) {
+            return;
+        }
+        _indexPredecessors = enabled;
+        _predecessors.clear();
+        if (!enabled) {
+            _predecessors.shrink_to_fit();
+            return;
+        }
+        if (!_tombstones.empty()) {
+            purge_tombstones();
+        }
+        std::vector<size_t> inDegrees(_vertices.size(), 0);
+        for (const std::optional<Vertex>& vertex : _vertices) {
+            if (vertex) {
+                for (const std::pair<VertexId, W>& neighbor : vertex->_neighbors) {
+                    ++inDegrees[neighbor.first];
+                }
+            }
+        }
+        _predecessors.resize(_vertices.size());
+        for (size_t id = 0; id < _vertices.size(); ++id) {
+            _predecessors[id].reserve(inDegrees[id]);
+        }
+        for (size_t id = 0; id < _vertices.size(); ++id) {
+            if (_vertices[id]) {
+                for (const std::pair<VertexId, W>& neighbor : _vertices[id]->_neighbors) {
+                    _predecessors[neighbor.first].insert_or_assign(id, neighbor.second);
+                }
             }
         }
-        return false;
     }
 
-    [[nodiscard]] std::vector<T> neighbors(const T& vertex) const override {
-        size_t id = 0;
-        try {
-            id = _vertices2ids.at(vertex);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
+    /**
+     * Call a function for every incoming edge of a vertex, in no particular order.
+     *
+     * Takes O(in-degree) time with the predecessor index, otherwise O(V) hash lookups.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @param visitor The function, called with the id of the source of each edge and its weight.
+     */
+    void for_each_predecessor(const VertexId id, const NeighborVisitor<W> visitor) const {
+        static_cast<void>(checked_vertex(id, "vertex not found"));
+        if (_indexPredecessors) {
+            for (const std::pair<VertexId, W>& predecessor : _predecessors[id]) {
+                visitor(predecessor.first, predecessor.second);
+            }
+            return;
         }
-        std::vector<T> neighboursVec;
-        for (size_t j = 0; j < edge_count(); j++) {
-            if (_inc_matrix[j * size() + id].second && _inc_matrix[j * size() + id].first != 0.0) {
-                for (size_t i = 0; i < size(); i++) {
-                    if (!_inc_matrix[j * size() + i].second &&
-                        _inc_matrix[j * size() + i].first == _inc_matrix[j * size() + id].first) {
-                        neighboursVec.push_back(_vertices.at(i)._value);
-                        break;
-                    }
+        for (size_t source = 0; source < _vertices.size(); ++source) {
+            if (_vertices[source]) {
+                if (const W* weight = _vertices[source]->_neighbors.find(id)) {
+                    visitor(source, *weight);
                 }
             }
         }
-        return neighboursVec;
     }
 
-    void add_vertex(const T& vertex) override {
-        if (_vertices2ids.contains(vertex)) {
-            throw VertexAlreadyExistsException("vertex already exists");
+    /**
+     * Get the vertices with an edge to a vertex.
+     * @throws VertexNotFoundException If the vertex doesn't exist.
+     * @param vertex The vertex.
+     * @return The sources of the incoming edges of the vertex.
+     */
+    [[nodiscard]] std::vector<T> predecessors(const T& vertex) const {
+        std::vector<T> predecessorsVec;
+        for_each_predecessor(checked_id(vertex, "vertex not found"), [&](const VertexId id, const W /*weight*/) {
+            predecessorsVec.push_back(_vertices[id]->_value);
+        });
+        return predecessorsVec;
+    }
+
+    /**
+     * Get the number of incoming edges of a vertex (O(1) with the predecessor index, O(V) otherwise).
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return The number of incoming edges of the vertex.
+     */
+    [[nodiscard]] size_t in_degree(const VertexId id) const {
+        static_cast<void>(checked_vertex(id, "vertex not found"));
+        if (_indexPredecessors) {
+            return _predecessors[id].size();
         }
-        const size_t oldSize = size();
-        _vertices2ids[vertex] = oldSize;
-        _vertices[oldSize] = Vertex{vertex};
-        auto newIncMatrix = std::make_unique<std::pair<double, bool>[]>(size() * edge_count());
+        size_t count = 0;
+        for_each_predecessor(id, [&count](VertexId, W) { ++count; });
+        return count;
+    }
 
-        for (size_t j = 0; j < edge_count(); j++) {
-            std::move(_inc_matrix.get() + j * oldSize, _inc_matrix.get() + (j + 1) * oldSize, newIncMatrix.get() + j * size());
-            newIncMatrix[(j + 1) * size() - 1] = std::pair{0.0, false};
+    /**
+     * Read-only view of the graph with every edge reversed, whose for_each_neighbor() enumerates predecessors.
+     *
+     * It shares the ids of the graph and stays valid as long as the graph does, so it can be passed as the reverse graph
+     * of bidirectional_dijkstra() without building a transpose. Enable the predecessor index before using it.
+     */
+    class ReverseView {
+    private:
+        const GraphAdjacencyList* _graph;
+    public:
+        explicit ReverseView(const GraphAdjacencyList& graph) : _graph(&graph) {}
+
+        [[nodiscard]] size_t size() const {
+            return _graph->size();
         }
 
-        _inc_matrix = std::move(newIncMatrix);
-    }
+        [[nodiscard]] size_t id_bound() const {
+            return _graph->id_bound();
+        }
 
-    void remove_vertex(const T& vertex) override {
-        size_t id = 0;
-        try {
-            id = _vertices2ids.at(vertex);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
+        [[nodiscard]] bool contains_id(const VertexId id) const {
+            return _graph->contains_id(id);
         }
-        const size_t oldSize = size();
-        _vertices2ids.erase(vertex);
-        _vertices.erase(id);
 
-        // update ids in _vertices2ids
-        for (std::pair<const T, size_t>& vertex2id : _vertices2ids) {
-            if (vertex2id.second > id) {
-                --vertex2id.second;
+        void for_each_neighbor(const VertexId id, const NeighborVisitor<W> visitor) const {
+            _graph->for_each_predecessor(id, visitor);
+        }
+    };
+
+    /**
+     * Get a view of the graph with every edge reversed (see ReverseView).
+     * @return The reverse view.
+     */
+    [[nodiscard]] ReverseView reverse_view() const {
+        return ReverseView{*this};
+    }
+
+    VertexId add_vertex(const T& vertex) override {
+        if (_vertices2ids.contains(vertex)) {
+            throw VertexAlreadyExistsException("vertex already exists");
+        }
+        size_t newId = _vertices.size();
+        if (_freeIds.empty()) {
+            _vertices.emplace_back();
+            _isTombstone.push_back(false);
+            if (_indexPredecessors) {
+                _predecessors.emplace_back();
             }
+        } else {
+            newId = _freeIds.back();
+            _freeIds.pop_back();
         }
+        _vertices2ids[vertex] = newId;
+        _vertices[newId].emplace(vertex);
+        ++_vertexCount;
+        return newId;
+    }
 
-        // update ids in _vertices
-        for (size_t i = id + 1; i < oldSize; ++i) {
-            auto node = _vertices.extract(i);
-            node.key() = i - 1;
-            _vertices.insert(std::move(node));
+    void remove_vertex(const T& vertex) override {
+        const size_t id = checked_id(vertex, "vertex not found");
+        if (_indexPredecessors) {
+            unlink(vertex, id);
+        } else {
+            bury(vertex, id);
         }
+        if (this->removal_mode() == RemovalMode::Renumber) {
+            compact();
+        } else if (_tombstones.size() > _vertexCount) {
+            // purging costs O(V + E), so it is done only after O(V) removals
+            purge_tombstones();
+        }
+    }
 
-        // update edge count
-        const size_t oldEdgeCount = edge_count();
-        for (size_t j = 0; j < oldEdgeCount; j++) {
-            if (_inc_matrix[j * oldSize + id].first != 0.0) {
-                _edgeCount--;
+    std::vector<VertexId> compact() override {
+        std::vector<VertexId> newIds(_vertices.size(), NO_VERTEX);
+        size_t nextId = 0;
+        for (size_t id = 0; id < _vertices.size(); ++id) {
+            if (_vertices[id]) {
+                newIds[id] = nextId++;
             }
         }
 
-        // update incidence matrix
-        auto newIncMatrix = std::make_unique<std::pair<double, bool>[]>(size() * edge_count());
-        for (size_t i = 0, j = 0; i < oldEdgeCount; i++) {
-            if (_inc_matrix[i * oldSize + id].first == 0.0) {
-                std::move(_inc_matrix.get() + i * oldSize, _inc_matrix.get() + i * oldSize + id, newIncMatrix.get() + j);
-                j += id;
-                std::move(_inc_matrix.get() + i * oldSize + id + 1, _inc_matrix.get() + (i + 1) * oldSize, newIncMatrix.get() + j);
-                j += oldSize - id - 1;
+        // ids only decrease, so the vertices are moved down in place
+        for (size_t id = 0; id < _vertices.size(); ++id) {
+            if (newIds[id] == NO_VERTEX) {
+                continue;
+            }
+            _vertices[id]->_neighbors.renumber(newIds);
+            if (_indexPredecessors) {
+                _predecessors[id].renumber(newIds);
+            }
+            if (newIds[id] != id) {
+                _vertices[newIds[id]] = std::move(_vertices[id]);
+                if (_indexPredecessors) {
+                    _predecessors[newIds[id]] = std::move(_predecessors[id]);
+                }
             }
         }
-        _inc_matrix = std::move(newIncMatrix);
+        _vertices.resize(nextId);
+        if (_indexPredecessors) {
+            _predecessors.resize(nextId);
+        }
+        for (std::pair<const T, size_t>& vertex2id : _vertices2ids) {
+            vertex2id.second = newIds[vertex2id.second];
+        }
+
+        _freeIds.clear();
+        _tombstones.clear();
+        _isTombstone.assign(nextId, false);
+        return newIds;
     }
 
-    [[nodiscard]] bool get_vertex_visited(const T& vertex) const override {
-        try {
-            const size_t id = _vertices2ids.at(vertex);
-            return _vertices.at(id)._visited;
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
+    [[nodiscard]] W get_edge_weight(const T& vertex1, const T& vertex2) const override {
+        return get_edge_weight_by_id(checked_id(vertex1, "vertex1 not found"), checked_id(vertex2, "vertex2 not found"));
+    }
+
+    [[nodiscard]] std::optional<W> try_get_edge_weight(const T& vertex1, const T& vertex2) const override {
+        const auto vertexIt1 = _vertices2ids.find(vertex1);
+        const auto vertexIt2 = _vertices2ids.find(vertex2);
+        if (vertexIt1 == _vertices2ids.end() || vertexIt2 == _vertices2ids.end()) {
+            return std::nullopt;
         }
+        const W* weight = _vertices[vertexIt1->second]->_neighbors.find(vertexIt2->second);
+        if (weight == nullptr) {
+            return std::nullopt;
+        }
+        return *weight;
+    }
+
+    void set_edge_weight(const T& vertex1, const T& vertex2, const W weight) override {
+        set_edge_weight_by_id(checked_id(vertex1, "vertex1 not found"), checked_id(vertex2, "vertex2 not found"), weight);
+    }
+
+    [[nodiscard]] bool get_vertex_visited(const T& vertex) const override {
+        return _vertices[checked_id(vertex, "vertex not found")]->_visited;
     }
 
     void set_vertex_visited(const T& vertex, bool visited) override {
-        try {
-            _vertices.at(_vertices2ids.at(vertex))._visited = visited;
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex not found");
-        }
+        _vertices[checked_id(vertex, "vertex not found")]->_visited = visited;
     }
 
     void reset_vertices_visited() override {
-        for (std::pair<const size_t, Vertex>& vertex : _vertices) {
-            vertex.second._visited = false;
+        for (std::optional<Vertex>& vertex : _vertices) {
+            if (vertex) {
+                vertex->_visited = false;
+            }
         }
     }
 
-    [[nodiscard]] double get_edge_weight(const T& vertex1, const T& vertex2) const override {
-        size_t id1 = 0;
-        size_t id2 = 0;
-        try {
-            id1 = _vertices2ids.at(vertex1);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex1 not found");
-        }
-        try {
-            id2 = _vertices2ids.at(vertex2);
-        } catch (const std::out_of_range& _) {
+    [[nodiscard]] bool adjacent_by_id(const VertexId id1, const VertexId id2) const override {
+        const Vertex& vertex1 = checked_vertex(id1, "vertex1 not found");
+        if (!contains_id(id2)) {
             throw VertexNotFoundException("vertex2 not found");
         }
-        for (size_t j = 0; j < edge_count(); j++) {
-            if (_inc_matrix[j * size() + id1].second && !_inc_matrix[j * size() + id2].second &&
-                _inc_matrix[j * size() + id1].first == _inc_matrix[j * size() + id2].first &&
-                _inc_matrix[j * size() + id1].first != 0.0) {
-                return _inc_matrix[j * size() + id1].first;
+        return vertex1._neighbors.contains(id2);
+    }
+
+    [[nodiscard]] std::vector<VertexId> neighbors_by_id(const VertexId id) const override {
+        const Vertex& vertex = checked_vertex(id, "vertex not found");
+        std::vector<VertexId> neighborsVec;
+        neighborsVec.reserve(vertex._neighbors.size());
+        for (const std::pair<VertexId, W>& neighbor : vertex._neighbors) {
+            if (!is_stale(neighbor.first)) {
+                neighborsVec.push_back(neighbor.first);
             }
         }
-        return 0;
+        return neighborsVec;
     }
 
-    void set_edge_weight(const T& vertex1, const T& vertex2, const double weight) override {
-        size_t id1 = 0;
-        size_t id2 = 0;
-        try {
-            id1 = _vertices2ids.at(vertex1);
-        } catch (const std::out_of_range& _) {
-            throw VertexNotFoundException("vertex1 not found");
+    [[nodiscard]] W get_edge_weight_by_id(const VertexId id1, const VertexId id2) const override {
+        const Vertex& vertex1 = checked_vertex(id1, "vertex1 not found");
+        if (!contains_id(id2)) {
+            throw VertexNotFoundException("vertex2 not found");
         }
-        try {
-            id2 = _vertices2ids.at(vertex2);
-        } catch (const std::out_of_range& _) {
+        const W* weight = vertex1._neighbors.find(id2);
+        return weight == nullptr ? W{} : *weight;
+    }
+
+    void set_edge_weight_by_id(const VertexId id1, const VertexId id2, const W weight) override {
+        Vertex& vertex1 = checked_vertex(id1, "vertex1 not found");
+        if (!contains_id(id2)) {
             throw VertexNotFoundException("vertex2 not found");
         }
+        vertex1._neighbors.insert_or_assign(id2, weight);
+        if (_indexPredecessors) {
+            _predecessors[id2].insert_or_assign(id1, weight);
+        }
+    }
+protected:
+    void remove_existing_edge(const VertexId id1, const VertexId id2) override {
+        _vertices[id1]->_neighbors.erase(id2);
+        if (_indexPredecessors) {
+            _predecessors[id2].erase(id1);
+        }
+    }
 
-        // if the weight is 0, remove the edge if it is present
-        if (weight == 0) {
-            bool is_present = false;
-            size_t edge_id = 0;
-            for (size_t i = 0; i < edge_count(); i++) {
-                if (_inc_matrix[i * size() + id1].second && !_inc_matrix[i * size() + id2].second &&
-                    _inc_matrix[i * size() + id1].first == _inc_matrix[i * size() + id2].first &&
-                    _inc_matrix[i * size() + id1].first != 0.0) {
-                    is_present = true;
-                    edge_id = i;
-                    break;
-                }
+    void insert_edges(const std::span<const Edge<VertexId, W>> edges) override {
+        for (size_t first = 0, last = 0; first < edges.size(); first = last) {
+            const VertexId source = edges[first].source;
+            while (last < edges.size() && edges[last].source == source) {
+                ++last;
             }
-            if (is_present) {
-                const size_t oldEdgeCount = edge_count();
-                _edgeCount--;
-                auto newIncMatrix = std::make_unique<std::pair<double, bool>[]>(size() * edge_count());
-                for (size_t i = 0, j = 0; i < oldEdgeCount; i++) {
-                    if (i != edge_id) {
-                        std::move(_inc_matrix.get() + i * size(), _inc_matrix.get() + (i + 1) * size(), newIncMatrix.get() + j);
-                        j += size();
-                    }
+            NeighborTable<W>& neighbors = _vertices[source]->_neighbors;
+            neighbors.reserve(neighbors.size() + (last - first));
+            for (size_t i = first; i < last; ++i) {
+                neighbors.insert_or_assign(edges[i].target, edges[i].weight);
+                if (_indexPredecessors) {
+                    _predecessors[edges[i].target].insert_or_assign(source, edges[i].weight);
                 }
-                _inc_matrix = std::move(newIncMatrix);
             }
+        }
+    }
+};
+
+/**
+ * Adjacency matrix storing whether every edge is present in one bit, and its weight apart.
+ *
+ * The weights take sizeof(W) bytes per pair of vertices (nothing for Unweighted), so a narrower
+ * weight type shrinks the matrix: float or std::uint32_t halve it compared to double, std::uint8_t divides it by 8.
+ * Neighbors are enumerated with count-trailing-zeros scans of the presence bits.
+ */
+template <typename T, typename W = double>
+class GraphAdjacencyMatrix : public Graph<T, W> {
+private:
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    struct Vertex {
+        T _value;
+        bool _visited = false;
+        Vertex() : _value(T{}) {}
+        explicit Vertex(const T& value) : _value(value) {}
+    };
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+
+    std::unordered_map<T, size_t> _vertices2ids;
+    std::unordered_map<size_t, Vertex> _vertices;
+
+    // bit j of row i is set if there is an edge from i to j (rows are row_words() words long)
+    std::vector<std::uint64_t> _present;
+
+    // weight of the edge from i to j at i * _capacity + j (W{} if there is no such edge, empty for unweighted graphs)
+    std::vector<W> _weights;
+
+    // number of rows (and columns) of the adjacency matrix that are in use
+    size_t _idBound = 0;
+
+    // number of allocated rows (and columns) of the adjacency matrix, which is also the row stride of the weights
+    // (no edges are present outside of the first _idBound rows and columns)
+    size_t _capacity = 0;
+
+    // ids of removed vertices, ready to be reused by add_vertex
+    std::vector<VertexId> _freeIds;
+
+    [[nodiscard]] size_t checked_id(const T& vertex, const char* message) const {
+        const auto vertexIt = _vertices2ids.find(vertex);
+        if (vertexIt == _vertices2ids.end()) {
+            throw VertexNotFoundException(message);
+        }
+        return vertexIt->second;
+    }
+
+    // number of words of a row of presence bits
+    [[nodiscard]] size_t row_words() const {
+        return (_capacity + WORD_BITS - 1) / WORD_BITS;
+    }
+
+    [[nodiscard]] std::uint64_t* presence_row(const VertexId id) {
+        return _present.data() + id * row_words();
+    }
+
+    [[nodiscard]] bool test(const VertexId id1, const VertexId id2) const {
+        return ((presence_row(id1)[id2 / WORD_BITS] >> (id2 % WORD_BITS)) & 1U) != 0;
+    }
+
+    [[nodiscard]] W weight_at(const VertexId id1, const VertexId id2) const {
+        if constexpr (std::is_empty_v<W>) {
+            return W{};
         } else {
-            // if the weight is not zero, the edge must be either updated or added to the incidence matrix
-            bool is_present = false;
-            for (size_t i = 0; i < edge_count(); i++) {
-                if (_inc_matrix[i * size() + id1].second && !_inc_matrix[i * size() + id2].second &&
-                    _inc_matrix[i * size() + id1].first == _inc_matrix[i * size() + id2].first &&
-                    _inc_matrix[i * size() + id1].first != 0.0) {
-                        is_present = true;
-                        _inc_matrix[i * size() + id1].first = _inc_matrix[i * size() + id2].first = weight;
-                        break;
-                    }
+            return _weights[id1 * _capacity + id2];
+        }
+    }
+
+    void store(const VertexId id1, const VertexId id2, const W weight) {
+        presence_row(id1)[id2 / WORD_BITS] |= std::uint64_t{1} << (id2 % WORD_BITS);
+        if constexpr (!std::is_empty_v<W>) {
+            _weights[id1 * _capacity + id2] = weight;
+        }
+    }
+
+    void erase(const VertexId id1, const VertexId id2) {
+        presence_row(id1)[id2 / WORD_BITS] &= ~(std::uint64_t{1} << (id2 % WORD_BITS));
+        if constexpr (!std::is_empty_v<W>) {
+            _weights[id1 * _capacity + id2] = W{};
+        }
+    }
+
+    // move the matrix to a new allocation with the given capacity
+    void reallocate(const size_t capacity) {
+        const size_t newRowWords = (capacity + WORD_BITS - 1) / WORD_BITS;
+        std::vector<std::uint64_t> newPresent(capacity * newRowWords, 0);
+        for (size_t i = 0; i < _idBound; i++) {
+            std::copy(presence_row(i), presence_row(i) + used_words(), newPresent.data() + i * newRowWords);
+        }
+        _present = std::move(newPresent);
+        if constexpr (!std::is_empty_v<W>) {
+            std::vector<W> newWeights(capacity * capacity);
+            for (size_t i = 0; i < _idBound; i++) {
+                std::copy(_weights.begin() + static_cast<std::ptrdiff_t>(i * _capacity), _weights.begin() + static_cast<std::ptrdiff_t>(i * _capacity + _idBound),
+                          newWeights.begin() + static_cast<std::ptrdiff_t>(i * capacity));
+            }
+            _weights = std::move(newWeights);
+        }
+        _capacity = capacity;
+    }
+
+    // add a vertex with a new id, the capacity must be greater than the id bound
+    VertexId append_vertex(const T& vertex) {
+        const size_t newId = _idBound;
+        _idBound++;
+        _vertices2ids[vertex] = newId;
+        _vertices[newId] = Vertex{vertex};
+        return newId;
+    }
+
+protected:
+    static constexpr size_t WORD_BITS = 64;
+
+    // number of words of a row that can have bits set
+    [[nodiscard]] size_t used_words() const {
+        return (_idBound + WORD_BITS - 1) / WORD_BITS;
+    }
+
+    [[nodiscard]] const std::uint64_t* presence_row(const VertexId id) const {
+        return _present.data() + id * row_words();
+    }
+
+    void check_id(const VertexId id, const char* message) const {
+        if (!_vertices.contains(id)) {
+            throw VertexNotFoundException(message);
+        }
+    }
+private:
+    // walks the presence bits of the row of a vertex for neighbor_range()
+    class NeighborCursor {
+    private:
+        const GraphAdjacencyMatrix* _graph = nullptr;
+        VertexId _id = 0;
+        size_t _word = 0;
+        std::uint64_t _remaining = 0;
+
+        void skip_empty_words() {
+            while (_remaining == 0 && ++_word < _graph->used_words()) {
+                _remaining = _graph->presence_row(_id)[_word];
             }
-            if (!is_present) {
-                // if the edge is not present, it must be added
-                const size_t oldEdgeCount = edge_count();
-                _edgeCount++;
-                auto newIncMatrix = std::make_unique<std::pair<double, bool>[]>(size() * edge_count());
-                std::move(_inc_matrix.get(), _inc_matrix.get() + oldEdgeCount * size(), newIncMatrix.get());
-                std::fill(
-                    newIncMatrix.get() + oldEdgeCount * size(),
-                    newIncMatrix.get() + edge_count() * size(),
-                    std::pair{0.0, false}
-                    );
-                newIncMatrix[oldEdgeCount * size() + id1] = std::pair{weight, true};
-                newIncMatrix[oldEdgeCount * size() + id2] = std::pair{weight, false};
-                _inc_matrix = std::move(newIncMatrix);
+        }
+    public:
+        NeighborCursor() = default;
+
+        NeighborCursor(const GraphAdjacencyMatrix* graph, const VertexId id) : _graph(graph), _id(id) {
+            if (graph->used_words() != 0) {
+                _remaining = graph->presence_row(id)[0];
             }
+            skip_empty_words();
+        }
+
+        [[nodiscard]] bool done() const {
+            return _remaining == 0;
+        }
+
+        void advance() {
+            _remaining &= _remaining - 1;
+            skip_empty_words();
+        }
+
+        [[nodiscard]] Neighbor<T, W> current() const {
+            const VertexId column = _word * WORD_BITS + static_cast<size_t>(std::countr_zero(_remaining));
+            return {column, _graph->_vertices.find(column)->second._value, _graph->weight_at(_id, column)};
         }
+
+        bool operator==(const NeighborCursor& other) const = default;
+    };
+public:
+    using Graph<T, W>::adjacent;
+    using Graph<T, W>::neighbors;
+    using Graph<T, W>::get_edge_weight;
+    using Graph<T, W>::set_edge_weight;
+    using Graph<T, W>::for_each_neighbor;
+
+    // constructor
+    GraphAdjacencyMatrix() = default;
+
+    // copy constructor
+    GraphAdjacencyMatrix(const GraphAdjacencyMatrix& other) : Graph<T, W>(other), _vertices2ids(other._vertices2ids), _vertices(other._vertices), _present(other._present), _weights(other._weights), _idBound(other._idBound), _capacity(other._capacity), _freeIds(other._freeIds) {}
+
+    // move constructor
+    // NOLINTNEXTLINE(bugprone-exception-escape)
+    GraphAdjacencyMatrix(GraphAdjacencyMatrix&& other) noexcept : Graph<T, W>(other), _vertices2ids(std::move(other._vertices2ids)), _vertices(std::move(other._vertices)), _present(std::move(other._present)), _weights(std::move(other._weights)), _idBound(other._idBound), _capacity(other._capacity), _freeIds(std::move(other._freeIds)) {
+        other._idBound = 0;
+        other._capacity = 0;
     }
-};
+
+    // copy assignment
+    GraphAdjacencyMatrix& operator=(const GraphAdjacencyMatrix& other) {
+        if (this == &other) {
+            return *this;
+        }
+        Graph<T, W>::operator=(other);
+        _vertices2ids = other._vertices2ids;
+        _vertices = other._vertices;
+        _present = other._present;
+        _weights = other._weights;
+        _idBound = other._idBound;
+        _capacity = other._capacity;
+        _freeIds = other._freeIds;
+        return *this;
+    }
+
+    // move assignment
+    GraphAdjacencyMatrix& operator=(GraphAdjacencyMatrix&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        Graph<T, W>::operator=(other);
+        _vertices2ids = std::move(other._vertices2ids);
+        _vertices = std::move(other._vertices);
+        _present = std::move(other._present);
+        _weights = std::move(other._weights);
+        _idBound = other._idBound;
+        _capacity = other._capacity;
+        other._idBound = 0;
+        other._capacity = 0;
+        _freeIds = std::move(other._freeIds);
+        return *this;
+    }
+    // destructor
+    ~GraphAdjacencyMatrix() override = default;
+
+    [[nodiscard]] size_t size() const override {
+        return _vertices.size();
+    }
+
+    [[nodiscard]] size_t id_bound() const override {
+        return _idBound;
+    }
+
+    [[nodiscard]] bool contains_id(const VertexId id) const override {
+        return _vertices.contains(id);
+    }
+
+    [[nodiscard]] VertexId id_of(const T& vertex) const override {
+        return checked_id(vertex, "vertex not found");
+    }
+
+    [[nodiscard]] std::optional<VertexId> find_vertex(const T& vertex) const override {
+        const auto vertexIt = _vertices2ids.find(vertex);
+        if (vertexIt == _vertices2ids.end()) {
+            return std::nullopt;
+        }
+        return vertexIt->second;
+    }
+
+    [[nodiscard]] const T& value_of(const VertexId id) const override {
+        check_id(id, "vertex not found");
+        return _vertices.find(id)->second._value;
+    }
+
+    [[nodiscard]] bool adjacent(const T& vertex1, const T& vertex2) const override {
+        return adjacent_by_id(checked_id(vertex1, "vertex1 not found"), checked_id(vertex2, "vertex2 not found"));
+    }
+
+    [[nodiscard]] std::vector<T> neighbors(const T& vertex) const override {
+        const size_t id = checked_id(vertex, "vertex not found");
+
+        std::vector<T> neighboursVec;
+        for_each_neighbor(id, [this, &neighboursVec](const VertexId neighbor, W) {
+            neighboursVec.push_back(_vertices.find(neighbor)->second._value);
+        });
+        return neighboursVec;
+    }
+
+    void for_each_neighbor(const VertexId id, const NeighborVisitor<W> visitor) const override {
+        check_id(id, "vertex not found");
+        const std::uint64_t* row = presence_row(id);
+        for (size_t word = 0; word < used_words(); ++word) {
+            for (std::uint64_t bits = row[word]; bits != 0; bits &= bits - 1) {
+                const VertexId neighbor = word * WORD_BITS + static_cast<size_t>(std::countr_zero(bits));
+                visitor(neighbor, weight_at(id, neighbor));
+            }
+        }
+    }
+
+    /**
+     * Get a lazy view over the outgoing edges of a vertex.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return A view yielding the id and the value of each neighbor and the weight of the edge leading to it.
+     */
+    [[nodiscard]] NeighborRange<T, NeighborCursor, W> neighbor_range(const VertexId id) const {
+        check_id(id, "vertex not found");
+        return NeighborRange<T, NeighborCursor, W>{NeighborCursor{this, id}};
+    }
+
+    VertexId add_vertex(const T& vertex) override {
+        if (_vertices2ids.contains(vertex)) {
+            throw VertexAlreadyExistsException("vertex already exists");
+        }
+        if (!_freeIds.empty()) {
+            // the row and the column of a freed id are already cleared
+            const size_t newId = _freeIds.back();
+            _freeIds.pop_back();
+            _vertices2ids[vertex] = newId;
+            _vertices[newId] = Vertex{vertex};
+            return newId;
+        }
+
+        if (_idBound == _capacity) {
+            // grow geometrically, so that adding n vertices costs O(n^2) in total
+            reallocate(std::max<size_t>(2 * _capacity, 4));
+        }
+        return append_vertex(vertex);
+    }
+
+    /**
+     * Add multiple vertices to the graph.
+     *
+     * The adjacency matrix is reallocated at most once.
+     * If any of the vertices already exists (or is repeated), no vertices are added.
+     * @throws VertexAlreadyExistsException If any of the vertices already exists, or is repeated.
+     * @param vertices The vertices to add.
+     * @return The ids of the added vertices, in the order of the vertices.
+     */
+    template <std::ranges::input_range R>
+    std::vector<VertexId> add_vertices(R&& vertices) {
+        std::vector<T> newVertices(std::ranges::begin(vertices), std::ranges::end(vertices));
+        std::unordered_set<T> seen;
+        seen.reserve(newVertices.size());
+        for (const T& vertex : newVertices) {
+            if (_vertices2ids.contains(vertex) || !seen.insert(vertex).second) {
+                throw VertexAlreadyExistsException("vertex already exists");
+            }
+        }
+
+        std::vector<VertexId> ids;
+        ids.reserve(newVertices.size());
+        const size_t reused = std::min(newVertices.size(), _freeIds.size());
+        if (_idBound + newVertices.size() - reused > _capacity) {
+            reserve(_idBound + newVertices.size() - reused);
+        }
+        for (const T& vertex : newVertices) {
+            ids.push_back(add_vertex(vertex));
+        }
+        return ids;
+    }
+
+    /**
+     * Get the number of vertices the adjacency matrix has room for without reallocating.
+     * @return The capacity of the adjacency matrix.
+     */
+    [[nodiscard]] size_t capacity() const {
+        return _capacity;
+    }
+
+    /**
+     * Reserve room in the adjacency matrix for the given number of vertices.
+     *
+     * If the capacity is already large enough, nothing is done.
+     * @param capacity The number of vertices to reserve room for.
+     */
+    void reserve(const size_t capacity) {
+        if (capacity > _capacity) {
+            reallocate(capacity);
+        }
+    }
+
+    /**
+     * Get the presence bits of the row of a vertex in the adjacency matrix.
+     *
+     * Bit j % 64 of word j / 64 is set if there is an edge to the vertex with id j.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return A view of the words of the row that can have bits set.
+     */
+    [[nodiscard]] std::span<const std::uint64_t> neighbor_bits(const VertexId id) const {
+        check_id(id, "vertex not found");
+        return {presence_row(id), used_words()};
+    }
+
+    /**
+     * Get the weights of the row of a vertex in the adjacency matrix.
+     *
+     * Entry j is the weight of the edge to the vertex with id j, or W{} if there is no such edge
+     * (neighbor_bits() tells it from an edge of weight W{}).
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return A view of the row, with one entry per id (its size is the id bound).
+     */
+    [[nodiscard]] std::span<const W> weight_row(const VertexId id) const requires (!std::is_empty_v<W>) {
+        check_id(id, "vertex not found");
+        return std::span<const W>(_weights).subspan(id * _capacity, _idBound);
+    }
+
+    /**
+     * Get the number of bytes taken by the adjacency matrix (presence bits and weights).
+     * @return The size of the adjacency matrix in bytes.
+     */
+    [[nodiscard]] size_t matrix_bytes() const {
+        return _present.size() * sizeof(std::uint64_t) + _weights.size() * sizeof(W);
+    }
+
+    void remove_vertex(const T& vertex) override {
+        const size_t id = checked_id(vertex, "vertex not found");
+        _vertices2ids.erase(vertex);
+        _vertices.erase(id);
+
+        // clear the row and the column of the removed vertex
+        for (size_t i = 0; i < _idBound; i++) {
+            erase(id, i);
+            erase(i, id);
+        }
+        _freeIds.push_back(id);
+
+        if (this->removal_mode() == RemovalMode::Renumber) {
+            compact();
+        }
+    }
+
+    std::vector<VertexId> compact() override {
+        std::vector<VertexId> newIds(_idBound, NO_VERTEX);
+        std::vector<size_t> oldIds;
+        oldIds.reserve(size());
+        for (size_t id = 0; id < _idBound; ++id) {
+            if (_vertices.contains(id)) {
+                newIds[id] = oldIds.size();
+                oldIds.push_back(id);
+            }
+        }
+
+        // update adjacency matrix (keep only the rows and columns of existing vertices), the weights in place:
+        // entries only move to lower positions, so they are never overwritten before being read
+        std::vector<std::uint64_t> newPresent(_present.size(), 0);
+        for (size_t i = 0; i < oldIds.size(); i++) {
+            for (size_t j = 0; j < oldIds.size(); j++) {
+                if (test(oldIds[i], oldIds[j])) {
+                    newPresent[i * row_words() + j / WORD_BITS] |= std::uint64_t{1} << (j % WORD_BITS);
+                }
+            }
+        }
+        _present = std::move(newPresent);
+        if constexpr (!std::is_empty_v<W>) {
+            for (size_t i = 0; i < oldIds.size(); i++) {
+                for (size_t j = 0; j < oldIds.size(); j++) {
+                    _weights[i * _capacity + j] = _weights[oldIds[i] * _capacity + oldIds[j]];
+                }
+                std::fill(_weights.begin() + static_cast<std::ptrdiff_t>(i * _capacity + oldIds.size()),
+                          _weights.begin() + static_cast<std::ptrdiff_t>(i * _capacity + _idBound), W{});
+            }
+            std::fill(_weights.begin() + static_cast<std::ptrdiff_t>(oldIds.size() * _capacity),
+                      _weights.begin() + static_cast<std::ptrdiff_t>(_idBound * _capacity), W{});
+        }
+
+        std::unordered_map<size_t, Vertex> newVertices;
+        newVertices.reserve(oldIds.size());
+        for (std::pair<const size_t, Vertex>& vertex : _vertices) {
+            newVertices.emplace(newIds[vertex.first], std::move(vertex.second));
+        }
+        _vertices = std::move(newVertices);
+        for (std::pair<const T, size_t>& vertex2id : _vertices2ids) {
+            vertex2id.second = newIds[vertex2id.second];
+        }
+
+        _idBound = oldIds.size();
+        _freeIds.clear();
+        return newIds;
+    }
+
+    [[nodiscard]] W get_edge_weight(const T& vertex1, const T& vertex2) const override {
+        return get_edge_weight_by_id(checked_id(vertex1, "vertex1 not found"), checked_id(vertex2, "vertex2 not found"));
+    }
+
+    [[nodiscard]] std::optional<W> try_get_edge_weight(const T& vertex1, const T& vertex2) const override {
+        const auto vertexIt1 = _vertices2ids.find(vertex1);
+        const auto vertexIt2 = _vertices2ids.find(vertex2);
+        if (vertexIt1 == _vertices2ids.end() || vertexIt2 == _vertices2ids.end() || !test(vertexIt1->second, vertexIt2->second)) {
+            return std::nullopt;
+        }
+        return weight_at(vertexIt1->second, vertexIt2->second);
+    }
+
+    void set_edge_weight(const T& vertex1, const T& vertex2, const W weight) override {
+        set_edge_weight_by_id(checked_id(vertex1, "vertex1 not found"), checked_id(vertex2, "vertex2 not found"), weight);
+    }
+
+    [[nodiscard]] bool get_vertex_visited(const T& vertex) const override {
+        return _vertices.find(checked_id(vertex, "vertex not found"))->second._visited;
+    }
+
+    void set_vertex_visited(const T& vertex, bool visited) override {
+        _vertices.find(checked_id(vertex, "vertex not found"))->second._visited = visited;
+    }
+
+    void reset_vertices_visited() override {
+        for (std::pair<const size_t, Vertex>& vertex : _vertices) {
+            vertex.second._visited = false;
+        }
+    }
+
+    [[nodiscard]] bool adjacent_by_id(const VertexId id1, const VertexId id2) const override {
+        check_id(id1, "vertex1 not found");
+        check_id(id2, "vertex2 not found");
+        return test(id1, id2);
+    }
+
+    [[nodiscard]] std::vector<VertexId> neighbors_by_id(const VertexId id) const override {
+        std::vector<VertexId> neighborsVec;
+        for_each_neighbor(id, [&neighborsVec](const VertexId neighbor, W) {
+            neighborsVec.push_back(neighbor);
+        });
+        return neighborsVec;
+    }
+
+    [[nodiscard]] W get_edge_weight_by_id(const VertexId id1, const VertexId id2) const override {
+        check_id(id1, "vertex1 not found");
+        check_id(id2, "vertex2 not found");
+        return weight_at(id1, id2);
+    }
+
+    void set_edge_weight_by_id(const VertexId id1, const VertexId id2, const W weight) override {
+        check_id(id1, "vertex1 not found");
+        check_id(id2, "vertex2 not found");
+        store(id1, id2, weight);
+    }
+protected:
+    void remove_existing_edge(const VertexId id1, const VertexId id2) override {
+        erase(id1, id2);
+    }
+};
+
+/**
+ * Unweighted adjacency matrix storing one bit per pair of vertices, with set operations on neighborhoods.
+ *
+ * It is a GraphAdjacencyMatrix<T, Unweighted>, whose rows are arrays of 64-bit words of presence bits
+ * and which stores no weights, so the matrix takes 64 times less memory than one with double weights.
+ * On top of it, set operations on neighborhoods (common neighbors, Jaccard similarity, triangles)
+ * are loops of AND/OR and popcount over the 64-bit words of contiguous rows, so they handle 64 vertices
+ * per step. On x86-64 the loops use the popcnt instruction when the processor has it, picked at run time.
+ */
+template <typename T>
+class GraphAdjacencyBitMatrix : public GraphAdjacencyMatrix<T, Unweighted> {
+private:
+    using Matrix = GraphAdjacencyMatrix<T, Unweighted>;
+    using Matrix::WORD_BITS;
+
+    // numbers of bits set in both and in any of two arrays of words (the union is only counted if asked for)
+    template <bool CountUnion>
+    [[nodiscard, gnu::always_inline]] static std::pair<size_t, size_t> count_bits(const std::uint64_t* words1, const std::uint64_t* words2,
+                                                                                  const size_t count) {
+        size_t intersection = 0;
+        size_t unionCount = 0;
+        for (size_t word = 0; word < count; ++word) {
+            intersection += static_cast<size_t>(std::popcount(words1[word] & words2[word]));
+            if constexpr (CountUnion) {
+                unionCount += static_cast<size_t>(std::popcount(words1[word] | words2[word]));
+            }
+        }
+        return {intersection, unionCount};
+    }
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    // the same loops compiled for the popcnt instruction, which x86-64 doesn't include by default
+    // (std::popcount is otherwise a sequence of shifts and masks)
+    template <bool CountUnion>
+    [[nodiscard, gnu::target("popcnt")]] static std::pair<size_t, size_t> count_bits_popcnt(const std::uint64_t* words1, const std::uint64_t* words2,
+                                                                                              const size_t count) {
+        return count_bits<CountUnion>(words1, words2, count);
+    }
+#endif
+
+    // count_bits() with the popcnt instruction if the processor has it
+    template <bool CountUnion>
+    [[nodiscard]] static std::pair<size_t, size_t> dispatch_count_bits(const std::uint64_t* words1, const std::uint64_t* words2, const size_t count) {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        static const bool hasPopcnt = __builtin_cpu_supports("popcnt") != 0;
+        if (hasPopcnt) {
+            return count_bits_popcnt<CountUnion>(words1, words2, count);
+        }
+#endif
+        return count_bits<CountUnion>(words1, words2, count);
+    }
+
+    // number of bits set in both rows, from the given word on
+    [[nodiscard]] size_t intersection_count(const VertexId id1, const VertexId id2, const size_t firstWord) const {
+        const std::span<const std::uint64_t> row1 = std::span(this->presence_row(id1), this->used_words()).subspan(firstWord);
+        const std::span<const std::uint64_t> row2 = std::span(this->presence_row(id2), this->used_words()).subspan(firstWord);
+        return dispatch_count_bits<false>(row1.data(), row2.data(), row1.size()).first;
+    }
+public:
+    /**
+     * Get the number of outgoing edges of a vertex.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return The number of outgoing edges of the vertex.
+     */
+    [[nodiscard]] size_t degree(const VertexId id) const {
+        this->check_id(id, "vertex not found");
+        return intersection_count(id, id, 0);
+    }
+
+    /**
+     * Count the vertices both vertices have an edge to.
+     * @throws VertexNotFoundException If there is no vertex with any of the given ids.
+     * @param id1 The id of the first vertex.
+     * @param id2 The id of the second vertex.
+     * @return The number of common neighbors.
+     */
+    [[nodiscard]] size_t common_neighbor_count(const VertexId id1, const VertexId id2) const {
+        this->check_id(id1, "vertex1 not found");
+        this->check_id(id2, "vertex2 not found");
+        return intersection_count(id1, id2, 0);
+    }
+
+    /**
+     * Get the Jaccard similarity of the neighborhoods of two vertices.
+     * @throws VertexNotFoundException If there is no vertex with any of the given ids.
+     * @param id1 The id of the first vertex.
+     * @param id2 The id of the second vertex.
+     * @return The number of common neighbors divided by the number of vertices adjacent
+     *         to any of the two vertices (0 if neither has neighbors).
+     */
+    [[nodiscard]] double jaccard(const VertexId id1, const VertexId id2) const {
+        this->check_id(id1, "vertex1 not found");
+        this->check_id(id2, "vertex2 not found");
+        const auto [intersection, unionCount] = dispatch_count_bits<true>(this->presence_row(id1), this->presence_row(id2), this->used_words());
+        return unionCount == 0 ? 0.0 : static_cast<double>(intersection) / static_cast<double>(unionCount);
+    }
+
+    /**
+     * Count the triangles of the graph.
+     *
+     * Counts the triples of ids u < v < w with edges from u to v, from u to w and from v to w,
+     * so for an undirected graph (every edge stored in both directions) every triangle is counted once.
+     * Takes O(E * V / 64) word operations.
+     * @return The number of triangles.
+     */
+    [[nodiscard]] size_t triangle_count() const {
+        size_t count = 0;
+        for (VertexId u = 0; u < this->id_bound(); ++u) {
+            const std::uint64_t* bits = this->presence_row(u);
+            for (size_t word = u / WORD_BITS; word < this->used_words(); ++word) {
+                // only the neighbors v > u
+                std::uint64_t remaining = bits[word];
+                if (word == u / WORD_BITS) {
+                    remaining &= ~std::uint64_t{0} << (u % WORD_BITS) << 1U;
+                }
+                for (; remaining != 0; remaining &= remaining - 1) {
+                    const VertexId v = word * WORD_BITS + static_cast<size_t>(std::countr_zero(remaining));
+                    // common neighbors w > v: mask the first word, then count the rest of the rows
+                    const size_t firstWord = v / WORD_BITS;
+                    const std::uint64_t mask = ~std::uint64_t{0} << (v % WORD_BITS) << 1U;
+                    count += static_cast<size_t>(std::popcount(bits[firstWord] & this->presence_row(v)[firstWord] & mask));
+                    count += intersection_count(u, v, firstWord + 1);
+                }
+            }
+        }
+        return count;
+    }
+};
+
+/**
+ * How the edges of an incidence matrix are stored.
+ */
+enum class IncidenceStorage : std::uint8_t {
+    // a full matrix with one column per edge (O(V * E) memory and O(V * E) per edge insertion or removal)
+    Dense,
+    // only the endpoints and the weight of each edge, plus the incident edges of each vertex
+    // (O(V + E) memory, amortized O(1) edge insertion and O(degree) edge lookup and removal)
+    Sparse
+};
+
+template <typename T, typename W = double>
+class GraphIncidenceMatrix : public Graph<T, W> {
+private:
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    struct Vertex {
+        T _value;
+        bool _visited = false;
+        Vertex() : _value(T{}) {}
+        explicit Vertex(const T& value) : _value(value) {}
+    };
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+
+    std::unordered_map<T, size_t> _vertices2ids;
+    std::unordered_map<size_t, Vertex> _vertices;
+    size_t _edgeCount = 0;
+
+    // incidence of a vertex on an edge: the edge leaves it, enters it, or both (a loop)
+    static constexpr std::uint8_t OUTGOING = 1;
+    static constexpr std::uint8_t INCOMING = 2;
+
+    // dense storage: the incidence of every vertex on every edge (one byte per entry, the weights are kept apart)
+    std::unique_ptr<std::uint8_t[]> _inc_matrix = nullptr;
+
+    // number of entries per edge in the incidence matrix
+    size_t _idBound = 0;
+
+    IncidenceStorage _storage = IncidenceStorage::Dense;
+
+    // sparse storage: the columns of the incidence matrix, one entry per edge
+    std::vector<VertexId> _edgeSources;
+    std::vector<VertexId> _edgeTargets;
+
+    // the weight of every edge, in the order of the columns (with both storages)
+    std::vector<W> _edgeWeights;
+
+    // sparse storage: indices of the outgoing and incoming edges of each id
+    std::vector<std::vector<size_t>> _outEdges;
+    std::vector<std::vector<size_t>> _inEdges;
+
+    // ids of removed vertices, ready to be reused by add_vertex
+    std::vector<VertexId> _freeIds;
+
+    [[nodiscard]] size_t checked_id(const T& vertex, const char* message) const {
+        const auto vertexIt = _vertices2ids.find(vertex);
+        if (vertexIt == _vertices2ids.end()) {
+            throw VertexNotFoundException(message);
+        }
+        return vertexIt->second;
+    }
+
+    void check_id(const VertexId id, const char* message) const {
+        if (!_vertices.contains(id)) {
+            throw VertexNotFoundException(message);
+        }
+    }
+
+    static constexpr size_t NO_EDGE = std::numeric_limits<size_t>::max();
+
+    // index of the column of the edge from id1 to id2 (NO_EDGE if there is no such edge)
+    [[nodiscard]] size_t find_edge(const size_t id1, const size_t id2) const {
+        if (_storage == IncidenceStorage::Sparse) {
+            for (const size_t edgeId : _outEdges[id1]) {
+                if (_edgeTargets[edgeId] == id2) {
+                    return edgeId;
+                }
+            }
+            return NO_EDGE;
+        }
+        for (size_t j = 0; j < edge_count(); j++) {
+            if ((_inc_matrix[j * _idBound + id1] & OUTGOING) != 0 && (_inc_matrix[j * _idBound + id2] & INCOMING) != 0) {
+                return j;
+            }
+        }
+        return NO_EDGE;
+    }
+
+    // dense storage: the target of the edge of a column
+    [[nodiscard]] VertexId column_target(const size_t edgeId) const {
+        const std::uint8_t* column = _inc_matrix.get() + edgeId * _idBound;
+        VertexId target = 0;
+        while ((column[target] & INCOMING) == 0) {
+            ++target;
+        }
+        return target;
+    }
+
+    // dense storage: replace the matrix by one with the given columns of the current matrix, plus empty columns
+    void keep_columns(const std::vector<size_t>& edgeIds, const size_t newEdgeCount) {
+        auto newIncMatrix = std::make_unique<std::uint8_t[]>(_idBound * (edgeIds.size() + newEdgeCount));
+        std::vector<W> newEdgeWeights;
+        newEdgeWeights.reserve(edgeIds.size() + newEdgeCount);
+        for (size_t j = 0; j < edgeIds.size(); j++) {
+            std::copy(_inc_matrix.get() + edgeIds[j] * _idBound, _inc_matrix.get() + (edgeIds[j] + 1) * _idBound, newIncMatrix.get() + j * _idBound);
+            newEdgeWeights.push_back(_edgeWeights[edgeIds[j]]);
+        }
+        _inc_matrix = std::move(newIncMatrix);
+        _edgeWeights = std::move(newEdgeWeights);
+        _edgeCount = edgeIds.size();
+    }
+
+    // dense storage: fill the next column (keep_columns() must have made room for it)
+    void push_dense_edge(const size_t id1, const size_t id2, const W weight) {
+        _inc_matrix[_edgeCount * _idBound + id1] |= OUTGOING;
+        _inc_matrix[_edgeCount * _idBound + id2] |= INCOMING;
+        _edgeWeights.push_back(weight);
+        _edgeCount++;
+    }
+
+    // dense storage: the ids of all edges but the ones with the given endpoint (or all edges if it is NO_VERTEX)
+    [[nodiscard]] std::vector<size_t> edges_not_incident_to(const VertexId id) const {
+        std::vector<size_t> edgeIds;
+        for (size_t j = 0; j < edge_count(); j++) {
+            if (id == NO_VERTEX || _inc_matrix[j * _idBound + id] == 0) {
+                edgeIds.push_back(j);
+            }
+        }
+        return edgeIds;
+    }
+
+    // number of entries of the dense incidence matrix
+    [[nodiscard]] size_t matrix_size() const {
+        return _storage == IncidenceStorage::Dense ? _idBound * _edgeCount : 0;
+    }
+
+
+    // replace an edge index in an incidence list
+    static void replace_edge(std::vector<size_t>& edges, const size_t oldEdgeId, const size_t newEdgeId) {
+        *std::ranges::find(edges, oldEdgeId) = newEdgeId;
+    }
+
+    // sparse storage: append a new edge
+    void push_sparse_edge(const size_t id1, const size_t id2, const W weight) {
+        _outEdges[id1].push_back(_edgeWeights.size());
+        _inEdges[id2].push_back(_edgeWeights.size());
+        _edgeSources.push_back(id1);
+        _edgeTargets.push_back(id2);
+        _edgeWeights.push_back(weight);
+        _edgeCount++;
+    }
+
+    // sparse storage: remove an edge by moving the last edge into its place
+    void remove_sparse_edge(const size_t edgeId) {
+        std::vector<size_t>& sourceEdges = _outEdges[_edgeSources[edgeId]];
+        std::vector<size_t>& targetEdges = _inEdges[_edgeTargets[edgeId]];
+        sourceEdges.erase(std::ranges::find(sourceEdges, edgeId));
+        targetEdges.erase(std::ranges::find(targetEdges, edgeId));
+
+        const size_t lastEdgeId = _edgeWeights.size() - 1;
+        if (edgeId != lastEdgeId) {
+            replace_edge(_outEdges[_edgeSources[lastEdgeId]], lastEdgeId, edgeId);
+            replace_edge(_inEdges[_edgeTargets[lastEdgeId]], lastEdgeId, edgeId);
+            _edgeSources[edgeId] = _edgeSources[lastEdgeId];
+            _edgeTargets[edgeId] = _edgeTargets[lastEdgeId];
+            _edgeWeights[edgeId] = _edgeWeights[lastEdgeId];
+        }
+        _edgeSources.pop_back();
+        _edgeTargets.pop_back();
+        _edgeWeights.pop_back();
+        _edgeCount--;
+    }
+
+    // walks the outgoing edges of a vertex for neighbor_range()
+    // (positions in the incidence list with the sparse storage, columns of the matrix with the dense one)
+    class NeighborCursor {
+    private:
+        const GraphIncidenceMatrix* _graph = nullptr;
+        VertexId _id = 0;
+        size_t _position = 0;
+
+        [[nodiscard]] size_t end_position() const {
+            return _graph->_storage == IncidenceStorage::Sparse ? _graph->_outEdges[_id].size() : _graph->edge_count();
+        }
+
+        void skip_incoming() {
+            if (_graph->_storage == IncidenceStorage::Dense) {
+                while (_position < _graph->edge_count() && (_graph->_inc_matrix[_position * _graph->_idBound + _id] & OUTGOING) == 0) {
+                    ++_position;
+                }
+            }
+        }
+    public:
+        NeighborCursor() = default;
+
+        NeighborCursor(const GraphIncidenceMatrix* graph, const VertexId id) : _graph(graph), _id(id) {
+            skip_incoming();
+        }
+
+        [[nodiscard]] bool done() const {
+            return _position == end_position();
+        }
+
+        void advance() {
+            ++_position;
+            skip_incoming();
+        }
+
+        [[nodiscard]] Neighbor<T, W> current() const {
+            if (_graph->_storage == IncidenceStorage::Sparse) {
+                const size_t edgeId = _graph->_outEdges[_id][_position];
+                const VertexId target = _graph->_edgeTargets[edgeId];
+                return {target, _graph->_vertices.find(target)->second._value, _graph->_edgeWeights[edgeId]};
+            }
+            const VertexId target = _graph->column_target(_position);
+            return {target, _graph->_vertices.find(target)->second._value, _graph->_edgeWeights[_position]};
+        }
+
+        bool operator==(const NeighborCursor& other) const = default;
+    };
+public:
+    using Graph<T, W>::adjacent;
+    using Graph<T, W>::neighbors;
+    using Graph<T, W>::get_edge_weight;
+    using Graph<T, W>::set_edge_weight;
+    using Graph<T, W>::for_each_neighbor;
+
+    // constructor
+    GraphIncidenceMatrix() = default;
+
+    /**
+     * Create an empty graph with the given edge storage.
+     * @param storage How the incidence matrix is stored.
+     */
+    explicit GraphIncidenceMatrix(const IncidenceStorage storage) : _storage(storage) {}
+
+    // copy constructor
+    GraphIncidenceMatrix(const GraphIncidenceMatrix& other) : Graph<T, W>(other), _vertices2ids(other._vertices2ids), _vertices(other._vertices), _edgeCount(other._edgeCount), _inc_matrix(std::make_unique<std::uint8_t[]>(other.matrix_size())), _idBound(other._idBound), _storage(other._storage), _edgeSources(other._edgeSources), _edgeTargets(other._edgeTargets), _edgeWeights(other._edgeWeights), _outEdges(other._outEdges), _inEdges(other._inEdges), _freeIds(other._freeIds) {
+        std::copy(other._inc_matrix.get(), other._inc_matrix.get() + other.matrix_size(), _inc_matrix.get());
+    }
+
+    // move constructor
+    // NOLINTNEXTLINE(bugprone-exception-escape)
+    GraphIncidenceMatrix(GraphIncidenceMatrix&& other) noexcept : Graph<T, W>(other), _vertices2ids(std::move(other._vertices2ids)), _vertices(std::move(other._vertices)), _edgeCount(other._edgeCount), _inc_matrix(std::move(other._inc_matrix)), _idBound(other._idBound), _storage(other._storage), _edgeSources(std::move(other._edgeSources)), _edgeTargets(std::move(other._edgeTargets)), _edgeWeights(std::move(other._edgeWeights)), _outEdges(std::move(other._outEdges)), _inEdges(std::move(other._inEdges)), _freeIds(std::move(other._freeIds)) {}
+
+    // copy assignment
+    GraphIncidenceMatrix& operator=(const GraphIncidenceMatrix& other) {
+        if (this == &other) {
+            return *this;
+        }
+        Graph<T, W>::operator=(other);
+        _vertices2ids = other._vertices2ids;
+        _vertices = other._vertices;
+        _edgeCount = other._edgeCount;
+        _inc_matrix = std::make_unique<std::uint8_t[]>(other.matrix_size());
+        std::copy(other._inc_matrix.get(), other._inc_matrix.get() + other.matrix_size(), _inc_matrix.get());
+        _idBound = other._idBound;
+        _storage = other._storage;
+        _edgeSources = other._edgeSources;
+        _edgeTargets = other._edgeTargets;
+        _edgeWeights = other._edgeWeights;
+        _outEdges = other._outEdges;
+        _inEdges = other._inEdges;
+        _freeIds = other._freeIds;
+        return *this;
+    }
+
+    // move assignment
+    GraphIncidenceMatrix& operator=(GraphIncidenceMatrix&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        Graph<T, W>::operator=(other);
+        _vertices2ids = std::move(other._vertices2ids);
+        _vertices = std::move(other._vertices);
+        _edgeCount = other._edgeCount;
+        _inc_matrix = std::move(other._inc_matrix);
+        _idBound = other._idBound;
+        _storage = other._storage;
+        _edgeSources = std::move(other._edgeSources);
+        _edgeTargets = std::move(other._edgeTargets);
+        _edgeWeights = std::move(other._edgeWeights);
+        _outEdges = std::move(other._outEdges);
+        _inEdges = std::move(other._inEdges);
+        _freeIds = std::move(other._freeIds);
+        return *this;
+    }
+
+    // destructor
+    ~GraphIncidenceMatrix() override = default;
+
+    /**
+     * Get the number of edges in the graph.
+     * @return The number of edges in the graph.
+     */
+    [[nodiscard]] size_t edge_count() const {
+        return _edgeCount;
+    }
+
+    /**
+     * Get how the incidence matrix is stored.
+     * @return The edge storage of the graph.
+     */
+    [[nodiscard]] IncidenceStorage storage() const {
+        return _storage;
+    }
+
+    [[nodiscard]] size_t size() const override {
+        return _vertices.size();
+    }
+
+    [[nodiscard]] size_t id_bound() const override {
+        return _idBound;
+    }
+
+    [[nodiscard]] bool contains_id(const VertexId id) const override {
+        return _vertices.contains(id);
+    }
+
+    [[nodiscard]] VertexId id_of(const T& vertex) const override {
+        return checked_id(vertex, "vertex not found");
+    }
+
+    [[nodiscard]] std::optional<VertexId> find_vertex(const T& vertex) const override {
+        const auto vertexIt = _vertices2ids.find(vertex);
+        if (vertexIt == _vertices2ids.end()) {
+            return std::nullopt;
+        }
+        return vertexIt->second;
+    }
+
+    [[nodiscard]] const T& value_of(const VertexId id) const override {
+        check_id(id, "vertex not found");
+        return _vertices.find(id)->second._value;
+    }
+
+    [[nodiscard]] bool adjacent(const T& vertex1, const T& vertex2) const override {
+        return adjacent_by_id(checked_id(vertex1, "vertex1 not found"), checked_id(vertex2, "vertex2 not found"));
+    }
+
+    [[nodiscard]] std::vector<T> neighbors(const T& vertex) const override {
+        const size_t id = checked_id(vertex, "vertex not found");
+        std::vector<T> neighboursVec;
+        if (_storage == IncidenceStorage::Sparse) {
+            neighboursVec.reserve(_outEdges[id].size());
+            for (const size_t edgeId : _outEdges[id]) {
+                neighboursVec.push_back(_vertices.find(_edgeTargets[edgeId])->second._value);
+            }
+            return neighboursVec;
+        }
+        for (size_t j = 0; j < edge_count(); j++) {
+            if ((_inc_matrix[j * _idBound + id] & OUTGOING) != 0) {
+                neighboursVec.push_back(_vertices.find(column_target(j))->second._value);
+            }
+        }
+        return neighboursVec;
+    }
+
+    void for_each_neighbor(const VertexId id, const NeighborVisitor<W> visitor) const override {
+        check_id(id, "vertex not found");
+        if (_storage == IncidenceStorage::Sparse) {
+            for (const size_t edgeId : _outEdges[id]) {
+                visitor(_edgeTargets[edgeId], _edgeWeights[edgeId]);
+            }
+            return;
+        }
+        for (size_t j = 0; j < edge_count(); j++) {
+            if ((_inc_matrix[j * _idBound + id] & OUTGOING) != 0) {
+                visitor(column_target(j), _edgeWeights[j]);
+            }
+        }
+    }
+
+    /**
+     * Get a lazy view over the outgoing edges of a vertex.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return A view yielding the id and the value of each neighbor and the weight of the edge leading to it.
+     */
+    [[nodiscard]] NeighborRange<T, NeighborCursor, W> neighbor_range(const VertexId id) const {
+        check_id(id, "vertex not found");
+        return NeighborRange<T, NeighborCursor, W>{NeighborCursor{this, id}};
+    }
+
+    VertexId add_vertex(const T& vertex) override {
+        if (_vertices2ids.contains(vertex)) {
+            throw VertexAlreadyExistsException("vertex already exists");
+        }
+        if (!_freeIds.empty()) {
+            // a freed id has no incident edges, so its entries are already cleared
+            const size_t newId = _freeIds.back();
+            _freeIds.pop_back();
+            _vertices2ids[vertex] = newId;
+            _vertices[newId] = Vertex{vertex};
+            return newId;
+        }
+
+        const size_t oldSize = _idBound;
+        _idBound++;
+        _vertices2ids[vertex] = oldSize;
+        _vertices[oldSize] = Vertex{vertex};
+        if (_storage == IncidenceStorage::Sparse) {
+            _outEdges.emplace_back();
+            _inEdges.emplace_back();
+            return oldSize;
+        }
+        auto newIncMatrix = std::make_unique<std::uint8_t[]>(_idBound * edge_count());
+
+        for (size_t j = 0; j < edge_count(); j++) {
+            std::move(_inc_matrix.get() + j * oldSize, _inc_matrix.get() + (j + 1) * oldSize, newIncMatrix.get() + j * _idBound);
+            newIncMatrix[(j + 1) * _idBound - 1] = 0;
+        }
+
+        _inc_matrix = std::move(newIncMatrix);
+        return oldSize;
+    }
+
+    void remove_vertex(const T& vertex) override {
+        const size_t id = checked_id(vertex, "vertex not found");
+        _vertices2ids.erase(vertex);
+        _vertices.erase(id);
+
+        if (_storage == IncidenceStorage::Sparse) {
+            while (!_outEdges[id].empty()) {
+                remove_sparse_edge(_outEdges[id].back());
+            }
+            while (!_inEdges[id].empty()) {
+                remove_sparse_edge(_inEdges[id].back());
+            }
+            _freeIds.push_back(id);
+            if (this->removal_mode() == RemovalMode::Renumber) {
+                compact();
+            }
+            return;
+        }
+
+        // update incidence matrix (remove the edges incident to the removed vertex)
+        keep_columns(edges_not_incident_to(id), 0);
+        _freeIds.push_back(id);
+
+        if (this->removal_mode() == RemovalMode::Renumber) {
+            compact();
+        }
+    }
+
+    std::vector<VertexId> compact() override {
+        std::vector<VertexId> newIds(_idBound, NO_VERTEX);
+        std::vector<size_t> oldIds;
+        oldIds.reserve(size());
+        for (size_t id = 0; id < _idBound; ++id) {
+            if (_vertices.contains(id)) {
+                newIds[id] = oldIds.size();
+                oldIds.push_back(id);
+            }
+        }
+
+        if (_storage == IncidenceStorage::Sparse) {
+            // renumber the endpoints of the edges and move the incidence lists down
+            for (size_t j = 0; j < edge_count(); j++) {
+                _edgeSources[j] = newIds[_edgeSources[j]];
+                _edgeTargets[j] = newIds[_edgeTargets[j]];
+            }
+            for (size_t i = 0; i < oldIds.size(); i++) {
+                if (oldIds[i] != i) {
+                    _outEdges[i] = std::move(_outEdges[oldIds[i]]);
+                    _inEdges[i] = std::move(_inEdges[oldIds[i]]);
+                }
+            }
+            _outEdges.resize(oldIds.size());
+            _inEdges.resize(oldIds.size());
+        } else {
+            // update incidence matrix (keep only the entries of existing vertices)
+            auto newIncMatrix = std::make_unique<std::uint8_t[]>(oldIds.size() * edge_count());
+            for (size_t j = 0; j < edge_count(); j++) {
+                for (size_t i = 0; i < oldIds.size(); i++) {
+                    newIncMatrix[j * oldIds.size() + i] = _inc_matrix[j * _idBound + oldIds[i]];
+                }
+            }
+            _inc_matrix = std::move(newIncMatrix);
+        }
+
+        std::unordered_map<size_t, Vertex> newVertices;
+        newVertices.reserve(oldIds.size());
+        for (std::pair<const size_t, Vertex>& vertex : _vertices) {
+            newVertices.emplace(newIds[vertex.first], std::move(vertex.second));
+        }
+        _vertices = std::move(newVertices);
+        for (std::pair<const T, size_t>& vertex2id : _vertices2ids) {
+            vertex2id.second = newIds[vertex2id.second];
+        }
+
+        _idBound = oldIds.size();
+        _freeIds.clear();
+        return newIds;
+    }
+
+    [[nodiscard]] bool get_vertex_visited(const T& vertex) const override {
+        return _vertices.find(checked_id(vertex, "vertex not found"))->second._visited;
+    }
+
+    void set_vertex_visited(const T& vertex, bool visited) override {
+        _vertices.find(checked_id(vertex, "vertex not found"))->second._visited = visited;
+    }
+
+    void reset_vertices_visited() override {
+        for (std::pair<const size_t, Vertex>& vertex : _vertices) {
+            vertex.second._visited = false;
+        }
+    }
+
+    [[nodiscard]] W get_edge_weight(const T& vertex1, const T& vertex2) const override {
+        return get_edge_weight_by_id(checked_id(vertex1, "vertex1 not found"), checked_id(vertex2, "vertex2 not found"));
+    }
+
+    [[nodiscard]] std::optional<W> try_get_edge_weight(const T& vertex1, const T& vertex2) const override {
+        const auto vertexIt1 = _vertices2ids.find(vertex1);
+        const auto vertexIt2 = _vertices2ids.find(vertex2);
+        if (vertexIt1 == _vertices2ids.end() || vertexIt2 == _vertices2ids.end()) {
+            return std::nullopt;
+        }
+        const size_t edgeId = find_edge(vertexIt1->second, vertexIt2->second);
+        if (edgeId == NO_EDGE) {
+            return std::nullopt;
+        }
+        return _edgeWeights[edgeId];
+    }
+
+    void set_edge_weight(const T& vertex1, const T& vertex2, const W weight) override {
+        set_edge_weight_by_id(checked_id(vertex1, "vertex1 not found"), checked_id(vertex2, "vertex2 not found"), weight);
+    }
+
+    [[nodiscard]] bool adjacent_by_id(const VertexId id1, const VertexId id2) const override {
+        check_id(id1, "vertex1 not found");
+        check_id(id2, "vertex2 not found");
+        return find_edge(id1, id2) != NO_EDGE;
+    }
+
+    [[nodiscard]] std::vector<VertexId> neighbors_by_id(const VertexId id) const override {
+        std::vector<VertexId> neighborsVec;
+        for_each_neighbor(id, [&neighborsVec](const VertexId neighbor, W) {
+            neighborsVec.push_back(neighbor);
+        });
+        return neighborsVec;
+    }
+
+    [[nodiscard]] W get_edge_weight_by_id(const VertexId id1, const VertexId id2) const override {
+        check_id(id1, "vertex1 not found");
+        check_id(id2, "vertex2 not found");
+        const size_t edgeId = find_edge(id1, id2);
+        return edgeId == NO_EDGE ? W{} : _edgeWeights[edgeId];
+    }
+
+    void set_edge_weight_by_id(const VertexId id1, const VertexId id2, const W weight) override {
+        check_id(id1, "vertex1 not found");
+        check_id(id2, "vertex2 not found");
+        const size_t edgeId = find_edge(id1, id2);
+        if (edgeId != NO_EDGE) {
+            // if the edge is present, only its weight is updated
+            _edgeWeights[edgeId] = weight;
+        } else if (_storage == IncidenceStorage::Sparse) {
+            push_sparse_edge(id1, id2, weight);
+        } else {
+            // if the edge is not present, a column must be added
+            keep_columns(edges_not_incident_to(NO_VERTEX), 1);
+            push_dense_edge(id1, id2, weight);
+        }
+    }
+protected:
+    void remove_existing_edge(const VertexId id1, const VertexId id2) override {
+        const size_t edgeId = find_edge(id1, id2);
+        if (_storage == IncidenceStorage::Sparse) {
+            remove_sparse_edge(edgeId);
+            return;
+        }
+        std::vector<size_t> edgeIds = edges_not_incident_to(NO_VERTEX);
+        edgeIds.erase(edgeIds.begin() + static_cast<std::ptrdiff_t>(edgeId));
+        keep_columns(edgeIds, 0);
+    }
+
+    void insert_edges(const std::span<const Edge<VertexId, W>> edges) override {
+        // existing edges are updated in place, and the new ones are appended together,
+        // so the dense matrix is reallocated once instead of once per edge
+        std::vector<Edge<VertexId, W>> newEdges;
+        for (const Edge<VertexId, W>& edge : edges) {
+            if (find_edge(edge.source, edge.target) != NO_EDGE) {
+                set_edge_weight_by_id(edge.source, edge.target, edge.weight);
+            } else {
+                newEdges.push_back(edge);
+            }
+        }
+
+        if (_storage == IncidenceStorage::Sparse) {
+            _edgeSources.reserve(_edgeSources.size() + newEdges.size());
+            _edgeTargets.reserve(_edgeTargets.size() + newEdges.size());
+            _edgeWeights.reserve(_edgeWeights.size() + newEdges.size());
+            for (const Edge<VertexId, W>& edge : newEdges) {
+                push_sparse_edge(edge.source, edge.target, edge.weight);
+            }
+            return;
+        }
+
+        keep_columns(edges_not_incident_to(NO_VERTEX), newEdges.size());
+        for (const Edge<VertexId, W>& edge : newEdges) {
+            push_dense_edge(edge.source, edge.target, edge.weight);
+        }
+    }
+
+};
+
+
+/**
+ * Immutable snapshot of a graph in the compressed sparse row (CSR) format.
+ *
+ * Edges are stored in three contiguous arrays: the outgoing edges of vertex i occupy
+ * the range [offsets[i], offsets[i + 1]) of the target and weight arrays,
+ * sorted by the id of the target. Vertex ids are the same as in the graph the snapshot was created from.
+ * Traversals are linear scans over memory, which makes this the fastest representation
+ * for graphs that are built once and read many times.
+ */
+template <typename T, typename W>
+class GraphCSR {
+private:
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    struct VertexArrays {
+        std::vector<T> values;
+        std::vector<std::uint8_t> present;
+        std::unordered_map<T, VertexId> ids;
+        // mapped file holding the other arrays, for strings loaded from a file
+        std::shared_ptr<const void> file;
+    };
+
+    struct EdgeArrays {
+        std::vector<size_t> offsets;
+        std::vector<VertexId> targets;
+        std::vector<W> weights;
+    };
+
+    // start of a binary file, followed by the arrays (offsets, targets, weights, present, values, index),
+    // each starting at a multiple of 8 bytes; strings are stored as the offsets of each string in a table
+    // of characters, followed by the table
+    struct FileHeader {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        // to reject files written on a machine with another byte order or word size
+        std::uint32_t byteOrder;
+        std::uint32_t wordSize;
+        // 0 for strings
+        std::uint32_t valueSize;
+        std::uint32_t weightSize;
+        std::uint64_t idBound;
+        std::uint64_t vertexCount;
+        std::uint64_t edgeCount;
+        // number of slots of the hash table from values to ids (a power of 2)
+        std::uint64_t indexSize;
+        // size of the table of characters of the strings
+        std::uint64_t stringBytes;
+    };
+
+    // byte offsets of the arrays in a binary file
+    struct FileLayout {
+        size_t offsets;
+        size_t targets;
+        size_t weights;
+        size_t present;
+        size_t values;
+        size_t strings;
+        size_t index;
+        size_t size;
+    };
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+
+    static constexpr std::array<char, 8> FILE_MAGIC{'G', 'R', 'A', 'P', 'H', 'C', 'S', 'R'};
+    static constexpr std::uint32_t FILE_VERSION = 3;
+    static constexpr std::uint32_t FILE_BYTE_ORDER = 0x01020304;
+
+    // keep alive the memory the arrays point to: vectors owned by the snapshot, or a mapped file
+    std::shared_ptr<const void> _vertexMemory;
+    std::shared_ptr<const void> _edgeMemory;
+
+    std::span<const T> _values;
+    std::span<const std::uint8_t> _present;
+    std::span<const size_t> _offsets;
+    std::span<const VertexId> _targets;
+    std::span<const W> _weights;
+
+    // ids of the vertices: a hash map shared by copies of a snapshot (null for a mapped file),
+    // or the hash table of a mapped file
+    const std::unordered_map<T, VertexId>* _vertices2ids = nullptr;
+    std::span<const VertexId> _fileIndex;
+    size_t _size = 0;
+
+    void adopt(std::shared_ptr<const VertexArrays> vertices) {
+        _values = vertices->values;
+        _present = vertices->present;
+        _vertices2ids = &vertices->ids;
+        _vertexMemory = std::move(vertices);
+    }
+
+    void adopt(std::shared_ptr<const EdgeArrays> edges) {
+        _offsets = edges->offsets;
+        _targets = edges->targets;
+        _weights = edges->weights;
+        _edgeMemory = std::move(edges);
+    }
+
+    static constexpr bool STRING_VALUES = std::same_as<T, std::string> || std::same_as<T, std::string_view>;
+
+    // FNV-1a hash of the bytes of a value (of the characters of a string), which stays the same across processes (unlike std::hash)
+    [[nodiscard]] static std::uint64_t file_hash(const T& value) requires BinaryVertex<T> {
+        std::span<const std::byte> bytes;
+        if constexpr (STRING_VALUES) {
+            bytes = std::as_bytes(std::span(value.data(), value.size()));
+        } else {
+            bytes = std::as_bytes(std::span(&value, 1));
+        }
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (const std::byte byte : bytes) {
+            hash = (hash ^ std::to_integer<std::uint64_t>(byte)) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    [[nodiscard]] static FileLayout file_layout(const FileHeader& header) {
+        constexpr size_t alignment = std::max({alignof(T), alignof(W), size_t{8}});
+        const auto align = [](const size_t position) {
+            return (position + alignment - 1) / alignment * alignment;
+        };
+        FileLayout layout{};
+        layout.offsets = align(sizeof(FileHeader));
+        layout.targets = align(layout.offsets + (header.idBound + 1) * sizeof(size_t));
+        layout.weights = align(layout.targets + header.edgeCount * sizeof(VertexId));
+        layout.present = align(layout.weights + header.edgeCount * sizeof(W));
+        layout.values = align(layout.present + header.idBound);
+        if constexpr (STRING_VALUES) {
+            layout.strings = layout.values + (header.idBound + 1) * sizeof(std::uint64_t);
+            layout.index = align(layout.strings + header.stringBytes);
+        } else {
+            layout.strings = align(layout.values + header.idBound * sizeof(T));
+            layout.index = layout.strings;
+        }
+        layout.size = align(layout.index + header.indexSize * sizeof(VertexId));
+        return layout;
+    }
+
+    // view of an array of a mapped file
+    template <typename U>
+    [[nodiscard]] static std::span<const U> mapped_array(const std::byte* file, const size_t position, const size_t count) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return {reinterpret_cast<const U*>(file + position), count};
+    }
+
+    [[nodiscard]] std::optional<VertexId> lookup(const T& vertex) const {
+        if constexpr (BinaryVertex<T>) {
+            if (_vertices2ids == nullptr) {
+                const size_t mask = _fileIndex.size() - 1;
+                for (size_t slot = file_hash(vertex) & mask; _fileIndex[slot] != NO_VERTEX; slot = (slot + 1) & mask) {
+                    if (_values[_fileIndex[slot]] == vertex) {
+                        return _fileIndex[slot];
+                    }
+                }
+                return std::nullopt;
+            }
+        }
+        const auto vertexIt = _vertices2ids->find(vertex);
+        if (vertexIt == _vertices2ids->end()) {
+            return std::nullopt;
+        }
+        return vertexIt->second;
+    }
+
+    [[nodiscard]] VertexId checked_id(const T& vertex, const char* message) const {
+        const std::optional<VertexId> id = lookup(vertex);
+        if (!id) {
+            throw VertexNotFoundException(message);
+        }
+        return *id;
+    }
+
+    [[nodiscard]] const W* find_edge(const VertexId id1, const VertexId id2) const {
+        const auto first = _targets.begin() + static_cast<std::ptrdiff_t>(_offsets[id1]);
+        const auto last = _targets.begin() + static_cast<std::ptrdiff_t>(_offsets[id1 + 1]);
+        const auto edgeIt = std::lower_bound(first, last, id2);
+        if (edgeIt == last || *edgeIt != id2) {
+            return nullptr;
+        }
+        return &_weights[static_cast<size_t>(edgeIt - _targets.begin())];
+    }
+
+    // empty snapshot, filled by load_mmap()
+    GraphCSR() = default;
+
+    void check_ids(const VertexId id1, const VertexId id2) const {
+        if (!contains_id(id1)) {
+            throw VertexNotFoundException("vertex1 not found");
+        }
+        if (!contains_id(id2)) {
+            throw VertexNotFoundException("vertex2 not found");
+        }
+    }
+
+    // walks a slice of the edge arrays for neighbor_range()
+    class NeighborCursor {
+    private:
+        const GraphCSR* _graph = nullptr;
+        size_t _position = 0;
+        size_t _end = 0;
+    public:
+        NeighborCursor() = default;
+
+        NeighborCursor(const GraphCSR* graph, const VertexId id) : _graph(graph), _position(graph->_offsets[id]), _end(graph->_offsets[id + 1]) {}
+
+        [[nodiscard]] bool done() const {
+            return _position == _end;
+        }
+
+        void advance() {
+            ++_position;
+        }
+
+        [[nodiscard]] Neighbor<T, W> current() const {
+            const VertexId target = _graph->_targets[_position];
+            return {target, _graph->_values[target], _graph->_weights[_position]};
+        }
+
+        bool operator==(const NeighborCursor& other) const = default;
+    };
+public:
+    /**
+     * Create a snapshot of a graph in O(V + E).
+     * @param graph The graph to create the snapshot of.
+     */
+    explicit GraphCSR(const Graph<T, W>& graph) : _size(graph.size()) {
+        const size_t vertexCount = graph.id_bound();
+        auto vertices = std::make_shared<VertexArrays>();
+        std::vector<std::uint8_t>& present = vertices->present;
+        vertices->values.resize(vertexCount);
+        present.assign(vertexCount, 0);
+        vertices->ids.reserve(graph.size());
+        for (VertexId id = 0; id < vertexCount; ++id) {
+            if (graph.contains_id(id)) {
+                vertices->values[id] = graph.value_of(id);
+                present[id] = 1;
+                vertices->ids.emplace(vertices->values[id], id);
+            }
+        }
+
+        // count the outgoing and incoming edges of every vertex (ids without a vertex get empty rows)
+        auto edges = std::make_shared<EdgeArrays>();
+        std::vector<size_t>& offsets = edges->offsets;
+        offsets.assign(vertexCount + 1, 0);
+        std::vector<size_t> inOffsets(vertexCount + 1, 0);
+        for (VertexId id = 0; id < vertexCount; ++id) {
+            if (present[id] == 0) {
+                continue;
+            }
+            graph.for_each_neighbor(id, [&offsets, &inOffsets, id](const VertexId neighbor, W) {
+                ++offsets[id + 1];
+                ++inOffsets[neighbor + 1];
+            });
+        }
+        for (size_t i = 0; i < vertexCount; ++i) {
+            offsets[i + 1] += offsets[i];
+            inOffsets[i + 1] += inOffsets[i];
+        }
+
+        // group the edges by target, scanning sources in increasing order
+        std::vector<VertexId> inSources(offsets.back());
+        std::vector<W> inWeights(offsets.back());
+        std::vector<size_t> cursors(inOffsets.begin(), inOffsets.end() - 1);
+        for (VertexId id = 0; id < vertexCount; ++id) {
+            if (present[id] == 0) {
+                continue;
+            }
+            graph.for_each_neighbor(id, [&inSources, &inWeights, &cursors, id](const VertexId neighbor, const W weight) {
+                inSources[cursors[neighbor]] = id;
+                inWeights[cursors[neighbor]] = weight;
+                ++cursors[neighbor];
+            });
+        }
+
+        // regroup the edges by source, scanning targets in increasing order, which leaves every row sorted
+        edges->targets.resize(offsets.back());
+        edges->weights.resize(offsets.back());
+        cursors.assign(offsets.begin(), offsets.end() - 1);
+        for (VertexId target = 0; target < vertexCount; ++target) {
+            for (size_t i = inOffsets[target]; i < inOffsets[target + 1]; ++i) {
+                const size_t position = cursors[inSources[i]]++;
+                edges->targets[position] = target;
+                edges->weights[position] = inWeights[i];
+            }
+        }
+        adopt(std::move(vertices));
+        adopt(std::move(edges));
+    }
+
+    /**
+     * Get the number of vertices in the graph.
+     * @return The number of vertices in the graph.
+     */
+    [[nodiscard]] size_t size() const {
+        return _size;
+    }
+
+    /**
+     * Check if the graph is empty (has no vertices).
+     * @return true if the graph is empty, false otherwise.
+     */
+    [[nodiscard]] bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * Get the id bound of the graph (the same as the id bound of the graph the snapshot was created from).
+     * @return The id bound of the graph.
+     */
+    [[nodiscard]] size_t id_bound() const {
+        return _values.size();
+    }
+
+    /**
+     * Check if there is a vertex with the given id.
+     * @param id The id to check.
+     * @return true if there is a vertex with the given id, false otherwise.
+     */
+    [[nodiscard]] bool contains_id(const VertexId id) const {
+        return id < _values.size() && _present[id] != 0;
+    }
+
+    /**
+     * Get the number of edges in the graph.
+     * @return The number of edges in the graph.
+     */
+    [[nodiscard]] size_t edge_count() const {
+        return _targets.size();
+    }
+
+    /**
+     * Get the id of a vertex.
+     * @throws VertexNotFoundException If the vertex doesn't exist.
+     * @param vertex The vertex to get the id of.
+     * @return The id of the vertex.
+     */
+    [[nodiscard]] VertexId id_of(const T& vertex) const {
+        return checked_id(vertex, "vertex not found");
+    }
+
+    /**
+     * Get the vertex with the given id.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return The vertex with the given id.
+     */
+    [[nodiscard]] const T& value_of(const VertexId id) const {
+        if (!contains_id(id)) {
+            throw VertexNotFoundException("vertex not found");
+        }
+        return _values[id];
+    }
+
+    /**
+     * Check if the vertices are adjacent in the graph.
+     * @throws VertexNotFoundException If any of the vertices don't exist.
+     * @param vertex1 The first vertex.
+     * @param vertex2 The second vertex.
+     * @return true if the vertices are adjacent, false otherwise.
+     */
+    [[nodiscard]] bool adjacent(const T& vertex1, const T& vertex2) const {
+        const VertexId id1 = checked_id(vertex1, "vertex1 not found");
+        const VertexId id2 = checked_id(vertex2, "vertex2 not found");
+        return find_edge(id1, id2) != nullptr;
+    }
+
+    /**
+     * Check if the vertices with the given ids are adjacent in the graph.
+     * @throws VertexNotFoundException If there is no vertex with any of the given ids.
+     * @param id1 The id of the first vertex.
+     * @param id2 The id of the second vertex.
+     * @return true if the vertices are adjacent, false otherwise.
+     */
+    [[nodiscard]] bool adjacent_by_id(const VertexId id1, const VertexId id2) const {
+        check_ids(id1, id2);
+        return find_edge(id1, id2) != nullptr;
+    }
+
+    /**
+     * Get the neighbors of a vertex.
+     * @throws VertexNotFoundException If the vertex doesn't exist.
+     * @param vertex The vertex to get the neighbors of.
+     * @return A vector with the neighbors of the vertex.
+     */
+    [[nodiscard]] std::vector<T> neighbors(const T& vertex) const {
+        std::vector<T> neighborsVec;
+        for (const VertexId neighbor : neighbor_ids(checked_id(vertex, "vertex not found"))) {
+            neighborsVec.push_back(_values[neighbor]);
+        }
+        return neighborsVec;
+    }
+
+    /**
+     * Get the ids of the neighbors of the vertex with the given id.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex to get the neighbors of.
+     * @return A vector with the ids of the neighbors of the vertex.
+     */
+    [[nodiscard]] std::vector<VertexId> neighbors_by_id(const VertexId id) const {
+        const std::span<const VertexId> ids = neighbor_ids(id);
+        return {ids.begin(), ids.end()};
+    }
+
+    /**
+     * Get the weight of an edge.
+     *
+     * The order of the vertices matters since the graph is directed.
+     * @param vertex1 The first vertex.
+     * @param vertex2 The second vertex.
+     * @throws VertexNotFoundException If any of the vertices don't exist.
+     * @return The weight of the edge (W{} if the edge doesn't exist).
+     */
+    [[nodiscard]] W get_edge_weight(const T& vertex1, const T& vertex2) const {
+        const VertexId id1 = checked_id(vertex1, "vertex1 not found");
+        const VertexId id2 = checked_id(vertex2, "vertex2 not found");
+        const W* weight = find_edge(id1, id2);
+        return weight == nullptr ? W{} : *weight;
+    }
+
+    /**
+     * Get the weight of the edge between the vertices with the given ids.
+     * @param id1 The id of the first vertex.
+     * @param id2 The id of the second vertex.
+     * @throws VertexNotFoundException If there is no vertex with any of the given ids.
+     * @return The weight of the edge (W{} if the edge doesn't exist).
+     */
+    [[nodiscard]] W get_edge_weight_by_id(const VertexId id1, const VertexId id2) const {
+        check_ids(id1, id2);
+        const W* weight = find_edge(id1, id2);
+        return weight == nullptr ? W{} : *weight;
+    }
+
+    /**
+     * Get the number of outgoing edges of a vertex.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return The number of outgoing edges of the vertex.
+     */
+    [[nodiscard]] size_t degree(const VertexId id) const {
+        return neighbor_ids(id).size();
+    }
+
+    /**
+     * Get the ids of the neighbors of a vertex, sorted in increasing order.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return A view of the ids of the neighbors.
+     */
+    [[nodiscard]] std::span<const VertexId> neighbor_ids(const VertexId id) const {
+        if (!contains_id(id)) {
+            throw VertexNotFoundException("vertex not found");
+        }
+        return _targets.subspan(_offsets[id], _offsets[id + 1] - _offsets[id]);
+    }
+
+    /**
+     * Get the weights of the outgoing edges of a vertex, in the same order as neighbor_ids().
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return A view of the weights of the outgoing edges.
+     */
+    [[nodiscard]] std::span<const W> neighbor_weights(const VertexId id) const {
+        if (!contains_id(id)) {
+            throw VertexNotFoundException("vertex not found");
+        }
+        return _weights.subspan(_offsets[id], _offsets[id + 1] - _offsets[id]);
+    }
+
+    /**
+     * Call a function for every outgoing edge of a vertex.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @param visitor Called with the id of the neighbor and the weight of the edge for every outgoing edge.
+     */
+    template <typename F>
+    void for_each_neighbor(const VertexId id, F visitor) const {
+        if (!contains_id(id)) {
+            throw VertexNotFoundException("vertex not found");
+        }
+        for (size_t i = _offsets[id]; i < _offsets[id + 1]; ++i) {
+            std::invoke(visitor, _targets[i], _weights[i]);
+        }
+    }
+
+    /**
+     * Get a lazy view over the outgoing edges of a vertex.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return A view yielding the id and the value of each neighbor and the weight of the edge leading to it.
+     */
+    [[nodiscard]] NeighborRange<T, NeighborCursor, W> neighbor_range(const VertexId id) const {
+        if (!contains_id(id)) {
+            throw VertexNotFoundException("vertex not found");
+        }
+        return NeighborRange<T, NeighborCursor, W>{NeighborCursor{this, id}};
+    }
+
+    /**
+     * Create a snapshot of the same graph with every edge reversed, in O(V + E).
+     *
+     * Ids are the same, so the outgoing edges of a vertex in the transpose are its incoming edges
+     * in this snapshot (again sorted by id).
+     * @return The transposed snapshot.
+     */
+    [[nodiscard]] GraphCSR transpose() const {
+        // the vertices are the same, so their arrays and the map from values to ids are shared
+        GraphCSR transposed = *this;
+        auto edges = std::make_shared<EdgeArrays>();
+        edges->offsets.assign(_offsets.size(), 0);
+        for (const VertexId target : _targets) {
+            ++edges->offsets[target + 1];
+        }
+        for (size_t i = 0; i + 1 < edges->offsets.size(); ++i) {
+            edges->offsets[i + 1] += edges->offsets[i];
+        }
+
+        // scanning sources in increasing order leaves every row sorted
+        edges->targets.resize(_targets.size());
+        edges->weights.resize(_weights.size());
+        std::vector<size_t> cursors(edges->offsets.begin(), edges->offsets.end() - 1);
+        for (VertexId id = 0; id + 1 < _offsets.size(); ++id) {
+            for (size_t i = _offsets[id]; i < _offsets[id + 1]; ++i) {
+                const size_t position = cursors[_targets[i]]++;
+                edges->targets[position] = id;
+                edges->weights[position] = _weights[i];
+            }
+        }
+        transposed.adopt(std::move(edges));
+        return transposed;
+    }
+
+    /**
+     * Multiply the adjacency matrix of the snapshot by a vector in parallel, in O(V + E):
+     * y[i] is the sum of edgeValue(w) * x[j] over the outgoing edges i -> j of weight w.
+     *
+     * Rows are split between threads so that every thread gets about the same number of rows plus edges,
+     * which keeps threads balanced on graphs with skewed degrees. Every element of y is written by a single thread.
+     * Rows of ids without a vertex are set to 0. Multiplying the transpose instead pulls values along
+     * the incoming edges, as pagerank() does.
+     * @param x The vector to multiply, indexed by vertex id (at least id_bound() elements).
+     * @param y The vector to write the result to, indexed by vertex id (at least id_bound() elements), must not overlap x.
+     * @param threadCount The number of threads to use, 0 for one per hardware thread.
+     * @param edgeValue Maps the weight of an edge to its value in the matrix, for example to 1 to ignore the weights.
+     */
+    template <typename F = std::identity>
+    void multiply(const std::span<const double> x, const std::span<double> y, const size_t threadCount = 0, F edgeValue = {}) const {
+        const size_t rowCount = id_bound();
+        const size_t threads = resolve_thread_count(threadCount);
+        // the cost of rows [0, i) is offsets[i] + i, split it evenly
+        std::vector<size_t> bounds(threads + 1, rowCount);
+        for (size_t thread = 0; thread < threads; ++thread) {
+            const size_t cost = (edge_count() + rowCount) * thread / threads;
+            bounds[thread] = *std::ranges::partition_point(std::views::iota(size_t{0}, rowCount), [this, cost](const size_t row) {
+                return _offsets[row] + row < cost;
+            });
+        }
+        parallel_blocks(threads, threads, [&](size_t, const size_t firstThread, const size_t lastThread) {
+            for (size_t row = bounds[firstThread]; row < bounds[lastThread]; ++row) {
+                double sum = 0.0;
+                for (size_t i = _offsets[row]; i < _offsets[row + 1]; ++i) {
+                    sum += std::invoke(edgeValue, _weights[i]) * x[_targets[i]];
+                }
+                y[row] = sum;
+            }
+        });
+    }
+
+    /**
+     * Save the snapshot to a binary file, which can be loaded back with load_mmap().
+     *
+     * The file holds the arrays of the snapshot as they are in memory, plus a hash table from
+     * vertices to ids, so it can only be read on a machine with the same byte order and word size.
+     * Only available if the bytes of a vertex determine its value (for example integers, but not floating-point numbers),
+     * or if the vertices are strings, which are saved in a table of characters.
+     * @param path The path of the file, which is overwritten if it exists.
+     * @throws GraphFileException If the file can't be written.
+     */
+    void save_binary(const std::string& path) const requires BinaryVertex<T> && std::is_trivially_copyable_v<W> {
+        // at most half full, so probes stay short
+        std::vector<VertexId> index(std::bit_ceil(std::max<size_t>(2 * _size, 1)), NO_VERTEX);
+        const size_t mask = index.size() - 1;
+        for (VertexId id = 0; id < id_bound(); ++id) {
+            if (contains_id(id)) {
+                size_t slot = file_hash(_values[id]) & mask;
+                while (index[slot] != NO_VERTEX) {
+                    slot = (slot + 1) & mask;
+                }
+                index[slot] = id;
+            }
+        }
+
+        // strings are saved as their offsets in a table of characters (ids without a vertex get empty strings)
+        std::vector<std::uint64_t> stringOffsets;
+        std::string characters;
+        if constexpr (STRING_VALUES) {
+            stringOffsets.reserve(id_bound() + 1);
+            stringOffsets.push_back(0);
+            for (const T& value : _values) {
+                characters.append(value);
+                stringOffsets.push_back(characters.size());
+            }
+        }
+
+        const FileHeader header{FILE_MAGIC, FILE_VERSION, FILE_BYTE_ORDER, sizeof(size_t), STRING_VALUES ? 0 : sizeof(T), sizeof(W),
+                                id_bound(), _size, edge_count(), index.size(), characters.size()};
+        const FileLayout layout = file_layout(header);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw GraphFileException("cannot open " + path);
+        }
+        size_t position = 0;
+        const auto write = [&file, &position](const size_t start, const std::span<const std::byte> bytes) {
+            for (; position < start; ++position) {
+                file.put('\0');
+            }
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            position += bytes.size();
+        };
+        write(0, std::as_bytes(std::span(&header, 1)));
+        write(layout.offsets, std::as_bytes(_offsets));
+        write(layout.targets, std::as_bytes(_targets));
+        write(layout.weights, std::as_bytes(_weights));
+        write(layout.present, std::as_bytes(_present));
+        if constexpr (STRING_VALUES) {
+            write(layout.values, std::as_bytes(std::span(stringOffsets)));
+            write(layout.strings, std::as_bytes(std::span(characters)));
+        } else {
+            write(layout.values, std::as_bytes(_values));
+        }
+        write(layout.index, std::as_bytes(std::span(index)));
+        write(layout.size, {});
+        if (!file.flush()) {
+            throw GraphFileException("cannot write " + path);
+        }
+    }
+
+    /**
+     * Load a snapshot saved with save_binary() by mapping the file into memory, in O(1) (O(V) for strings).
+     *
+     * Nothing is parsed or copied: the snapshot reads its arrays straight from the mapped file,
+     * and pages are loaded by the operating system when they are first accessed. The only exception are
+     * strings, which are created from the table of characters of the file when it is loaded
+     * (string views point into the mapped file).
+     * The file stays mapped until the snapshot and all its copies are destroyed, and must not be modified meanwhile.
+     * The header, offsets, targets and index are checked in one pass, but not the values and weights,
+     * so the file must have been written by save_binary().
+     * @param path The path of the file.
+     * @throws GraphFileException If the file can't be read, or is not a graph file for these types of vertices and weights.
+     * @return The snapshot.
+     */
+    [[nodiscard]] static GraphCSR load_mmap(const std::string& path) requires BinaryVertex<T> && std::is_trivially_copyable_v<W> {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+        const int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0) {
+            throw GraphFileException("cannot open " + path);
+        }
+        struct stat status{};
+        if (::fstat(descriptor, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(FileHeader)) {
+            ::close(descriptor);
+            throw GraphFileException("not a graph file: " + path);
+        }
+        const auto fileSize = static_cast<size_t>(status.st_size);
+        void* address = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        ::close(descriptor);
+        if (address == MAP_FAILED) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast,performance-no-int-to-ptr)
+            throw GraphFileException("cannot map " + path);
+        }
+        const std::shared_ptr<void> memory(address, [fileSize](void* mapped) {
+            ::munmap(mapped, fileSize);
+        });
+
+        FileHeader header{};
+        std::memcpy(&header, address, sizeof(FileHeader));
+        // the counts are checked against the file size first, so computing the layout can't overflow
+        if (header.magic != FILE_MAGIC || header.version != FILE_VERSION || header.byteOrder != FILE_BYTE_ORDER ||
+            header.wordSize != sizeof(size_t) || header.valueSize != (STRING_VALUES ? 0 : sizeof(T)) || header.weightSize != sizeof(W) ||
+            header.idBound > fileSize || header.vertexCount > header.idBound || header.edgeCount > fileSize || header.indexSize > fileSize ||
+            header.stringBytes > fileSize ||
+            !std::has_single_bit(header.indexSize) || file_layout(header).size != fileSize) {
+            throw GraphFileException("not a graph file: " + path);
+        }
+
+        const FileLayout layout = file_layout(header);
+        const auto* file = static_cast<const std::byte*>(address);
+        GraphCSR graph;
+        graph._edgeMemory = memory;
+        graph._offsets = mapped_array<size_t>(file, layout.offsets, header.idBound + 1);
+        graph._targets = mapped_array<VertexId>(file, layout.targets, header.edgeCount);
+        graph._weights = mapped_array<W>(file, layout.weights, header.edgeCount);
+        graph._present = mapped_array<std::uint8_t>(file, layout.present, header.idBound);
+        if constexpr (STRING_VALUES) {
+            const std::span<const std::uint64_t> stringOffsets = mapped_array<std::uint64_t>(file, layout.values, header.idBound + 1);
+            const std::span<const char> characters = mapped_array<char>(file, layout.strings, header.stringBytes);
+            if (stringOffsets.front() != 0 || stringOffsets.back() != header.stringBytes) {
+                throw GraphFileException("not a graph file: " + path);
+            }
+            auto vertices = std::make_shared<VertexArrays>();
+            vertices->values.reserve(header.idBound);
+            for (VertexId id = 0; id < header.idBound; ++id) {
+                if (stringOffsets[id] > stringOffsets[id + 1] || stringOffsets[id + 1] > header.stringBytes) {
+                    throw GraphFileException("not a graph file: " + path);
+                }
+                const std::span<const char> string = characters.subspan(stringOffsets[id], stringOffsets[id + 1] - stringOffsets[id]);
+                vertices->values.emplace_back(string.data(), string.size());
+            }
+            // the other vertex arrays stay in the file
+            vertices->file = memory;
+            graph._values = vertices->values;
+            graph._vertexMemory = std::move(vertices);
+        } else {
+            graph._values = mapped_array<T>(file, layout.values, header.idBound);
+            graph._vertexMemory = memory;
+        }
+        graph._fileIndex = mapped_array<VertexId>(file, layout.index, header.indexSize);
+        graph._size = header.vertexCount;
+        if (graph._offsets.front() != 0 || graph._offsets.back() != header.edgeCount) {
+            throw GraphFileException("not a graph file: " + path);
+        }
+        // a corrupted file must not make the traversals and lookups read outside of the arrays
+        for (VertexId id = 0; id < header.idBound; ++id) {
+            if (graph._offsets[id] > graph._offsets[id + 1]) {
+                throw GraphFileException("not a graph file: " + path);
+            }
+        }
+        if (std::ranges::any_of(graph._targets, [&header](const VertexId target) { return target >= header.idBound; }) ||
+            std::ranges::any_of(graph._fileIndex, [&header](const VertexId id) { return id != NO_VERTEX && id >= header.idBound; })) {
+            throw GraphFileException("not a graph file: " + path);
+        }
+        return graph;
+    }
+};
+
+/**
+ * Graph shared between concurrent readers and writers, in the style of read-copy-update (RCU).
+ *
+ * Readers take an immutable, versioned snapshot of the graph, which never changes while it is held.
+ * Taking it is lock-free: the current version is published through an atomic pointer, which a reader
+ * protects with a hazard pointer while it copies the shared pointer to the snapshot, so readers never
+ * wait for writers or for each other.
+ * Writers copy the current graph, apply a batch of updates to the copy and publish it atomically,
+ * so readers see either none or all of the updates of a batch. Writers are serialized by a mutex.
+ * Every update copies the whole graph, so updates should be batched.
+ * An old version is freed when the last reader holding it drops its snapshot.
+ */
+template <typename G>
+class ConcurrentGraph {
+public:
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    struct Snapshot {
+        G graph;
+        // number of updates published before this snapshot
+        size_t version = 0;
+    };
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+private:
+    // published version, owning a reference to its snapshot
+    struct Version {
+        std::shared_ptr<const Snapshot> snapshot;
+    };
+
+    // hazard pointer, set by a reader to the version it is reading, on its own cache line
+    struct alignas(64) HazardSlot {
+        std::atomic<const Version*> version = nullptr;
+    };
+
+    // number of readers that can take a snapshot at the very same time without retrying
+    static constexpr size_t HAZARD_SLOTS = 64;
+    static_assert(std::atomic<const Version*>::is_always_lock_free);
+
+    std::atomic<const Version*> _current;
+    mutable std::array<HazardSlot, HAZARD_SLOTS> _hazards;
+
+    // unpublished versions that may still be read, freed by writers once no hazard pointer protects them
+    std::vector<std::unique_ptr<const Version>> _retired;
+    std::mutex _writerMutex;
+
+    // free the retired versions that no reader is reading
+    void reclaim() {
+        std::erase_if(_retired, [this](const std::unique_ptr<const Version>& version) {
+            return std::ranges::none_of(_hazards, [&version](const HazardSlot& slot) { return slot.version.load() == version.get(); });
+        });
+    }
+public:
+    /**
+     * Share a graph between threads.
+     * @param graph The initial version of the graph.
+     */
+    explicit ConcurrentGraph(G graph = G{}) :
+        _current(new Version{std::make_shared<const Snapshot>(Snapshot{std::move(graph), 0})}) {} // NOLINT(cppcoreguidelines-owning-memory)
+
+    // destructor
+    ~ConcurrentGraph() {
+        delete _current.load(); // NOLINT(cppcoreguidelines-owning-memory)
+    }
+
+    ConcurrentGraph(const ConcurrentGraph&) = delete;
+    ConcurrentGraph(ConcurrentGraph&&) = delete;
+    ConcurrentGraph& operator=(const ConcurrentGraph&) = delete;
+    ConcurrentGraph& operator=(ConcurrentGraph&&) = delete;
+
+    /**
+     * Get the current version of the graph. Lock-free: never waits for writers or other readers.
+     * @return The current snapshot, which stays valid and unchanged for as long as it is held.
+     */
+    [[nodiscard]] std::shared_ptr<const Snapshot> snapshot() const {
+        // start from a slot that depends on the thread, so that readers rarely compete for one
+        size_t slot = std::hash<std::thread::id>{}(std::this_thread::get_id()) % HAZARD_SLOTS;
+        while (true) {
+            const Version* version = _current.load();
+            const Version* expected = nullptr;
+            if (_hazards[slot].version.compare_exchange_strong(expected, version)) {
+                // the version cannot be freed once it is protected and still published
+                if (_current.load() == version) {
+                    std::shared_ptr<const Snapshot> result = version->snapshot;
+                    _hazards[slot].version.store(nullptr);
+                    return result;
+                }
+                _hazards[slot].version.store(nullptr);
+            } else {
+                slot = (slot + 1) % HAZARD_SLOTS;
+            }
+        }
+    }
+
+    /**
+     * Get the number of updates published so far.
+     * @return The version of the current snapshot.
+     */
+    [[nodiscard]] size_t version() const {
+        return snapshot()->version;
+    }
+
+    /**
+     * Apply a batch of updates and publish the result as a new version.
+     *
+     * If the batch throws, nothing is published and the exception is propagated.
+     * @param batch Called with a copy of the current graph, which it may modify.
+     * @return The version of the published snapshot.
+     */
+    template <typename F>
+    size_t update(F batch) {
+        const std::lock_guard lock(_writerMutex);
+        const Version* current = _current.load();
+        auto next = std::make_shared<Snapshot>(Snapshot{current->snapshot->graph, current->snapshot->version + 1});
+        std::invoke(batch, next->graph);
+        const size_t version = next->version;
+        _retired.reserve(_retired.size() + 1);
+        _current.store(new Version{std::move(next)}); // NOLINT(cppcoreguidelines-owning-memory)
+        _retired.emplace_back(current);
+        reclaim();
+        return version;
+    }
+};
+
+/**
+ * Requirements for graphs usable by the id-based algorithms below.
+ *
+ * Vertices are identified by ids smaller than id_bound() and outgoing edges are enumerated with for_each_neighbor().
+ * The algorithms read weights as double lengths, so any weight type convertible to double works (including Unweighted).
+ */
+template <typename G>
+concept NeighborGraph = requires(const G& graph, const VertexId id) {
+    { graph.size() } -> std::convertible_to<size_t>;
+    { graph.id_bound() } -> std::convertible_to<size_t>;
+    { graph.contains_id(id) } -> std::convertible_to<bool>;
+    graph.for_each_neighbor(id, [](VertexId, double) {});
+};
+
+/**
+ * Visited set of a graph traversal, kept outside of the graph and indexed by vertex id.
+ *
+ * Every traversal can use its own state, so several traversals (e.g. one per thread)
+ * can run on the same graph at once. A vertex is marked by stamping its id with the
+ * current epoch, so reset() only starts a new epoch and takes O(1).
+ */
+class TraversalState {
+private:
+    std::vector<std::uint32_t> _stamps;
+
+    // stamp of the vertices visited since the last reset (stamps of 0 are never visited)
+    std::uint32_t _epoch = 1;
+public:
+    // constructor
+    TraversalState() = default;
+
+    /**
+     * Create a state for ids smaller than the given id bound, with no visited vertices.
+     * @param idBound The id bound of the graph to traverse.
+     */
+    explicit TraversalState(const size_t idBound) : _stamps(idBound, 0) {}
+
+    /**
+     * Get the id bound of the state.
+     * @return The number of ids the state has room for.
+     */
+    [[nodiscard]] size_t id_bound() const {
+        return _stamps.size();
+    }
+
+    /**
+     * Make room for ids smaller than the given id bound. The state never shrinks.
+     * @param idBound The id bound of the graph to traverse.
+     */
+    void resize(const size_t idBound) {
+        if (idBound > _stamps.size()) {
+            _stamps.resize(idBound, 0);
+        }
+    }
+
+    /**
+     * Check if a vertex has been visited since the last reset.
+     * @param id The id of the vertex, which must be smaller than id_bound().
+     * @return true if the vertex has been visited, false otherwise.
+     */
+    [[nodiscard]] bool visited(const VertexId id) const {
+        return _stamps[id] == _epoch;
+    }
+
+    /**
+     * Mark a vertex as visited.
+     * @param id The id of the vertex, which must be smaller than id_bound().
+     * @return true if the vertex was not visited before, false otherwise.
+     */
+    bool visit(const VertexId id) {
+        if (_stamps[id] == _epoch) {
+            return false;
+        }
+        _stamps[id] = _epoch;
+        return true;
+    }
+
+    /**
+     * Mark a vertex as not visited.
+     * @param id The id of the vertex, which must be smaller than id_bound().
+     */
+    void unvisit(const VertexId id) {
+        _stamps[id] = 0;
+    }
+
+    /**
+     * Mark all vertices as not visited in O(1) (O(V) once every 2^32 resets, when the epoch wraps around).
+     */
+    void reset() {
+        ++_epoch;
+        if (_epoch == 0) {
+            std::ranges::fill(_stamps, 0);
+            _epoch = 1;
+        }
+    }
+};
+
+/**
+ * Visit the vertices reachable from a source in breadth-first order.
+ *
+ * Vertices already visited in the state are neither visited nor expanded, so the state is not reset:
+ * reset it between independent searches, or keep it to search from several sources.
+ * @throws VertexNotFoundException If there is no vertex with the id of the source.
+ * @param graph The graph to search.
+ * @param source The id of the vertex to start from.
+ * @param state The visited set, resized to the id bound of the graph if needed.
+ * @param visitor Called with the id of every newly visited vertex, in the order they are visited.
+ */
+template <NeighborGraph G, typename F>
+void breadth_first_search(const G& graph, const VertexId source, TraversalState& state, F visitor) {
+    if (!graph.contains_id(source)) {
+        throw VertexNotFoundException("source not found");
+    }
+    state.resize(graph.id_bound());
+    if (!state.visit(source)) {
+        return;
+    }
+
+    std::vector<VertexId> queue{source};
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const VertexId id = queue[head];
+        std::invoke(visitor, id);
+        graph.for_each_neighbor(id, [&state, &queue](const VertexId neighbor, double) {
+            if (state.visit(neighbor)) {
+                queue.push_back(neighbor);
+            }
+        });
+    }
+}
+
+/**
+ * Visit the vertices reachable from a source in depth-first order.
+ *
+ * Vertices already visited in the state are neither visited nor expanded, so the state is not reset:
+ * reset it between independent searches, or keep it to search from several sources.
+ * @throws VertexNotFoundException If there is no vertex with the id of the source.
+ * @param graph The graph to search.
+ * @param source The id of the vertex to start from.
+ * @param state The visited set, resized to the id bound of the graph if needed.
+ * @param visitor Called with the id of every newly visited vertex, in the order they are visited.
+ */
+template <NeighborGraph G, typename F>
+void depth_first_search(const G& graph, const VertexId source, TraversalState& state, F visitor) {
+    if (!graph.contains_id(source)) {
+        throw VertexNotFoundException("source not found");
+    }
+    state.resize(graph.id_bound());
+
+    // a vertex may be pushed once per incoming edge, it is visited when it is first popped
+    std::vector<VertexId> stack{source};
+    while (!stack.empty()) {
+        const VertexId id = stack.back();
+        stack.pop_back();
+        if (!state.visit(id)) {
+            continue;
+        }
+        std::invoke(visitor, id);
+        graph.for_each_neighbor(id, [&state, &stack](const VertexId neighbor, double) {
+            if (!state.visited(neighbor)) {
+                stack.push_back(neighbor);
+            }
+        });
+    }
+}
+
+/**
+ * Min-heap of vertex ids keyed by distance, with support for decrease-key.
+ *
+ * The position of every id inside the heap is tracked, so a vertex is never inserted twice
+ * and the heap never holds more than one entry per vertex.
+ * Implemented as a 4-ary heap, which is shallower and more cache friendly than a binary one.
+ */
+class AddressableMinHeap {
+private:
+    static constexpr size_t ARITY = 4;
+    static constexpr size_t NOT_IN_HEAP = std::numeric_limits<size_t>::max();
+
+    // (key, id)
+    std::vector<std::pair<double, VertexId>> _heap;
+    std::vector<size_t> _positions;
+
+    void place(const size_t position, const std::pair<double, VertexId>& entry) {
+        _heap[position] = entry;
+        _positions[entry.second] = position;
+    }
+
+    void sift_up(size_t position) {
+        const std::pair<double, VertexId> entry = _heap[position];
+        while (position > 0) {
+            const size_t parent = (position - 1) / ARITY;
+            if (_heap[parent].first <= entry.first) {
+                break;
+            }
+            place(position, _heap[parent]);
+            position = parent;
+        }
+        place(position, entry);
+    }
+
+    void sift_down(size_t position) {
+        const std::pair<double, VertexId> entry = _heap[position];
+        while (true) {
+            const size_t first = (position * ARITY) + 1;
+            if (first >= _heap.size()) {
+                break;
+            }
+            const size_t last = std::min(first + ARITY, _heap.size());
+            size_t smallest = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (_heap[child].first < _heap[smallest].first) {
+                    smallest = child;
+                }
+            }
+            if (entry.first <= _heap[smallest].first) {
+                break;
+            }
+            place(position, _heap[smallest]);
+            position = smallest;
+        }
+        place(position, entry);
+    }
+public:
+    /**
+     * Construct an empty heap for ids in the range [0, idCount).
+     * @param idCount The number of distinct ids the heap can hold.
+     */
+    explicit AddressableMinHeap(const size_t idCount) : _positions(idCount, NOT_IN_HEAP) {}
+
+    /**
+     * Check if the heap is empty.
+     * @return true if the heap is empty, false otherwise.
+     */
+    [[nodiscard]] bool empty() const {
+        return _heap.empty();
+    }
+
+    /**
+     * Get the id with the smallest key without removing it.
+     * @return The (key, id) pair with the smallest key, the heap must not be empty.
+     */
+    [[nodiscard]] const std::pair<double, VertexId>& top() const {
+        return _heap.front();
+    }
+
+    /**
+     * Remove all ids, in O(size) rather than O(idCount).
+     */
+    void clear() {
+        for (const std::pair<double, VertexId>& entry : _heap) {
+            _positions[entry.second] = NOT_IN_HEAP;
+        }
+        _heap.clear();
+    }
+
+    /**
+     * Check if an id is in the heap.
+     * @param id The id to check.
+     * @return true if the id is in the heap, false otherwise.
+     */
+    [[nodiscard]] bool contains(const VertexId id) const {
+        return _positions[id] != NOT_IN_HEAP;
+    }
+
+    /**
+     * Insert an id, or lower its key if it is already in the heap.
+     *
+     * Keys are never increased; if the new key is not smaller than the current one, nothing is done.
+     * @param id The id to insert or update.
+     * @param key The new key of the id.
+     */
+    void push_or_decrease(const VertexId id, const double key) {
+        if (contains(id)) {
+            const size_t position = _positions[id];
+            if (key < _heap[position].first) {
+                _heap[position].first = key;
+                sift_up(position);
+            }
+        } else {
+            _heap.emplace_back(key, id);
+            sift_up(_heap.size() - 1);
+        }
+    }
+
+    /**
+     * Remove the id with the smallest key.
+     * @return The (key, id) pair that was removed.
+     */
+    std::pair<double, VertexId> pop() {
+        const std::pair<double, VertexId> top = _heap.front();
+        _positions[top.second] = NOT_IN_HEAP;
+        const std::pair<double, VertexId> last = _heap.back();
+        _heap.pop_back();
+        if (!_heap.empty()) {
+            _heap.front() = last;
+            sift_down(0);
+        }
+        return top;
+    }
+};
+
+/**
+ * Result of a single-source shortest path search.
+ *
+ * Both vectors are indexed by vertex id (their size is the id bound of the graph).
+ * Unreachable vertices have an infinite distance and no predecessor (NO_VERTEX),
+ * the source has a distance of 0 and no predecessor.
+ */
+struct ShortestPaths {
+    std::vector<double> distances;
+    std::vector<VertexId> predecessors;
+};
+
+/**
+ * Find the shortest path from the source vertex to a target vertex using Dijkstra's algorithm.
+ *
+ * The search stops as soon as the target is settled, so only the distance of the target
+ * and the vertices on the path to it are guaranteed to be final.
+ * Passing NO_VERTEX as the target searches the whole graph.
+ * @throws VertexNotFoundException If the source or the target doesn't exist.
+ * @throws NegativeEdgeWeightException If a negative edge weight is encountered.
+ * @param graph The graph to search.
+ * @param source The id of the source vertex.
+ * @param target The id of the target vertex.
+ * @return The distances and predecessors of the vertices.
+ */
+template <NeighborGraph G>
+ShortestPaths dijkstra(const G& graph, const VertexId source, const VertexId target) {
+    const size_t vertexCount = graph.id_bound();
+    if (!graph.contains_id(source)) {
+        throw VertexNotFoundException("source not found");
+    }
+    if (target != NO_VERTEX && !graph.contains_id(target)) {
+        throw VertexNotFoundException("target not found");
+    }
+
+    ShortestPaths paths{
+        std::vector<double>(vertexCount, std::numeric_limits<double>::infinity()),
+        std::vector<VertexId>(vertexCount, NO_VERTEX)
+    };
+    AddressableMinHeap heap(vertexCount);
+    paths.distances[source] = 0.0;
+    heap.push_or_decrease(source, 0.0);
+
+    while (!heap.empty()) {
+        const auto [distance, id] = heap.pop();
+        if (id == target) {
+            break;
+        }
+        graph.for_each_neighbor(id, [&paths, &heap, distance, id](const VertexId neighbor, const double weight) {
+            if (weight < 0.0) {
+                throw NegativeEdgeWeightException("negative edge weight");
+            }
+            const double newDistance = distance + weight;
+            if (newDistance < paths.distances[neighbor]) {
+                paths.distances[neighbor] = newDistance;
+                paths.predecessors[neighbor] = id;
+                heap.push_or_decrease(neighbor, newDistance);
+            }
+        });
+    }
+
+    return paths;
+}
+
+/**
+ * Find the shortest paths from the source vertex to all other vertices using Dijkstra's algorithm.
+ * @throws VertexNotFoundException If the source doesn't exist.
+ * @throws NegativeEdgeWeightException If a negative edge weight is encountered.
+ * @param graph The graph to search.
+ * @param source The id of the source vertex.
+ * @return The distances and predecessors of the vertices.
+ */
+template <NeighborGraph G>
+ShortestPaths dijkstra(const G& graph, const VertexId source) {
+    return dijkstra(graph, source, NO_VERTEX);
+}
+
+/**
+ * Reconstruct the path to a target vertex from a shortest path tree.
+ * @param paths The result of a shortest path search.
+ * @param target The id of the target vertex.
+ * @return The ids of the vertices on the path, from the source to the target
+ *         (empty if the target is unreachable).
+ */
+inline std::vector<VertexId> reconstruct_path(const ShortestPaths& paths, const VertexId target) {
+    std::vector<VertexId> path;
+    if (target >= paths.distances.size() || paths.distances[target] == std::numeric_limits<double>::infinity()) {
+        return path;
+    }
+    for (VertexId id = target; id != NO_VERTEX; id = paths.predecessors[id]) {
+        path.push_back(id);
+    }
+    std::ranges::reverse(path);
+    return path;
+}
+
+/**
+ * Result of a point-to-point shortest path search.
+ */
+struct PointToPointPath {
+    // length of the path, infinite if the target is unreachable
+    double distance = std::numeric_limits<double>::infinity();
+    // ids of the vertices on the path, from the source to the target (empty if the target is unreachable)
+    std::vector<VertexId> vertices;
+    // number of vertices removed from the priority queues, which measures the size of the search space
+    size_t settled = 0;
+};
+
+/**
+ * Find the shortest path from the source vertex to a target vertex using the A* algorithm.
+ *
+ * Works like Dijkstra's algorithm, but vertices are settled in the order of their distance
+ * from the source plus the estimated distance to the target, which steers the search towards the target.
+ * The path is a shortest path if the heuristic never overestimates the distance to the target (it is admissible).
+ * If it is also consistent (h(u) <= w(u, v) + h(v) for every edge), every vertex is settled at most once,
+ * otherwise vertices may be settled again when a shorter path to them is found.
+ * A heuristic that always returns 0 gives Dijkstra's algorithm.
+ * @throws VertexNotFoundException If the source or the target doesn't exist.
+ * @throws NegativeEdgeWeightException If a negative edge weight is encountered.
+ * @param graph The graph to search.
+ * @param source The id of the source vertex.
+ * @param target The id of the target vertex.
+ * @param heuristic Called with the id of a vertex, returns a lower bound of the distance from the vertex to the target.
+ * @return The shortest path and the number of settled vertices.
+ */
+template <NeighborGraph G, typename H>
+PointToPointPath a_star(const G& graph, const VertexId source, const VertexId target, H heuristic) {
+    const size_t vertexCount = graph.id_bound();
+    if (!graph.contains_id(source)) {
+        throw VertexNotFoundException("source not found");
+    }
+    if (!graph.contains_id(target)) {
+        throw VertexNotFoundException("target not found");
+    }
+
+    ShortestPaths paths{
+        std::vector<double>(vertexCount, std::numeric_limits<double>::infinity()),
+        std::vector<VertexId>(vertexCount, NO_VERTEX)
+    };
+    AddressableMinHeap heap(vertexCount);
+    PointToPointPath path;
+    paths.distances[source] = 0.0;
+    heap.push_or_decrease(source, std::invoke(heuristic, source));
+
+    while (!heap.empty()) {
+        const VertexId id = heap.pop().second;
+        ++path.settled;
+        if (id == target) {
+            path.distance = paths.distances[target];
+            path.vertices = reconstruct_path(paths, target);
+            break;
+        }
+        const double distance = paths.distances[id];
+        graph.for_each_neighbor(id, [&paths, &heap, &heuristic, distance, id](const VertexId neighbor, const double weight) {
+            if (weight < 0.0) {
+                throw NegativeEdgeWeightException("negative edge weight");
+            }
+            const double newDistance = distance + weight;
+            if (newDistance < paths.distances[neighbor]) {
+                paths.distances[neighbor] = newDistance;
+                paths.predecessors[neighbor] = id;
+                heap.push_or_decrease(neighbor, newDistance + std::invoke(heuristic, neighbor));
+            }
+        });
+    }
+
+    return path;
+}
+
+/**
+ * Find the shortest path from the source vertex to a target vertex using bidirectional Dijkstra's algorithm.
+ *
+ * A forward search from the source and a backward search from the target (along reversed edges)
+ * take turns, each time advancing the one whose next vertex is closer. Whenever an edge reaches a vertex
+ * the other search has a distance for, the length of the path through it is a candidate.
+ * The search stops as soon as the sum of the smallest keys of both queues reaches the best candidate,
+ * since no shorter path can be found afterwards. This settles about two balls of half the radius,
+ * instead of one ball of the whole radius.
+ * @throws VertexNotFoundException If the source or the target doesn't exist.
+ * @throws NegativeEdgeWeightException If a negative edge weight is encountered.
+ * @param graph The graph to search.
+ * @param reverse The graph with every edge reversed and the same ids (for example graph.freeze().transpose() or graph.reverse_view()).
+ * @param source The id of the source vertex.
+ * @param target The id of the target vertex.
+ * @return The shortest path and the number of vertices settled by both searches.
+ */
+template <NeighborGraph G, NeighborGraph R>
+PointToPointPath bidirectional_dijkstra(const G& graph, const R& reverse, const VertexId source, const VertexId target) {
+    const size_t vertexCount = graph.id_bound();
+    if (!graph.contains_id(source)) {
+        throw VertexNotFoundException("source not found");
+    }
+    if (!graph.contains_id(target)) {
+        throw VertexNotFoundException("target not found");
+    }
+
+    // searches[0] goes forward from the source, searches[1] backward from the target
+    std::array<ShortestPaths, 2> searches;
+    std::array<AddressableMinHeap, 2> heaps{AddressableMinHeap(vertexCount), AddressableMinHeap(vertexCount)};
+    for (ShortestPaths& search : searches) {
+        search.distances.assign(vertexCount, std::numeric_limits<double>::infinity());
+        search.predecessors.assign(vertexCount, NO_VERTEX);
+    }
+    searches[0].distances[source] = 0.0;
+    searches[1].distances[target] = 0.0;
+    heaps[0].push_or_decrease(source, 0.0);
+    heaps[1].push_or_decrease(target, 0.0);
+
+    PointToPointPath path;
+    VertexId meeting = source == target ? source : NO_VERTEX;
+    if (source == target) {
+        path.distance = 0.0;
+    }
+    const auto step = [&](const auto& sideGraph, ShortestPaths& own, const ShortestPaths& other, AddressableMinHeap& heap) {
+        const auto [distance, id] = heap.pop();
+        ++path.settled;
+        sideGraph.for_each_neighbor(id, [&](const VertexId neighbor, const double weight) {
+            if (weight < 0.0) {
+                throw NegativeEdgeWeightException("negative edge weight");
+            }
+            const double newDistance = distance + weight;
+            if (newDistance < own.distances[neighbor]) {
+                own.distances[neighbor] = newDistance;
+                own.predecessors[neighbor] = id;
+                heap.push_or_decrease(neighbor, newDistance);
+            }
+            if (own.distances[neighbor] + other.distances[neighbor] < path.distance) {
+                path.distance = own.distances[neighbor] + other.distances[neighbor];
+                meeting = neighbor;
+            }
+        });
+    };
+
+    while (!heaps[0].empty() && !heaps[1].empty() && heaps[0].top().first + heaps[1].top().first < path.distance) {
+        if (heaps[0].top().first <= heaps[1].top().first) {
+            step(graph, searches[0], searches[1], heaps[0]);
+        } else {
+            step(reverse, searches[1], searches[0], heaps[1]);
+        }
+    }
+
+    if (meeting != NO_VERTEX) {
+        path.vertices = reconstruct_path(searches[0], meeting);
+        for (VertexId id = searches[1].predecessors[meeting]; id != NO_VERTEX; id = searches[1].predecessors[id]) {
+            path.vertices.push_back(id);
+        }
+    }
+    return path;
+}
+
+/**
+ * Find the shortest path from the source vertex to a target vertex using bidirectional Dijkstra's algorithm, see above.
+ *
+ * Searches the predecessor index of a GraphAdjacencyList if it is enabled, otherwise builds the transpose of the graph first,
+ * pass it explicitly to reuse it across searches.
+ * @throws VertexNotFoundException If the source or the target doesn't exist.
+ * @throws NegativeEdgeWeightException If a negative edge weight is encountered.
+ * @param graph The graph to search (a Graph or a GraphCSR).
+ * @param source The id of the source vertex.
+ * @param target The id of the target vertex.
+ * @return The shortest path and the number of vertices settled by both searches.
+ */
+template <NeighborGraph G>
+PointToPointPath bidirectional_dijkstra(const G& graph, const VertexId source, const VertexId target) {
+    if constexpr (requires { graph.reverse_view(); }) {
+        if (graph.has_predecessor_index()) {
+            return bidirectional_dijkstra(graph, graph.reverse_view(), source, target);
+        }
+    }
+    if constexpr (requires { graph.transpose(); }) {
+        return bidirectional_dijkstra(graph, graph.transpose(), source, target);
+    } else {
+        return bidirectional_dijkstra(graph, graph.freeze().transpose(), source, target);
+    }
+}
+
+/**
+ * Contraction hierarchy (Geisberger, Sanders, Schultes and Delling, 2008), to answer many shortest path queries on a static graph.
+ *
+ * Preprocessing contracts the vertices one by one, from the least to the most important: a contracted vertex leaves
+ * the remaining graph, and shortcut edges are added between its neighbors to keep their distances, unless a local
+ * witness search finds another path that is not longer. The next vertex to contract is the one with the smallest
+ * edge difference (shortcuts added minus edges removed) plus number of contracted neighbors, which spreads contraction
+ * evenly over the graph. Priorities are updated lazily: a vertex is only contracted if its recomputed priority is still
+ * the smallest.
+ * A query is a bidirectional Dijkstra search in which both searches only go up to more important vertices,
+ * and do not expand vertices that a more important vertex reaches by a shorter path (stall-on-demand),
+ * so on road networks they settle hundreds of vertices instead of a large part of the graph.
+ * The hierarchy is not updated with the graph, it must be rebuilt after the graph changes.
+ */
+class ContractionHierarchy {
+private:
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    struct Arc {
+        VertexId vertex;
+        double weight;
+        // the contracted vertex a shortcut skips, NO_VERTEX for an edge of the graph
+        VertexId middle;
+    };
+
+    // edges to more important vertices, grouped by vertex
+    struct UpwardGraph {
+        std::vector<size_t> offsets;
+        std::vector<Arc> arcs;
+
+        [[nodiscard]] std::span<const Arc> arcs_of(const VertexId id) const {
+            return std::span(arcs).subspan(offsets[id], offsets[id + 1] - offsets[id]);
+        }
+    };
+
+    // state of the witness searches, reused across searches
+    struct WitnessSearch {
+        std::vector<double> distances;
+        std::vector<VertexId> touched;
+        AddressableMinHeap heap;
+    };
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+
+    static constexpr size_t NO_RANK = std::numeric_limits<size_t>::max();
+    // a witness search gives up after settling this many vertices, and the shortcut is added (which is always correct)
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 500;
+
+    // order of contraction of every id, NO_RANK for ids without a vertex
+    std::vector<size_t> _ranks;
+    // _upward[0] has the outgoing edges of every vertex to more important ones,
+    // _upward[1] the incoming edges from more important ones (with the source in Arc::vertex)
+    std::array<UpwardGraph, 2> _upward;
+    size_t _shortcutCount = 0;
+
+    static void add_arc(std::vector<Arc>& arcs, const VertexId vertex, const double weight, const VertexId middle) {
+        const auto arcIt = std::ranges::find(arcs, vertex, &Arc::vertex);
+        if (arcIt == arcs.end()) {
+            arcs.push_back({vertex, weight, middle});
+        } else if (weight < arcIt->weight) {
+            arcIt->weight = weight;
+            arcIt->middle = middle;
+        }
+    }
+
+    // call found(source, target, weight) for every shortcut the contraction of a vertex needs
+    template <typename F>
+    static void find_shortcuts(const VertexId id, const std::vector<std::vector<Arc>>& out, const std::vector<std::vector<Arc>>& in,
+                               WitnessSearch& witness, F found) {
+        for (const Arc& incoming : in[id]) {
+            const VertexId source = incoming.vertex;
+            double maxOutgoing = -1.0;
+            for (const Arc& outgoing : out[id]) {
+                if (outgoing.vertex != source) {
+                    maxOutgoing = std::max(maxOutgoing, outgoing.weight);
+                }
+            }
+            if (maxOutgoing < 0.0) {
+                continue;
+            }
+
+            // Dijkstra from the source around the contracted vertex, up to the longest path through it
+            const double bound = incoming.weight + maxOutgoing;
+            witness.distances[source] = 0.0;
+            witness.touched.push_back(source);
+            witness.heap.push_or_decrease(source, 0.0);
+            for (size_t settled = 0; !witness.heap.empty() && settled < WITNESS_SETTLE_LIMIT; ++settled) {
+                const auto [distance, vertex] = witness.heap.pop();
+                if (distance > bound) {
+                    break;
+                }
+                for (const Arc& arc : out[vertex]) {
+                    const double newDistance = distance + arc.weight;
+                    if (arc.vertex != id && newDistance < witness.distances[arc.vertex]) {
+                        if (witness.distances[arc.vertex] == std::numeric_limits<double>::infinity()) {
+                            witness.touched.push_back(arc.vertex);
+                        }
+                        witness.distances[arc.vertex] = newDistance;
+                        witness.heap.push_or_decrease(arc.vertex, newDistance);
+                    }
+                }
+            }
+
+            // tentative distances are lengths of actual paths, so they are valid witnesses too
+            for (const Arc& outgoing : out[id]) {
+                const double through = incoming.weight + outgoing.weight;
+                if (outgoing.vertex != source && witness.distances[outgoing.vertex] > through) {
+                    std::invoke(found, source, outgoing.vertex, through);
+                }
+            }
+            for (const VertexId vertex : witness.touched) {
+                witness.distances[vertex] = std::numeric_limits<double>::infinity();
+            }
+            witness.touched.clear();
+            witness.heap.clear();
+        }
+    }
+
+    void build(std::vector<std::vector<Arc>>& out, std::vector<std::vector<Arc>>& in) {
+        const size_t vertexCount = _ranks.size();
+        std::array<std::vector<std::vector<Arc>>, 2> upward{std::vector<std::vector<Arc>>(vertexCount), std::vector<std::vector<Arc>>(vertexCount)};
+        std::vector<size_t> contractedNeighbors(vertexCount);
+        WitnessSearch witness{std::vector<double>(vertexCount, std::numeric_limits<double>::infinity()), {}, AddressableMinHeap(vertexCount)};
+        std::vector<std::tuple<VertexId, VertexId, double>> shortcuts;
+        // fills shortcuts with the ones the contraction of the vertex needs
+        const auto priority = [&](const VertexId id) {
+            shortcuts.clear();
+            find_shortcuts(id, out, in, witness, [&shortcuts](const VertexId source, const VertexId target, const double weight) {
+                shortcuts.emplace_back(source, target, weight);
+            });
+            return static_cast<double>(shortcuts.size() + contractedNeighbors[id]) - static_cast<double>(out[id].size() + in[id].size());
+        };
+
+        AddressableMinHeap queue(vertexCount);
+        for (VertexId id = 0; id < vertexCount; ++id) {
+            if (_ranks[id] != NO_RANK) {
+                queue.push_or_decrease(id, priority(id));
+            }
+        }
+        size_t rank = 0;
+        while (!queue.empty()) {
+            const VertexId id = queue.pop().second;
+            const double newPriority = priority(id);
+            if (!queue.empty() && newPriority > queue.top().first) {
+                queue.push_or_decrease(id, newPriority);
+                continue;
+            }
+
+            _ranks[id] = rank++;
+            // the remaining neighbors are all contracted later, so the remaining edges are the upward ones
+            upward[0][id] = std::move(out[id]);
+            upward[1][id] = std::move(in[id]);
+            for (const Arc& arc : upward[0][id]) {
+                std::erase_if(in[arc.vertex], [id](const Arc& other) {
+                    return other.vertex == id;
+                });
+                ++contractedNeighbors[arc.vertex];
+            }
+            for (const Arc& arc : upward[1][id]) {
+                std::erase_if(out[arc.vertex], [id](const Arc& other) {
+                    return other.vertex == id;
+                });
+                ++contractedNeighbors[arc.vertex];
+            }
+            for (const auto& [source, target, weight] : shortcuts) {
+                add_arc(out[source], target, weight, id);
+                add_arc(in[target], source, weight, id);
+            }
+        }
+
+        for (size_t side = 0; side < 2; ++side) {
+            UpwardGraph& graph = _upward[side];
+            graph.offsets.assign(vertexCount + 1, 0);
+            for (VertexId id = 0; id < vertexCount; ++id) {
+                graph.offsets[id + 1] = graph.offsets[id] + upward[side][id].size();
+                for (const Arc& arc : upward[side][id]) {
+                    graph.arcs.push_back(arc);
+                    _shortcutCount += arc.middle != NO_VERTEX ? 1 : 0;
+                }
+            }
+        }
+    }
+
+    // find the edge between the vertices, which is stored at the less important one
+    [[nodiscard]] const Arc& find_arc(const VertexId source, const VertexId target) const {
+        const bool up = _ranks[source] < _ranks[target];
+        const std::span<const Arc> arcs = _upward[up ? 0 : 1].arcs_of(up ? source : target);
+        return *std::ranges::find(arcs, up ? target : source, &Arc::vertex);
+    }
+
+    // append the vertices of an edge after its source, replacing shortcuts by the edges they skip
+    void unpack(const VertexId source, const VertexId target, std::vector<VertexId>& path) const {
+        std::vector<std::pair<VertexId, VertexId>> stack{{source, target}};
+        while (!stack.empty()) {
+            const auto [from, to] = stack.back();
+            stack.pop_back();
+            const VertexId middle = find_arc(from, to).middle;
+            if (middle == NO_VERTEX) {
+                path.push_back(to);
+            } else {
+                stack.emplace_back(middle, to);
+                stack.emplace_back(from, middle);
+            }
+        }
+    }
+public:
+    /**
+     * Build the contraction hierarchy of a graph, usually a GraphAdjacencyList.
+     *
+     * Self-loops are ignored since they are never on a shortest path.
+     * @throws NegativeEdgeWeightException If a negative edge weight is encountered.
+     * @param graph The graph to build the hierarchy of.
+     */
+    template <NeighborGraph G>
+    explicit ContractionHierarchy(const G& graph) : _ranks(graph.id_bound(), NO_RANK) {
+        const size_t vertexCount = graph.id_bound();
+        std::vector<std::vector<Arc>> out(vertexCount);
+        std::vector<std::vector<Arc>> in(vertexCount);
+        for (VertexId id = 0; id < vertexCount; ++id) {
+            if (!graph.contains_id(id)) {
+                continue;
+            }
+            // the real ranks are set by build()
+            _ranks[id] = 0;
+            graph.for_each_neighbor(id, [&out, &in, id](const VertexId neighbor, const double weight) {
+                if (weight < 0.0) {
+                    throw NegativeEdgeWeightException("negative edge weight");
+                }
+                if (neighbor != id) {
+                    out[id].push_back({neighbor, weight, NO_VERTEX});
+                    in[neighbor].push_back({id, weight, NO_VERTEX});
+                }
+            });
+        }
+        build(out, in);
+    }
+
+    /**
+     * Get the id bound of the hierarchy (the same as the id bound of the graph).
+     * @return The id bound of the hierarchy.
+     */
+    [[nodiscard]] size_t id_bound() const {
+        return _ranks.size();
+    }
+
+    /**
+     * Check if there is a vertex with the given id.
+     * @param id The id to check.
+     * @return true if there is a vertex with the given id, false otherwise.
+     */
+    [[nodiscard]] bool contains_id(const VertexId id) const {
+        return id < _ranks.size() && _ranks[id] != NO_RANK;
+    }
+
+    /**
+     * Get the position of a vertex in the contraction order, the most important vertices come last.
+     * @throws VertexNotFoundException If there is no vertex with the given id.
+     * @param id The id of the vertex.
+     * @return The rank of the vertex, from 0 to the number of vertices - 1.
+     */
+    [[nodiscard]] size_t rank_of(const VertexId id) const {
+        if (!contains_id(id)) {
+            throw VertexNotFoundException("vertex not found");
+        }
+        return _ranks[id];
+    }
+
+    /**
+     * Get the number of shortcuts added by the preprocessing.
+     * @return The number of shortcuts.
+     */
+    [[nodiscard]] size_t shortcut_count() const {
+        return _shortcutCount;
+    }
+
+    /**
+     * Shortest path queries on a contraction hierarchy.
+     *
+     * Holds the state of the searches, which is reset in time proportional to the part of it the previous query used,
+     * so queries do not depend on the size of the graph. The hierarchy can be shared between threads, but each thread
+     * needs its own Query.
+     */
+    class Query {
+    private:
+        const ContractionHierarchy* _hierarchy;
+        // searches[0] goes up from the source, searches[1] up from the target along reversed edges
+        std::array<ShortestPaths, 2> _searches;
+        std::array<AddressableMinHeap, 2> _heaps;
+        std::vector<VertexId> _touched;
+    public:
+        /**
+         * Create the state of the queries on a hierarchy, in O(V).
+         * @param hierarchy The hierarchy to query, which must outlive the Query.
+         */
+        explicit Query(const ContractionHierarchy& hierarchy)
+            : _hierarchy(&hierarchy),
+              _heaps{AddressableMinHeap(hierarchy.id_bound()), AddressableMinHeap(hierarchy.id_bound())} {
+            for (ShortestPaths& search : _searches) {
+                search.distances.assign(hierarchy.id_bound(), std::numeric_limits<double>::infinity());
+                search.predecessors.assign(hierarchy.id_bound(), NO_VERTEX);
+            }
+        }
+
+        /**
+         * Find the shortest path from the source vertex to a target vertex.
+         *
+         * Each search stops once its smallest key reaches the best path found through a vertex settled by both,
+         * then shortcuts on the path are unpacked into edges of the graph.
+         * @throws VertexNotFoundException If the source or the target doesn't exist.
+         * @param source The id of the source vertex.
+         * @param target The id of the target vertex.
+         * @return The shortest path and the number of vertices settled by both searches.
+         */
+        [[nodiscard]] PointToPointPath shortest_path(const VertexId source, const VertexId target) {
+            if (!_hierarchy->contains_id(source)) {
+                throw VertexNotFoundException("source not found");
+            }
+            if (!_hierarchy->contains_id(target)) {
+                throw VertexNotFoundException("target not found");
+            }
+            for (const VertexId id : _touched) {
+                for (ShortestPaths& search : _searches) {
+                    search.distances[id] = std::numeric_limits<double>::infinity();
+                    search.predecessors[id] = NO_VERTEX;
+                }
+            }
+            _touched.assign({source, target});
+            for (AddressableMinHeap& heap : _heaps) {
+                heap.clear();
+            }
+            _searches[0].distances[source] = 0.0;
+            _searches[1].distances[target] = 0.0;
+            _heaps[0].push_or_decrease(source, 0.0);
+            _heaps[1].push_or_decrease(target, 0.0);
+
+            PointToPointPath path;
+            VertexId meeting = NO_VERTEX;
+            while (true) {
+                const bool forward = !_heaps[0].empty() && _heaps[0].top().first < path.distance;
+                const bool backward = !_heaps[1].empty() && _heaps[1].top().first < path.distance;
+                if (!forward && !backward) {
+                    break;
+                }
+                const size_t side = forward && (!backward || _heaps[0].top().first <= _heaps[1].top().first) ? 0 : 1;
+                ShortestPaths& search = _searches[side];
+                const auto [distance, id] = _heaps[side].pop();
+                ++path.settled;
+                if (distance + _searches[1 - side].distances[id] < path.distance) {
+                    path.distance = distance + _searches[1 - side].distances[id];
+                    meeting = id;
+                }
+                // stall on demand: if a more important vertex reaches this one by a shorter path, that path is not a shortest one
+                // from below, so the search does not need to go on from here
+                const auto stalls = [&search, distance](const Arc& arc) {
+                    return search.distances[arc.vertex] + arc.weight < distance;
+                };
+                if (std::ranges::any_of(_hierarchy->_upward[1 - side].arcs_of(id), stalls)) {
+                    continue;
+                }
+                for (const Arc& arc : _hierarchy->_upward[side].arcs_of(id)) {
+                    const double newDistance = distance + arc.weight;
+                    if (newDistance < search.distances[arc.vertex]) {
+                        search.distances[arc.vertex] = newDistance;
+                        search.predecessors[arc.vertex] = id;
+                        _touched.push_back(arc.vertex);
+                        _heaps[side].push_or_decrease(arc.vertex, newDistance);
+                    }
+                }
+            }
+
+            if (meeting != NO_VERTEX) {
+                std::vector<VertexId> upPath = reconstruct_path(_searches[0], meeting);
+                for (VertexId id = _searches[1].predecessors[meeting]; id != NO_VERTEX; id = _searches[1].predecessors[id]) {
+                    upPath.push_back(id);
+                }
+                path.vertices.push_back(source);
+                for (size_t i = 0; i + 1 < upPath.size(); ++i) {
+                    _hierarchy->unpack(upPath[i], upPath[i + 1], path.vertices);
+                }
+            }
+            return path;
+        }
+    };
+};
+
+/**
+ * Distance of the vertices a breadth-first search does not reach.
+ */
+inline constexpr size_t UNREACHABLE = std::numeric_limits<size_t>::max();
+
+/**
+ * Result of a breadth-first search.
+ *
+ * Both vectors are indexed by vertex id (their size is the id bound of the graph).
+ * Distances are numbers of edges. Unreachable vertices have a distance of UNREACHABLE
+ * and no parent (NO_VERTEX), the source has a distance of 0 and no parent.
+ */
+struct BreadthFirstTree {
+    std::vector<size_t> distances;
+    std::vector<VertexId> parents;
+};
+
+/**
+ * Parallel direction-optimizing breadth-first search (Beamer, Asanovic and Patterson, 2012).
+ *
+ * Levels with a small frontier are expanded top-down: the frontier vertices claim their unvisited
+ * neighbors with a compare-and-swap. Once the frontier has more outgoing edges than the unvisited part
+ * of the graph (divided by alpha), levels are expanded bottom-up: every unvisited vertex looks for a parent
+ * among its incoming edges in a bitmap of the frontier, and stops at the first one. This skips most edges
+ * of the large middle levels of low-diameter graphs. The search goes back to top-down steps when the
+ * frontier shrinks below the number of vertices divided by beta.
+ * @throws VertexNotFoundException If there is no vertex with the id of the source.
+ * @param graph The graph to search.
+ * @param transpose The transpose of the graph (graph.transpose()), used by the bottom-up steps.
+ * @param source The id of the vertex to start from.
+ * @param threadCount The number of threads to use, 0 for one per hardware thread.
+ * @return The distances and parents of the vertices.
+ */
+template <typename T, typename W>
+BreadthFirstTree direction_optimizing_bfs(const GraphCSR<T, W>& graph, const GraphCSR<T, W>& transpose, const VertexId source, const size_t threadCount = 0) {
+    constexpr size_t alpha = 15;
+    constexpr size_t beta = 18;
+    constexpr size_t wordBits = 64;
+
+    if (!graph.contains_id(source)) {
+        throw VertexNotFoundException("source not found");
+    }
+    const size_t threads = resolve_thread_count(threadCount);
+    const size_t vertexCount = graph.id_bound();
+    const size_t wordCount = (vertexCount + wordBits - 1) / wordBits;
+
+    BreadthFirstTree tree{std::vector<size_t>(vertexCount, UNREACHABLE), std::vector<VertexId>(vertexCount, NO_VERTEX)};
+    tree.distances[source] = 0;
+
+    std::vector<VertexId> frontier{source};
+    std::vector<std::vector<VertexId>> nextFrontiers(threads);
+    std::vector<std::uint64_t> frontierBits(wordCount);
+    std::vector<std::uint64_t> nextBits(wordCount);
+    std::vector<size_t> counts(threads);
+
+    // expand the frontier queue into the next one, returning the number of edges of the next frontier
+    const auto topDownStep = [&](const size_t level) {
+        // fewer blocks than threads run if the frontier is small, so the slots of the others are cleared too
+        for (std::vector<VertexId>& next : nextFrontiers) {
+            next.clear();
+        }
+        std::ranges::fill(counts, 0);
+        parallel_blocks(frontier.size(), threads, [&](const size_t thread, const size_t first, const size_t last) {
+            std::vector<VertexId>& next = nextFrontiers[thread];
+            size_t scoutCount = 0;
+            for (size_t i = first; i < last; ++i) {
+                const VertexId id = frontier[i];
+                for (const VertexId neighbor : graph.neighbor_ids(id)) {
+                    std::atomic_ref<size_t> distance(tree.distances[neighbor]);
+                    size_t unreached = UNREACHABLE;
+                    if (distance.load(std::memory_order_relaxed) == UNREACHABLE &&
+                        distance.compare_exchange_strong(unreached, level + 1, std::memory_order_relaxed)) {
+                        tree.parents[neighbor] = id;
+                        next.push_back(neighbor);
+                        scoutCount += graph.degree(neighbor);
+                    }
+                }
+            }
+            counts[thread] = scoutCount;
+        });
+        frontier.clear();
+        for (const std::vector<VertexId>& next : nextFrontiers) {
+            frontier.insert(frontier.end(), next.begin(), next.end());
+        }
+        return std::reduce(counts.begin(), counts.end());
+    };
+
+    // find the parents of the next frontier in the frontier bitmap, returning the size of the next frontier
+    const auto bottomUpStep = [&](const size_t level) {
+        std::ranges::fill(counts, 0);
+        parallel_blocks(wordCount, threads, [&](const size_t thread, const size_t firstWord, const size_t lastWord) {
+            size_t awakeCount = 0;
+            for (size_t word = firstWord; word < lastWord; ++word) {
+                std::uint64_t bits = 0;
+                const size_t end = std::min(vertexCount, (word + 1) * wordBits);
+                for (VertexId id = word * wordBits; id < end; ++id) {
+                    if (tree.distances[id] != UNREACHABLE || !transpose.contains_id(id)) {
+                        continue;
+                    }
+                    for (const VertexId parent : transpose.neighbor_ids(id)) {
+                        if (((frontierBits[parent / wordBits] >> (parent % wordBits)) & 1U) != 0) {
+                            tree.distances[id] = level + 1;
+                            tree.parents[id] = parent;
+                            bits |= std::uint64_t{1} << (id % wordBits);
+                            ++awakeCount;
+                            break;
+                        }
+                    }
+                }
+                nextBits[word] = bits;
+            }
+            counts[thread] = awakeCount;
+        });
+        std::swap(frontierBits, nextBits);
+        return std::reduce(counts.begin(), counts.end());
+    };
+
+    size_t edgesToCheck = graph.edge_count();
+    size_t scoutCount = graph.degree(source);
+    size_t level = 0;
+    while (!frontier.empty()) {
+        if (scoutCount > edgesToCheck / alpha) {
+            std::ranges::fill(frontierBits, 0);
+            for (const VertexId id : frontier) {
+                frontierBits[id / wordBits] |= std::uint64_t{1} << (id % wordBits);
+            }
+            size_t awakeCount = frontier.size();
+            size_t oldAwakeCount = 0;
+            do {
+                oldAwakeCount = awakeCount;
+                awakeCount = bottomUpStep(level++);
+            } while (awakeCount >= oldAwakeCount || awakeCount > vertexCount / beta);
+
+            frontier.clear();
+            for (size_t word = 0; word < wordCount; ++word) {
+                for (std::uint64_t bits = frontierBits[word]; bits != 0; bits &= bits - 1) {
+                    frontier.push_back(word * wordBits + static_cast<size_t>(std::countr_zero(bits)));
+                }
+            }
+            scoutCount = 1;
+        } else {
+            edgesToCheck -= std::min(scoutCount, edgesToCheck);
+            scoutCount = topDownStep(level++);
+        }
+    }
+    return tree;
+}
+
+/**
+ * Parallel direction-optimizing breadth-first search, see above.
+ *
+ * Builds the transpose of the graph first, pass it explicitly to reuse it across searches.
+ * @throws VertexNotFoundException If there is no vertex with the id of the source.
+ * @param graph The graph to search.
+ * @param source The id of the vertex to start from.
+ * @param threadCount The number of threads to use, 0 for one per hardware thread.
+ * @return The distances and parents of the vertices.
+ */
+template <typename T, typename W>
+BreadthFirstTree direction_optimizing_bfs(const GraphCSR<T, W>& graph, const VertexId source, const size_t threadCount = 0) {
+    return direction_optimizing_bfs(graph, graph.transpose(), source, threadCount);
+}
+
+/**
+ * Result of a PageRank computation.
+ *
+ * Ranks are indexed by vertex id (the size is the id bound of the graph) and sum to 1,
+ * ids without a vertex have a rank of 0.
+ */
+struct PageRanks {
+    std::vector<double> ranks;
+    // number of iterations done
+    size_t iterations = 0;
+    // sum of the absolute changes of the ranks during the last iteration
+    double residual = 0.0;
+    // true if the residual fell below the tolerance within the iteration limit
+    bool converged = false;
+    // number of edges processed by every iteration
+    size_t edges = 0;
+    // time spent on every iteration
+    std::vector<double> seconds;
+
+    /**
+     * Get the throughput of an iteration.
+     * @param iteration The index of the iteration, smaller than iterations.
+     * @return The number of edges processed per second during the iteration.
+     */
+    [[nodiscard]] double edges_per_second(const size_t iteration) const {
+        return seconds[iteration] > 0.0 ? static_cast<double>(edges) / seconds[iteration] : 0.0;
+    }
+
+    /**
+     * Get the average throughput of all iterations.
+     * @return The number of edges processed per second.
+     */
+    [[nodiscard]] double edges_per_second() const {
+        const double total = std::reduce(seconds.begin(), seconds.end());
+        return total > 0.0 ? static_cast<double>(edges * iterations) / total : 0.0;
+    }
+};
+
+/**
+ * Parallel pull-based PageRank by power iteration.
+ *
+ * Every iteration divides the rank of each vertex between its outgoing edges, then every vertex
+ * sums the shares of its incoming edges with GraphCSR::multiply() on the transpose. Each rank is only
+ * written by the thread that owns the vertex, so no atomics or locks are needed. The rank of dangling vertices
+ * (without outgoing edges) is spread evenly over all vertices, so the ranks keep summing to 1.
+ * Edge weights are ignored.
+ * @param graph The graph to rank.
+ * @param transpose The transpose of the graph (graph.transpose()).
+ * @param damping The probability of following an edge rather than jumping to a random vertex.
+ * @param tolerance Stop when the ranks change by less than this in total (L1 norm) during an iteration.
+ * @param maxIterations Stop after this many iterations, even if the ranks have not converged.
+ * @param threadCount The number of threads to use, 0 for one per hardware thread.
+ * @return The ranks of the vertices, with convergence and throughput statistics.
+ */
+template <typename T, typename W>
+PageRanks pagerank(const GraphCSR<T, W>& graph, const GraphCSR<T, W>& transpose, const double damping = 0.85, const double tolerance = 1e-6,
+                   const size_t maxIterations = 100, const size_t threadCount = 0) {
+    const size_t threads = resolve_thread_count(threadCount);
+    const size_t vertexCount = graph.id_bound();
+    PageRanks result{std::vector<double>(vertexCount), 0, 0.0, false, graph.edge_count(), {}};
+    if (graph.empty()) {
+        result.converged = true;
+        return result;
+    }
+
+    // the share of its rank a vertex gives to each outgoing edge is rank / degree, 0 if it has none
+    const double initialRank = 1.0 / static_cast<double>(graph.size());
+    std::vector<double> inverseDegrees(vertexCount);
+    std::vector<double> contributions(vertexCount);
+    std::vector<double> sums(vertexCount);
+    double danglingRank = 0.0;
+    for (VertexId id = 0; id < vertexCount; ++id) {
+        if (graph.contains_id(id)) {
+            result.ranks[id] = initialRank;
+            if (graph.degree(id) == 0) {
+                danglingRank += initialRank;
+            } else {
+                inverseDegrees[id] = 1.0 / static_cast<double>(graph.degree(id));
+                contributions[id] = initialRank * inverseDegrees[id];
+            }
+        }
+    }
+
+    std::vector<double> residuals(threads);
+    std::vector<double> danglingRanks(threads);
+    while (result.iterations < maxIterations) {
+        const auto start = std::chrono::steady_clock::now();
+        transpose.multiply(contributions, sums, threads, [](double) {
+            return 1.0;
+        });
+        const double base = (1.0 - damping + damping * danglingRank) / static_cast<double>(graph.size());
+
+        // update the ranks, and compute the contributions of the next iteration in the same pass
+        parallel_blocks(vertexCount, threads, [&](const size_t thread, const size_t first, const size_t last) {
+            double residual = 0.0;
+            double dangling = 0.0;
+            for (VertexId id = first; id < last; ++id) {
+                if (!graph.contains_id(id)) {
+                    continue;
+                }
+                const double rank = base + damping * sums[id];
+                residual += std::abs(rank - result.ranks[id]);
+                result.ranks[id] = rank;
+                contributions[id] = rank * inverseDegrees[id];
+                if (inverseDegrees[id] == 0.0) {
+                    dangling += rank;
+                }
+            }
+            residuals[thread] = residual;
+            danglingRanks[thread] = dangling;
+        });
+        result.residual = std::reduce(residuals.begin(), residuals.end());
+        danglingRank = std::reduce(danglingRanks.begin(), danglingRanks.end());
+        result.seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        ++result.iterations;
+        if (result.residual < tolerance) {
+            result.converged = true;
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ * Parallel pull-based PageRank, see above.
+ *
+ * Builds the transpose of the graph first, pass it explicitly to reuse it across computations.
+ * @param graph The graph to rank.
+ * @param damping The probability of following an edge rather than jumping to a random vertex.
+ * @param tolerance Stop when the ranks change by less than this in total (L1 norm) during an iteration.
+ * @param maxIterations Stop after this many iterations, even if the ranks have not converged.
+ * @param threadCount The number of threads to use, 0 for one per hardware thread.
+ * @return The ranks of the vertices, with convergence and throughput statistics.
+ */
+template <typename T, typename W>
+PageRanks pagerank(const GraphCSR<T, W>& graph, const double damping = 0.85, const double tolerance = 1e-6, const size_t maxIterations = 100,
+                   const size_t threadCount = 0) {
+    return pagerank(graph, graph.transpose(), damping, tolerance, maxIterations, threadCount);
+}
+
+/**
+ * Result of an all-pairs shortest path search.
+ *
+ * Both vectors are size x size matrices stored row by row, indexed by vertex id (size is the id bound of the graph).
+ * If there is no path from i to j, the distance is infinite and the next id is NO_VERTEX.
+ * The distance from a vertex to itself is 0, unless it is on a negative cycle.
+ */
+struct AllPairsShortestPaths {
+    size_t size = 0;
+    // distances[i * size + j] is the length of a shortest path from i to j
+    std::vector<double> distances;
+    // next[i * size + j] is the id after i on a shortest path from i to j (j itself for an edge, i if i == j)
+    std::vector<VertexId> next;
+
+    /**
+     * Get the length of a shortest path.
+     * @param source The id of the first vertex of the path.
+     * @param target The id of the last vertex of the path.
+     * @return The length of the path, infinity if there is none.
+     */
+    [[nodiscard]] double distance(const VertexId source, const VertexId target) const {
+        return distances[source * size + target];
+    }
+};
+
+/**
+ * Find the shortest paths between all pairs of vertices using the Floyd-Warshall algorithm, in O(V^3).
+ *
+ * Negative weights are allowed. The distance matrix is processed in square tiles that fit in the cache
+ * (blocked Floyd-Warshall, Venkataraman et al., 2003): for every diagonal tile, the tile is closed first,
+ * then the other tiles of its row and column, then all the remaining tiles, which only read those.
+ * The tiles of the last two steps are independent, so they are split between the threads.
+ * The inner loops are branchless min-plus updates over contiguous rows, so the compiler can vectorize them
+ * (GCC does with -O3 on targets with 64-bit vector blends, such as -mavx2).
+ * Weighted adjacency matrices are read row by row (presence bits and weights), other graphs edge by edge.
+ * @param graph The graph.
+ * @param threadCount The number of threads to use, 0 for one per hardware thread.
+ * @return The distances between all pairs of vertices and the matrix to reconstruct the paths.
+ */
+template <NeighborGraph G>
+AllPairsShortestPaths floyd_warshall(const G& graph, const size_t threadCount = 0) {
+    // 64 x 64 doubles: the three tiles an update reads fit in the L2 cache, and a row of a tile in a few cache lines
+    constexpr size_t tileSize = 64;
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+
+    const size_t threads = resolve_thread_count(threadCount);
+    const size_t size = graph.id_bound();
+    AllPairsShortestPaths paths{size, std::vector<double>(size * size, infinity), std::vector<VertexId>(size * size, NO_VERTEX)};
+    double* distances = paths.distances.data();
+    VertexId* next = paths.next.data();
+    for (VertexId id = 0; id < size; ++id) {
+        if (!graph.contains_id(id)) {
+            continue;
+        }
+        double* row = distances + id * size;
+        VertexId* nextRow = next + id * size;
+        if constexpr (requires { graph.neighbor_bits(id); graph.weight_row(id); }) {
+            const std::span<const std::uint64_t> bits = graph.neighbor_bits(id);
+            const auto weights = graph.weight_row(id);
+            for (size_t word = 0; word < bits.size(); ++word) {
+                for (std::uint64_t remaining = bits[word]; remaining != 0; remaining &= remaining - 1) {
+                    const VertexId target = (word * 64) + static_cast<size_t>(std::countr_zero(remaining));
+                    row[target] = static_cast<double>(weights[target]);
+                    nextRow[target] = target;
+                }
+            }
+        } else {
+            graph.for_each_neighbor(id, [row, nextRow](const VertexId target, const double weight) {
+                row[target] = weight;
+                nextRow[target] = target;
+            });
+        }
+        row[id] = std::min(row[id], 0.0);
+        nextRow[id] = id;
+    }
+
+    // relax the paths from rows [firstRow, lastRow) to columns [firstColumn, lastColumn) through ids [firstK, lastK)
+    const auto relaxTile = [distances, next, size](const size_t firstK, const size_t lastK, const size_t firstRow, const size_t lastRow,
+                                                   const size_t firstColumn, const size_t lastColumn) {
+        // a copy of the part of row k in the tile, which the compiler knows is not aliased by the rows it updates
+        std::array<double, tileSize> rowK{};
+        for (size_t k = firstK; k < lastK; ++k) {
+            std::copy(distances + k * size + firstColumn, distances + k * size + lastColumn, rowK.begin());
+            for (size_t i = firstRow; i < lastRow; ++i) {
+                const double distanceIK = distances[i * size + k];
+                if (distanceIK == infinity) {
+                    continue;
+                }
+                const VertexId nextIK = next[i * size + k];
+                double* rowI = distances + i * size + firstColumn;
+                VertexId* nextI = next + i * size + firstColumn;
+                for (size_t j = 0; j < lastColumn - firstColumn; ++j) {
+                    // select with a mask instead of a branch, so the loop vectorizes
+                    const double candidate = distanceIK + rowK[j];
+                    const VertexId shorter = VertexId{0} - static_cast<VertexId>(candidate < rowI[j]);
+                    rowI[j] = std::min(candidate, rowI[j]);
+                    nextI[j] = (nextIK & shorter) | (nextI[j] & ~shorter);
+                }
+            }
+        }
+    };
+
+    const size_t tileCount = (size + tileSize - 1) / tileSize;
+    const auto tileStart = [size](const size_t tile) {
+        return std::min(tile * tileSize, size);
+    };
+    std::vector<std::pair<size_t, size_t>> tiles;
+    for (size_t tileK = 0; tileK < tileCount; ++tileK) {
+        const size_t firstK = tileStart(tileK);
+        const size_t lastK = tileStart(tileK + 1);
+        relaxTile(firstK, lastK, firstK, lastK, firstK, lastK);
+
+        // the other tiles of the row and the column of the diagonal tile
+        tiles.clear();
+        for (size_t tile = 0; tile < tileCount; ++tile) {
+            if (tile != tileK) {
+                tiles.emplace_back(tileK, tile);
+                tiles.emplace_back(tile, tileK);
+            }
+        }
+        const auto relaxTiles = [&](size_t, const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                relaxTile(firstK, lastK, tileStart(tiles[i].first), tileStart(tiles[i].first + 1), tileStart(tiles[i].second),
+                          tileStart(tiles[i].second + 1));
+            }
+        };
+        parallel_blocks(tiles.size(), threads, relaxTiles);
+
+        // all the other tiles
+        tiles.clear();
+        for (size_t tileI = 0; tileI < tileCount; ++tileI) {
+            for (size_t tileJ = 0; tileJ < tileCount; ++tileJ) {
+                if (tileI != tileK && tileJ != tileK) {
+                    tiles.emplace_back(tileI, tileJ);
+                }
+            }
+        }
+        parallel_blocks(tiles.size(), threads, relaxTiles);
+    }
+    return paths;
+}
+
+/**
+ * Reconstruct a shortest path found by an all-pairs shortest path search.
+ * @param paths The result of the search.
+ * @param source The id of the first vertex of the path.
+ * @param target The id of the last vertex of the path.
+ * @return The ids of the vertices on the path from the source to the target (both included),
+ * or an empty vector if there is no path or it goes through a negative cycle.
+ */
+inline std::vector<VertexId> reconstruct_path(const AllPairsShortestPaths& paths, VertexId source, const VertexId target) {
+    std::vector<VertexId> path;
+    if (source >= paths.size || target >= paths.size || paths.next[source * paths.size + target] == NO_VERTEX) {
+        return path;
+    }
+    path.push_back(source);
+    while (source != target) {
+        source = paths.next[source * paths.size + target];
+        path.push_back(source);
+        if (path.size() > paths.size) {
+            return {};
+        }
+    }
+    return path;
+}
+
+/**
+ * Disjoint sets of ids (union-find), which several threads can use at once.
+ *
+ * Every set is a tree of ids whose root is the smallest id of the set. find() halves the path it walks
+ * (every id on it is pointed to its grandparent), and unite() links the larger root under the smaller one
+ * with a compare-and-swap, retrying if another thread linked one of the roots first. No locks are taken.
+ */
+class UnionFind {
+private:
+    std::vector<VertexId> _parents;
+
+    [[nodiscard]] VertexId parent(const VertexId id) {
+        return std::atomic_ref<VertexId>(_parents[id]).load(std::memory_order_acquire);
+    }
+public:
+    /**
+     * Create sets of one id each.
+     * @param size The number of ids (0 to size - 1).
+     */
+    explicit UnionFind(const size_t size = 0) : _parents(size) {
+        std::iota(_parents.begin(), _parents.end(), VertexId{0});
+    }
+
+    /**
+     * Get the number of ids.
+     * @return The number of ids.
+     */
+    [[nodiscard]] size_t size() const {
+        return _parents.size();
+    }
+
+    /**
+     * Find the root (smallest id) of the set of an id.
+     * @param id The id, smaller than size().
+     * @return The root of the set.
+     */
+    VertexId find(VertexId id) {
+        while (true) {
+            VertexId idParent = parent(id);
+            const VertexId grandparent = parent(idParent);
+            if (idParent == grandparent) {
+                return idParent;
+            }
+            // the grandparent is still an ancestor, even if another thread changed the parent meanwhile
+            std::atomic_ref<VertexId>(_parents[id]).compare_exchange_weak(idParent, grandparent, std::memory_order_acq_rel);
+            id = grandparent;
+        }
+    }
+
+    /**
+     * Merge the sets of two ids.
+     * @param id1 The first id, smaller than size().
+     * @param id2 The second id, smaller than size().
+     * @return true if the sets were merged, false if the ids were already in the same set.
+     */
+    bool unite(const VertexId id1, const VertexId id2) {
+        VertexId root1 = id1;
+        VertexId root2 = id2;
+        while (true) {
+            root1 = find(root1);
+            root2 = find(root2);
+            if (root1 == root2) {
+                return false;
+            }
+            if (root1 < root2) {
+                std::swap(root1, root2);
+            }
+            // fails if another thread linked root1 first, in which case the new roots are looked up again
+            VertexId expected = root1;
+            if (std::atomic_ref<VertexId>(_parents[root1]).compare_exchange_strong(expected, root2, std::memory_order_acq_rel)) {
+                return true;
+            }
+        }
+    }
+};
+
+/**
+ * Id of the component of the ids that have no vertex.
+ */
+inline constexpr size_t NO_COMPONENT = std::numeric_limits<size_t>::max();
+
+/**
+ * Result of a connected components search.
+ *
+ * Components are numbered densely (0 to count - 1), in an order that depends on the search.
+ * The labels are indexed by vertex id (their size is the id bound of the graph),
+ * ids that have no vertex are labeled NO_COMPONENT.
+ */
+struct Components {
+    std::vector<size_t> labels;
+    size_t count = 0;
+};
+
+/**
+ * Find the weakly connected components of a graph (edges are followed in both directions), in parallel.
+ *
+ * Every thread unites the endpoints of the edges of a block of vertices in a shared lock-free union-find,
+ * then the roots are numbered and every vertex is labeled with the number of its root.
+ * Components are numbered in the order of their smallest vertex id.
+ * The graph must not be modified during the search.
+ * @param graph The graph.
+ * @param threadCount The number of threads to use, 0 for one per hardware thread.
+ * @return The component of every vertex and the number of components.
+ */
+template <NeighborGraph G>
+Components connected_components(const G& graph, const size_t threadCount = 0) {
+    const size_t threads = resolve_thread_count(threadCount);
+    const size_t vertexCount = graph.id_bound();
+    UnionFind sets(vertexCount);
+    parallel_blocks(vertexCount, threads, [&](size_t, const size_t first, const size_t last) {
+        for (VertexId id = first; id < last; ++id) {
+            if (graph.contains_id(id)) {
+                graph.for_each_neighbor(id, [&sets, id](const VertexId neighbor, double) {
+                    sets.unite(id, neighbor);
+                });
+            }
+        }
+    });
+
+    // roots are the smallest ids of their sets, so numbering them in order of id numbers the components by their smallest id
+    Components components{std::vector<size_t>(vertexCount, NO_COMPONENT), 0};
+    for (VertexId id = 0; id < vertexCount; ++id) {
+        if (graph.contains_id(id) && sets.find(id) == id) {
+            components.labels[id] = components.count++;
+        }
+    }
+    parallel_blocks(vertexCount, threads, [&](size_t, const size_t first, const size_t last) {
+        for (VertexId id = first; id < last; ++id) {
+            if (const VertexId root = sets.find(id); graph.contains_id(id) && root != id) {
+                components.labels[id] = components.labels[root];
+            }
+        }
+    });
+    return components;
+}
+
+/**
+ * Find the strongly connected components of a graph with Tarjan's algorithm, in O(V + E).
+ *
+ * The depth-first search keeps its own stack of (vertex, next edge) frames instead of recursing,
+ * so the depth of the graph is only limited by memory, and all its state is in arrays indexed by id.
+ * The outgoing edges of every vertex are first copied into flat arrays so that the search can stop
+ * in the middle of the edges of a vertex and resume later (a GraphCSR is used as is).
+ * Components are numbered in topological order: every edge goes from a component to itself or to a higher numbered one.
+ * @param graph The graph.
+ * @return The component of every vertex and the number of components.
+ */
+template <NeighborGraph G>
+Components strongly_connected_components(const G& graph) {
+    const size_t vertexCount = graph.id_bound();
+    std::vector<size_t> offsets;
+    std::vector<VertexId> targets;
+    if constexpr (!requires { graph.neighbor_ids(VertexId{}); }) {
+        offsets.assign(vertexCount + 1, 0);
+        for (VertexId id = 0; id < vertexCount; ++id) {
+            if (graph.contains_id(id)) {
+                graph.for_each_neighbor(id, [&targets](const VertexId neighbor, double) {
+                    targets.push_back(neighbor);
+                });
+            }
+            offsets[id + 1] = targets.size();
+        }
+    }
+    const auto neighbors = [&](const VertexId id) -> std::span<const VertexId> {
+        if constexpr (requires { graph.neighbor_ids(id); }) {
+            return graph.neighbor_ids(id);
+        } else {
+            return std::span(targets).subspan(offsets[id], offsets[id + 1] - offsets[id]);
+        }
+    };
+
+    constexpr size_t unvisited = std::numeric_limits<size_t>::max();
+    // order of discovery, and smallest order reachable through the subtree and one edge to a vertex still on the stack
+    std::vector<size_t> orders(vertexCount, unvisited);
+    std::vector<size_t> lowLinks(vertexCount);
+    Components components{std::vector<size_t>(vertexCount, NO_COMPONENT), 0};
+    // vertices visited but not yet assigned to a component
+    std::vector<VertexId> pending;
+    std::vector<std::pair<VertexId, size_t>> frames;
+    size_t order = 0;
+    for (VertexId root = 0; root < vertexCount; ++root) {
+        if (!graph.contains_id(root) || orders[root] != unvisited) {
+            continue;
+        }
+        orders[root] = lowLinks[root] = order++;
+        pending.push_back(root);
+        frames.emplace_back(root, 0);
+        while (!frames.empty()) {
+            auto& [id, edge] = frames.back();
+            const std::span<const VertexId> edges = neighbors(id);
+            if (edge < edges.size()) {
+                const VertexId neighbor = edges[edge++];
+                if (orders[neighbor] == unvisited) {
+                    orders[neighbor] = lowLinks[neighbor] = order++;
+                    pending.push_back(neighbor);
+                    // invalidates id and edge
+                    frames.emplace_back(neighbor, 0);
+                } else if (components.labels[neighbor] == NO_COMPONENT) {
+                    lowLinks[id] = std::min(lowLinks[id], orders[neighbor]);
+                }
+                continue;
+            }
+
+            const VertexId finished = id;
+            frames.pop_back();
+            if (lowLinks[finished] == orders[finished]) {
+                VertexId member = NO_VERTEX;
+                do {
+                    member = pending.back();
+                    pending.pop_back();
+                    components.labels[member] = components.count;
+                } while (member != finished);
+                ++components.count;
+            }
+            if (!frames.empty()) {
+                const VertexId parent = frames.back().first;
+                lowLinks[parent] = std::min(lowLinks[parent], lowLinks[finished]);
+            }
+        }
+    }
+
+    // Tarjan's algorithm completes a component after all the components it has edges to
+    for (size_t& label : components.labels) {
+        if (label != NO_COMPONENT) {
+            label = components.count - 1 - label;
+        }
+    }
+    return components;
+}
+
+/**
+ * Sort the vertices of a graph topologically with Kahn's algorithm, in O(V + E).
+ *
+ * Vertices without incoming edges are output first, and removing the edges of an output vertex
+ * makes its neighbors without other incoming edges ready. Ready vertices are output in the order they
+ * became ready, starting with the initial ones in increasing order of id. All the state is in arrays indexed by id.
+ * @param graph The graph.
+ * @return The ids of the vertices, such that every edge goes from a vertex to a later one,
+ *         or no value if the graph has a cycle (including a self-loop).
+ */
+template <NeighborGraph G>
+std::optional<std::vector<VertexId>> topological_sort(const G& graph) {
+    const size_t vertexCount = graph.id_bound();
+    std::vector<size_t> inDegrees(vertexCount);
+    for (VertexId id = 0; id < vertexCount; ++id) {
+        if (graph.contains_id(id)) {
+            graph.for_each_neighbor(id, [&inDegrees](const VertexId neighbor, double) {
+                ++inDegrees[neighbor];
+            });
+        }
+    }
+
+    // the output doubles as the queue of ready vertices
+    std::vector<VertexId> order;
+    order.reserve(graph.size());
+    for (VertexId id = 0; id < vertexCount; ++id) {
+        if (graph.contains_id(id) && inDegrees[id] == 0) {
+            order.push_back(id);
+        }
+    }
+    for (size_t head = 0; head < order.size(); ++head) {
+        graph.for_each_neighbor(order[head], [&inDegrees, &order](const VertexId neighbor, double) {
+            if (--inDegrees[neighbor] == 0) {
+                order.push_back(neighbor);
+            }
+        });
+    }
+    if (order.size() != graph.size()) {
+        return std::nullopt;
+    }
+    return order;
+}
+
+/**
+ * Get all the edges of a graph as a list, in parallel.
+ *
+ * Edges are listed by source in increasing order of id, and in the order of for_each_neighbor() for each source.
+ * @param graph The graph.
+ * @param threadCount The number of threads to use, 0 for one per hardware thread.
+ * @return The ids of the endpoints and the weight of every edge.
+ */
+template <NeighborGraph G>
+std::vector<Edge<VertexId>> edge_list(const G& graph, const size_t threadCount = 0) {
+    const size_t threads = resolve_thread_count(threadCount);
+    std::vector<std::vector<Edge<VertexId>>> blocks(threads);
+    parallel_blocks(graph.id_bound(), threads, [&](const size_t thread, const size_t first, const size_t last) {
+        for (VertexId id = first; id < last; ++id) {
+            if (graph.contains_id(id)) {
+                graph.for_each_neighbor(id, [&block = blocks[thread], id](const VertexId neighbor, const double weight) {
+                    block.push_back({id, neighbor, weight});
+                });
+            }
+        }
+    });
+    std::vector<Edge<VertexId>> edges;
+    edges.reserve(std::transform_reduce(blocks.begin(), blocks.end(), size_t{0}, std::plus{}, [](const auto& block) {
+        return block.size();
+    }));
+    for (const std::vector<Edge<VertexId>>& block : blocks) {
+        edges.insert(edges.end(), block.begin(), block.end());
+    }
+    return edges;
+}
+
+/**
+ * Result of a minimum spanning forest search.
+ */
+struct SpanningForest {
+    // edges of the forest, as ids of their endpoints and weights
+    std::vector<Edge<VertexId>> edges;
+    // sum of the weights of the edges
+    double weight = 0.0;
+};
+
+/**
+ * Find a minimum spanning forest of a graph with Kruskal's algorithm, with a parallel sort.
+ *
+ * Edges are treated as undirected: an edge in either direction links two vertices. The forest has a minimum spanning tree
+ * for every (weakly) connected component of the graph. Edges are sorted by weight with parallel_stable_sort(),
+ * then added in that order unless they would close a cycle, which a union-find detects.
+ * Self-loops are ignored.
+ * @param graph The graph.
+ * @param threadCount The number of threads to use, 0 for one per hardware thread.
+ * @return The edges of the forest, in increasing order of weight, and their total weight.
+ */
+template <NeighborGraph G>
+SpanningForest kruskal(const G& graph, const size_t threadCount = 0) {
+    const size_t threads = resolve_thread_count(threadCount);
+    std::vector<Edge<VertexId>> edges = edge_list(graph, threads);
+    parallel_stable_sort(edges.begin(), edges.end(), [](const Edge<VertexId>& edge1, const Edge<VertexId>& edge2) {
+        return edge1.weight < edge2.weight;
+    }, threads);
+
+    SpanningForest forest;
+    UnionFind sets(graph.id_bound());
+    for (const Edge<VertexId>& edge : edges) {
+        if (sets.unite(edge.source, edge.target)) {
+            forest.edges.push_back(edge);
+            forest.weight += edge.weight;
+        }
+    }
+    return forest;
+}
+
+/**
+ * Find a minimum spanning forest of a graph with Borůvka's algorithm, in parallel.
+ *
+ * Edges are treated as undirected: an edge in either direction links two vertices. The forest has a minimum spanning tree
+ * for every (weakly) connected component of the graph. Every round, the threads find the lightest edge leaving each tree
+ * (with a compare-and-swap on the tree's slot), then add all of them at once with a lock-free union-find,
+ * which at least halves the number of trees. Edges inside a tree are then dropped.
+ * Ties between equal weights are broken by position in the edge list, so the chosen edges never close a cycle.
+ * Self-loops are ignored.
+ * @param graph The graph.
+ * @param threadCount The number of threads to use, 0 for one per hardware thread.
+ * @return The edges of the forest, grouped by round, and their total weight.
+ */
+template <NeighborGraph G>
+SpanningForest boruvka(const G& graph, const size_t threadCount = 0) {
+    constexpr size_t noEdge = std::numeric_limits<size_t>::max();
+    const size_t threads = resolve_thread_count(threadCount);
+    const std::vector<Edge<VertexId>> edges = edge_list(graph, threads);
+    const auto lighter = [&edges](const size_t edge1, const size_t edge2) {
+        return edges[edge1].weight < edges[edge2].weight || (edges[edge1].weight == edges[edge2].weight && edge1 < edge2);
+    };
+
+    UnionFind sets(graph.id_bound());
+    // lightest edge leaving every tree, indexed by the root of the tree
+    std::vector<size_t> lightest(graph.id_bound(), noEdge);
+    // edges that may still link two trees
+    std::vector<size_t> candidates(edges.size());
+    std::iota(candidates.begin(), candidates.end(), size_t{0});
+    // per-thread results of each pass; fewer blocks than threads run if the range is small,
+    // so all of them are cleared before every pass
+    std::vector<std::vector<size_t>> remainingBlocks(threads);
+    std::vector<std::vector<size_t>> addedBlocks(threads);
+    SpanningForest forest;
+    while (!candidates.empty()) {
+        for (std::vector<size_t>& remaining : remainingBlocks) {
+            remaining.clear();
+        }
+        parallel_blocks(candidates.size(), threads, [&](const size_t thread, const size_t first, const size_t last) {
+            std::vector<size_t>& remaining = remainingBlocks[thread];
+            for (size_t i = first; i < last; ++i) {
+                const size_t edge = candidates[i];
+                const VertexId root1 = sets.find(edges[edge].source);
+                const VertexId root2 = sets.find(edges[edge].target);
+                if (root1 == root2) {
+                    continue;
+                }
+                remaining.push_back(edge);
+                for (const VertexId root : {root1, root2}) {
+                    std::atomic_ref<size_t> slot(lightest[root]);
+                    size_t current = slot.load(std::memory_order_relaxed);
+                    while ((current == noEdge || lighter(edge, current)) &&
+                           !slot.compare_exchange_weak(current, edge, std::memory_order_relaxed)) {
+                    }
+                }
+            }
+        });
+        candidates.clear();
+        for (const std::vector<size_t>& remaining : remainingBlocks) {
+            candidates.insert(candidates.end(), remaining.begin(), remaining.end());
+        }
+        if (candidates.empty()) {
+            break;
+        }
+
+        // two trees may pick the same edge, which unite() only accepts once
+        for (std::vector<size_t>& added : addedBlocks) {
+            added.clear();
+        }
+        parallel_blocks(lightest.size(), threads, [&](const size_t thread, const size_t first, const size_t last) {
+            std::vector<size_t>& added = addedBlocks[thread];
+            for (VertexId root = first; root < last; ++root) {
+                const size_t edge = lightest[root];
+                if (edge != noEdge && sets.unite(edges[edge].source, edges[edge].target)) {
+                    added.push_back(edge);
+                }
+            }
+        });
+        for (const std::vector<size_t>& added : addedBlocks) {
+            for (const size_t edge : added) {
+                forest.edges.push_back(edges[edge]);
+                forest.weight += edges[edge].weight;
+            }
+        }
+        std::ranges::fill(lightest, noEdge);
+    }
+    return forest;
+}
 
 #endif // GRAPH_HPP
@@ -1,7 +1,24 @@
 #include "graph.hpp"
 #include "tests.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -44,6 +61,116 @@ int main(const int argc, char *argv[]) {
         test_result = test_GraphIncidenceMatrix4();
     } else if (arg == "GraphIncidenceMatrix5") {
         test_result = test_GraphIncidenceMatrix5();
+    } else if (arg == "Dijkstra1") {
+        test_result = test_Dijkstra1();
+    } else if (arg == "Dijkstra2") {
+        test_result = test_Dijkstra2();
+    } else if (arg == "Dijkstra3") {
+        test_result = test_Dijkstra3();
+    } else if (arg == "GraphCSR1") {
+        test_result = test_GraphCSR1();
+    } else if (arg == "GraphCSR2") {
+        test_result = test_GraphCSR2();
+    } else if (arg == "GraphLookup1") {
+        test_result = test_GraphLookup1();
+    } else if (arg == "GraphLookup2") {
+        test_result = test_GraphLookup2();
+    } else if (arg == "GraphIds1") {
+        test_result = test_GraphIds1();
+    } else if (arg == "GraphIds2") {
+        test_result = test_GraphIds2();
+    } else if (arg == "GraphTombstone1") {
+        test_result = test_GraphTombstone1();
+    } else if (arg == "GraphTombstone2") {
+        test_result = test_GraphTombstone2();
+    } else if (arg == "GraphTombstone3") {
+        test_result = test_GraphTombstone3();
+    } else if (arg == "GraphAdjacencyMatrixCapacity1") {
+        test_result = test_GraphAdjacencyMatrixCapacity1();
+    } else if (arg == "GraphAdjacencyMatrixCapacity2") {
+        test_result = test_GraphAdjacencyMatrixCapacity2();
+    } else if (arg == "GraphIncidenceSparse1") {
+        test_result = test_GraphIncidenceSparse1();
+    } else if (arg == "GraphIncidenceSparse2") {
+        test_result = test_GraphIncidenceSparse2();
+    } else if (arg == "NeighborRange1") {
+        test_result = test_NeighborRange1();
+    } else if (arg == "NeighborRange2") {
+        test_result = test_NeighborRange2();
+    } else if (arg == "TraversalState1") {
+        test_result = test_TraversalState1();
+    } else if (arg == "TraversalState2") {
+        test_result = test_TraversalState2();
+    } else if (arg == "TraversalState3") {
+        test_result = test_TraversalState3();
+    } else if (arg == "DirectionOptimizingBfs1") {
+        test_result = test_DirectionOptimizingBfs1();
+    } else if (arg == "DirectionOptimizingBfs2") {
+        test_result = test_DirectionOptimizingBfs2();
+    } else if (arg == "DirectionOptimizingBfs3") {
+        test_result = test_DirectionOptimizingBfs3();
+    } else if (arg == "ConcurrentGraph1") {
+        test_result = test_ConcurrentGraph1();
+    } else if (arg == "ConcurrentGraph2") {
+        test_result = test_ConcurrentGraph2();
+    } else if (arg == "GraphAdjacencyBitMatrix1") {
+        test_result = test_GraphAdjacencyBitMatrix1();
+    } else if (arg == "GraphAdjacencyBitMatrix2") {
+        test_result = test_GraphAdjacencyBitMatrix2();
+    } else if (arg == "BulkEdges1") {
+        test_result = test_BulkEdges1();
+    } else if (arg == "BulkEdges2") {
+        test_result = test_BulkEdges2();
+    } else if (arg == "BinaryFile1") {
+        test_result = test_BinaryFile1();
+    } else if (arg == "BinaryFile2") {
+        test_result = test_BinaryFile2();
+    } else if (arg == "EdgeListReader1") {
+        test_result = test_EdgeListReader1();
+    } else if (arg == "EdgeListReader2") {
+        test_result = test_EdgeListReader2();
+    } else if (arg == "ConnectedComponents1") {
+        test_result = test_ConnectedComponents1();
+    } else if (arg == "ConnectedComponents2") {
+        test_result = test_ConnectedComponents2();
+    } else if (arg == "FloydWarshall1") {
+        test_result = test_FloydWarshall1();
+    } else if (arg == "FloydWarshall2") {
+        test_result = test_FloydWarshall2();
+    } else if (arg == "PageRank1") {
+        test_result = test_PageRank1();
+    } else if (arg == "PageRank2") {
+        test_result = test_PageRank2();
+    } else if (arg == "AStar1") {
+        test_result = test_AStar1();
+    } else if (arg == "BidirectionalDijkstra1") {
+        test_result = test_BidirectionalDijkstra1();
+    } else if (arg == "ContractionHierarchy1") {
+        test_result = test_ContractionHierarchy1();
+    } else if (arg == "ContractionHierarchy2") {
+        test_result = test_ContractionHierarchy2();
+    } else if (arg == "StronglyConnectedComponents1") {
+        test_result = test_StronglyConnectedComponents1();
+    } else if (arg == "StronglyConnectedComponents2") {
+        test_result = test_StronglyConnectedComponents2();
+    } else if (arg == "MinimumSpanningForest1") {
+        test_result = test_MinimumSpanningForest1();
+    } else if (arg == "MinimumSpanningForest2") {
+        test_result = test_MinimumSpanningForest2();
+    } else if (arg == "MinimumSpanningForest3") {
+        test_result = test_MinimumSpanningForest3();
+    } else if (arg == "EdgeWeights1") {
+        test_result = test_EdgeWeights1();
+    } else if (arg == "EdgeWeights2") {
+        test_result = test_EdgeWeights2();
+    } else if (arg == "PredecessorIndex1") {
+        test_result = test_PredecessorIndex1();
+    } else if (arg == "PredecessorIndex2") {
+        test_result = test_PredecessorIndex2();
+    } else if (arg == "NeighborTable1") {
+        test_result = test_NeighborTable1();
+    } else if (arg == "BinaryFile3") {
+        test_result = test_BinaryFile3();
     } else {
         return -3;
     }
@@ -64,7 +191,9 @@ bool test_GraphAdjacencyList1() {
         return false;
     }
     const GraphAdjacencyList<int> graph3{std::move(graph1)};
-    if (!graph3.adjacent(1, 2) || !graph3.adjacent(2, 1)) {
+    // a moved-from graph is empty
+    // NOLINTNEXTLINE(bugprone-use-after-move,hicpp-invalid-access-moved)
+    if (!graph3.adjacent(1, 2) || !graph3.adjacent(2, 1) || graph1.size() != 0 || !graph1.empty()) {
         return false;
     }
     graph1 = graph2;
@@ -72,7 +201,9 @@ bool test_GraphAdjacencyList1() {
         return false;
     }
     graph1 = std::move(graph2);
-    return graph1.adjacent(1, 2) && graph1.adjacent(2, 1);
+    // NOLINTNEXTLINE(bugprone-use-after-move,hicpp-invalid-access-moved)
+    graph2.add_vertex(3);
+    return graph1.adjacent(1, 2) && graph1.adjacent(2, 1) && graph2.size() == 1 && graph2.id_bound() == 1;
 }
 
 bool test_GraphAdjacencyList2() {
@@ -363,3 +494,2531 @@ bool test_GraphIncidenceMatrix5() {
     graph.reset_vertices_visited();
     return !graph.get_vertex_visited(1) && !graph.get_vertex_visited(2);
 }
+
+bool test_Dijkstra1() {
+    // Test dijkstra distances and predecessors on an adjacency list
+    GraphAdjacencyList<std::string> graph;
+    for (const std::string vertex : {"a", "b", "c", "d", "e"}) {
+        graph.add_vertex(vertex);
+    }
+    graph.set_edge_weight("a", "b", 4.0);
+    graph.set_edge_weight("a", "c", 1.0);
+    graph.set_edge_weight("c", "b", 2.0);
+    graph.set_edge_weight("b", "d", 1.0);
+    graph.set_edge_weight("c", "d", 5.0);
+
+    const ShortestPaths paths = dijkstra(graph, graph.id_of("a"));
+    const std::vector<double> expectedDistances{0.0, 3.0, 1.0, 4.0};
+    for (size_t i = 0; i < expectedDistances.size(); ++i) {
+        if (paths.distances[graph.id_of(std::string(1, static_cast<char>('a' + i)))] != expectedDistances[i]) {
+            return false;
+        }
+    }
+    if (paths.distances[graph.id_of("e")] != std::numeric_limits<double>::infinity() ||
+        paths.predecessors[graph.id_of("e")] != NO_VERTEX ||
+        paths.predecessors[graph.id_of("a")] != NO_VERTEX) {
+        return false;
+    }
+
+    std::vector<std::string> path;
+    for (const VertexId id : reconstruct_path(paths, graph.id_of("d"))) {
+        path.push_back(graph.value_of(id));
+    }
+    const std::vector<std::string> expectedPath{"a", "c", "b", "d"};
+    return path == expectedPath && reconstruct_path(paths, graph.id_of("e")).empty();
+}
+
+bool test_Dijkstra2() {
+    // Test target-bounded dijkstra on all representations
+    GraphAdjacencyList<int> list;
+    GraphAdjacencyMatrix<int> matrix;
+    GraphIncidenceMatrix<int> incidence;
+    const std::vector<Graph<int>*> graphs{&list, &matrix, &incidence};
+    for (Graph<int>* graph : graphs) {
+        for (int i = 0; i < 6; ++i) {
+            graph->add_vertex(i);
+        }
+        for (int i = 0; i < 5; ++i) {
+            graph->set_edge_weight(i, i + 1, 1.0);
+        }
+        graph->set_edge_weight(0, 5, 10.0);
+        graph->set_edge_weight(1, 4, 2.0);
+    }
+
+    const std::vector<VertexId> expectedPath{0, 1, 4};
+    const ShortestPaths listPaths = dijkstra(list, list.id_of(0), list.id_of(4));
+    const ShortestPaths matrixPaths = dijkstra(matrix, matrix.id_of(0), matrix.id_of(4));
+    const ShortestPaths incidencePaths = dijkstra(incidence, incidence.id_of(0), incidence.id_of(4));
+    for (const ShortestPaths* paths : {&listPaths, &matrixPaths, &incidencePaths}) {
+        if (paths->distances[4] != 3.0 || reconstruct_path(*paths, 4) != expectedPath) {
+            return false;
+        }
+    }
+    return dijkstra(list, 0).distances[5] == 4.0;
+}
+
+bool test_Dijkstra3() {
+    // Test dijkstra error handling
+    GraphAdjacencyList<int> graph;
+    graph.add_vertex(1);
+    graph.add_vertex(2);
+    graph.set_edge_weight(1, 2, -1.0);
+    try {
+        static_cast<void>(dijkstra(graph, graph.id_of(1)));
+        return false;
+    } catch (const NegativeEdgeWeightException& _) {}
+    try {
+        static_cast<void>(dijkstra(graph, 2));
+        return false;
+    } catch (const VertexNotFoundException& _) {}
+    try {
+        static_cast<void>(dijkstra(graph, 0, 5));
+        return false;
+    } catch (const VertexNotFoundException& _) {}
+    return true;
+}
+
+bool test_GraphCSR1() {
+    // Test that a CSR snapshot has the same vertices, edges, and weights as the graph
+    GraphAdjacencyList<std::string> graph;
+    for (const std::string vertex : {"a", "b", "c", "d"}) {
+        graph.add_vertex(vertex);
+    }
+    graph.set_edge_weight("a", "d", 3.0);
+    graph.set_edge_weight("a", "b", 1.0);
+    graph.set_edge_weight("c", "a", 2.0);
+    graph.set_edge_weight("d", "d", 4.0);
+
+    const GraphCSR<std::string> csr = graph.freeze();
+    graph.set_edge_weight("b", "c", 5.0);
+    if (csr.size() != 4 || csr.edge_count() != 4 || csr.empty()) {
+        return false;
+    }
+    for (const std::string vertex1 : {"a", "b", "c", "d"}) {
+        for (const std::string vertex2 : {"a", "b", "c", "d"}) {
+            if (vertex1 == "b" && vertex2 == "c") {
+                continue;
+            }
+            if (csr.adjacent(vertex1, vertex2) != graph.adjacent(vertex1, vertex2) ||
+                csr.get_edge_weight(vertex1, vertex2) != graph.get_edge_weight(vertex1, vertex2)) {
+                return false;
+            }
+        }
+    }
+    if (csr.adjacent("b", "c") || !csr.neighbors("b").empty()) {
+        return false;
+    }
+    const std::vector<std::string> expectedNeighbors{"b", "d"};
+    if (csr.neighbors("a") != expectedNeighbors) {
+        return false;
+    }
+    try {
+        static_cast<void>(csr.adjacent("a", "e"));
+        return false;
+    } catch (const VertexNotFoundException& _) {}
+
+    // a transpose shares the vertices and the map from values to ids, which outlive the original
+    std::optional<GraphCSR<std::string>> original = graph.freeze();
+    const GraphCSR<std::string> transpose = original->transpose();
+    original.reset();
+    return transpose.adjacent("d", "a") && transpose.adjacent("c", "b") && !transpose.adjacent("a", "b") &&
+           transpose.id_of("c") == csr.id_of("c");
+}
+
+bool test_GraphCSR2() {
+    // Test id-based iteration over a CSR snapshot
+    GraphAdjacencyMatrix<int> graph;
+    for (int i = 0; i < 5; ++i) {
+        graph.add_vertex(i * 10);
+    }
+    graph.set_edge_weight(0, 40, 1.0);
+    graph.set_edge_weight(0, 20, 7.0);
+    graph.set_edge_weight(0, 10, 2.0);
+    graph.set_edge_weight(10, 20, 3.0);
+    graph.set_edge_weight(20, 30, 1.0);
+
+    const GraphCSR<int> csr = graph.freeze();
+    const VertexId source = csr.id_of(0);
+    const std::vector<VertexId> expectedIds{csr.id_of(10), csr.id_of(20), csr.id_of(40)};
+    const std::vector<double> expectedWeights{2.0, 7.0, 1.0};
+    const std::span<const VertexId> ids = csr.neighbor_ids(source);
+    const std::span<const double> weights = csr.neighbor_weights(source);
+    if (csr.degree(source) != 3 || !std::ranges::equal(ids, expectedIds) || !std::ranges::equal(weights, expectedWeights)) {
+        return false;
+    }
+    if (csr.value_of(csr.id_of(30)) != 30 || !csr.adjacent_by_id(source, csr.id_of(20)) || csr.adjacent_by_id(csr.id_of(20), source) ||
+        csr.get_edge_weight_by_id(source, csr.id_of(20)) != 7.0 || csr.neighbors_by_id(source) != expectedIds) {
+        return false;
+    }
+
+    const ShortestPaths csrPaths = dijkstra(csr, source);
+    const ShortestPaths graphPaths = dijkstra(graph, graph.id_of(0));
+    return csrPaths.distances == graphPaths.distances && csrPaths.predecessors == graphPaths.predecessors &&
+           csrPaths.distances[csr.id_of(30)] == 6.0;
+}
+
+bool test_GraphLookup1() {
+    // Test find_vertex and try_get_edge_weight on all representations
+    GraphAdjacencyList<int> list;
+    GraphAdjacencyMatrix<int> matrix;
+    GraphIncidenceMatrix<int> incidence;
+    const std::vector<Graph<int>*> graphs{&list, &matrix, &incidence};
+    for (Graph<int>* graph : graphs) {
+        graph->add_vertex(1);
+        graph->add_vertex(2);
+        graph->add_vertex(3);
+        graph->set_edge_weight(1, 2, 2.5);
+        if (graph->find_vertex(2) != std::optional<VertexId>{graph->id_of(2)} || graph->find_vertex(4).has_value()) {
+            return false;
+        }
+        if (graph->try_get_edge_weight(1, 2) != std::optional<double>{2.5} ||
+            graph->try_get_edge_weight(2, 1).has_value() ||
+            graph->try_get_edge_weight(1, 4).has_value() ||
+            graph->try_get_edge_weight(4, 1).has_value()) {
+            return false;
+        }
+        graph->remove_edge(1, 2);
+        if (graph->try_get_edge_weight(1, 2).has_value() || graph->get_edge_weight(1, 2) != 0.0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_GraphLookup2() {
+    // Test that the throwing API still throws on missing vertices
+    GraphAdjacencyList<int> list;
+    GraphAdjacencyMatrix<int> matrix;
+    GraphIncidenceMatrix<int> incidence;
+    const std::vector<Graph<int>*> graphs{&list, &matrix, &incidence};
+    for (Graph<int>* graph : graphs) {
+        graph->add_vertex(1);
+        size_t thrown = 0;
+        try {
+            static_cast<void>(graph->adjacent(1, 2));
+        } catch (const VertexNotFoundException& _) {
+            ++thrown;
+        }
+        try {
+            static_cast<void>(graph->get_edge_weight(2, 1));
+        } catch (const VertexNotFoundException& _) {
+            ++thrown;
+        }
+        try {
+            graph->set_vertex_visited(2, true);
+        } catch (const VertexNotFoundException& _) {
+            ++thrown;
+        }
+        try {
+            static_cast<void>(graph->neighbors(2));
+        } catch (const VertexNotFoundException& _) {
+            ++thrown;
+        }
+        if (thrown != 4) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_GraphIds1() {
+    // Test add_vertex ids and the id-based overloads on all representations
+    GraphAdjacencyList<std::string> list;
+    GraphAdjacencyMatrix<std::string> matrix;
+    GraphIncidenceMatrix<std::string> incidence;
+    const std::vector<Graph<std::string>*> graphs{&list, &matrix, &incidence};
+    for (Graph<std::string>* graph : graphs) {
+        const VertexId a = graph->add_vertex("a");
+        const VertexId b = graph->add_vertex("b");
+        const VertexId c = graph->add_vertex("c");
+        if (graph->id_of("a") != a || graph->id_of("b") != b || graph->value_of(c) != "c") {
+            return false;
+        }
+        graph->set_edge_weight_by_id(a, b, 2.0);
+        graph->set_edge_weight_by_id(a, c, 3.0);
+        if (!graph->adjacent_by_id(a, b) || graph->adjacent_by_id(b, a) || !graph->adjacent("a", "c")) {
+            return false;
+        }
+        if (graph->get_edge_weight_by_id(a, c) != 3.0 || graph->get_edge_weight("a", "b") != 2.0) {
+            return false;
+        }
+        std::vector<VertexId> neighborIds = graph->neighbors_by_id(a);
+        std::ranges::sort(neighborIds);
+        const std::vector<VertexId> expectedIds{b, c};
+        if (neighborIds != expectedIds || !graph->neighbors_by_id(b).empty()) {
+            return false;
+        }
+        // an edge of weight 0 is still an edge
+        graph->set_edge_weight_by_id(a, b, 0.0);
+        if (!graph->adjacent("a", "b") || graph->try_get_edge_weight("a", "b") != std::optional<double>{0.0}) {
+            return false;
+        }
+        graph->remove_edge_by_id(a, b);
+        if (graph->adjacent("a", "b")) {
+            return false;
+        }
+    }
+
+    // with integer vertices, the overloads without the _by_id suffix always take vertices, never ids
+    GraphAdjacencyList<unsigned> numbers;
+    numbers.add_vertex(2);
+    numbers.add_vertex(1);
+    numbers.set_edge_weight(1, 2, 1.0);
+    return numbers.adjacent(1, 2) && !numbers.adjacent(2, 1) && numbers.adjacent_by_id(1, 0) && !numbers.adjacent_by_id(0, 1) &&
+           numbers.neighbors(1) == std::vector<unsigned>{2} && numbers.neighbors_by_id(1) == std::vector<VertexId>{0};
+}
+
+bool test_GraphIds2() {
+    // Test that invalid ids throw
+    GraphAdjacencyList<std::string> list;
+    GraphAdjacencyMatrix<std::string> matrix;
+    GraphIncidenceMatrix<std::string> incidence;
+    const std::vector<Graph<std::string>*> graphs{&list, &matrix, &incidence};
+    for (Graph<std::string>* graph : graphs) {
+        const VertexId a = graph->add_vertex("a");
+        size_t thrown = 0;
+        try {
+            static_cast<void>(graph->adjacent_by_id(a, a + 1));
+        } catch (const VertexNotFoundException& _) {
+            ++thrown;
+        }
+        try {
+            graph->set_edge_weight_by_id(a + 1, a, 1.0);
+        } catch (const VertexNotFoundException& _) {
+            ++thrown;
+        }
+        try {
+            static_cast<void>(graph->value_of(a + 1));
+        } catch (const VertexNotFoundException& _) {
+            ++thrown;
+        }
+        try {
+            static_cast<void>(graph->id_of("b"));
+        } catch (const VertexNotFoundException& _) {
+            ++thrown;
+        }
+        if (thrown != 4) {
+            return false;
+        }
+    }
+
+    // with VertexId vertices, the methods taking vertices and the ones taking ids are both available
+    GraphAdjacencyList<VertexId> graph;
+    graph.add_vertex(10);
+    graph.add_vertex(20);
+    graph.add_edge(10, 20);
+    return graph.adjacent(10, 20) && graph.neighbors(10) == std::vector<VertexId>{20} && graph.adjacent_by_id(0, 1) &&
+           graph.neighbors_by_id(0) == std::vector<VertexId>{1};
+}
+
+bool test_GraphTombstone1() {
+    // Test removal in the tombstone mode (stable ids, id reuse, and removal of incident edges)
+    GraphAdjacencyList<int> list;
+    GraphAdjacencyMatrix<int> matrix;
+    GraphIncidenceMatrix<int> incidence;
+    const std::vector<Graph<int>*> graphs{&list, &matrix, &incidence};
+    for (Graph<int>* graph : graphs) {
+        graph->set_removal_mode(RemovalMode::Tombstone);
+        for (int i = 0; i < 4; ++i) {
+            graph->add_vertex(i);
+        }
+        graph->add_edge(0, 1);
+        graph->add_edge(1, 2);
+        graph->add_edge(2, 3);
+        graph->add_edge(3, 1);
+
+        graph->remove_vertex(1);
+        if (graph->size() != 3 || graph->id_bound() != 4 || graph->contains_id(1) || !graph->contains_id(3)) {
+            return false;
+        }
+        if (graph->id_of(0) != 0 || graph->id_of(2) != 2 || graph->id_of(3) != 3) {
+            return false;
+        }
+        if (!graph->neighbors(0).empty() || !graph->neighbors(3).empty() || !graph->adjacent(2, 3)) {
+            return false;
+        }
+
+        // a new vertex never inherits the edges of a removed vertex, even if it gets its id
+        const VertexId id = graph->add_vertex(10);
+        if (graph->value_of(id) != 10 || graph->adjacent(0, 10) || graph->adjacent(10, 2) || graph->adjacent(3, 10) ||
+            !graph->neighbors(10).empty()) {
+            return false;
+        }
+    }
+
+    // the matrices reuse freed ids immediately (the adjacency list only after its stale edges are purged)
+    return matrix.id_of(10) == 1 && incidence.id_of(10) == 1 && matrix.id_bound() == 4 && incidence.id_bound() == 4;
+}
+
+bool test_GraphTombstone2() {
+    // Test compact, and algorithms on graphs with freed ids
+    GraphAdjacencyList<int> list;
+    GraphAdjacencyMatrix<int> matrix;
+    GraphIncidenceMatrix<int> incidence;
+    const std::vector<Graph<int>*> graphs{&list, &matrix, &incidence};
+    for (Graph<int>* graph : graphs) {
+        graph->set_removal_mode(RemovalMode::Tombstone);
+        for (int i = 0; i < 6; ++i) {
+            graph->add_vertex(i);
+        }
+        for (int i = 0; i < 5; ++i) {
+            graph->set_edge_weight(i, i + 1, 1.0);
+        }
+        graph->set_edge_weight(0, 2, 5.0);
+        graph->remove_vertex(1);
+        graph->remove_vertex(4);
+
+        const ShortestPaths paths = dijkstra(*graph, graph->id_of(0));
+        if (paths.distances.size() != 6 || paths.distances[graph->id_of(3)] != 6.0 ||
+            paths.distances[graph->id_of(5)] != std::numeric_limits<double>::infinity()) {
+            return false;
+        }
+        const GraphCSR<int> csr = graph->freeze();
+        if (csr.size() != 4 || csr.id_bound() != 6 || csr.contains_id(1) || csr.get_edge_weight(0, 2) != 5.0) {
+            return false;
+        }
+
+        const std::vector<VertexId> newIds = graph->compact();
+        const std::vector<VertexId> expectedIds{0, NO_VERTEX, 1, 2, NO_VERTEX, 3};
+        if (newIds != expectedIds || graph->id_bound() != 4 || graph->size() != 4) {
+            return false;
+        }
+        if (graph->id_of(5) != 3 || graph->value_of(2) != 3 || graph->get_edge_weight(0, 2) != 5.0 ||
+            !graph->adjacent(2, 3) || graph->adjacent(3, 5)) {
+            return false;
+        }
+        if (graph->add_vertex(6) != 4) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_GraphTombstone3() {
+    // Test many removals in the tombstone mode, and copies of graphs with freed ids
+    GraphAdjacencyList<int> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    constexpr int vertexCount = 100;
+    for (int i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    for (int i = 0; i < vertexCount; ++i) {
+        graph.add_edge(i, (i + 1) % vertexCount);
+        graph.add_edge(i, (i + 7) % vertexCount);
+    }
+    for (int i = 0; i < vertexCount; ++i) {
+        if (i % 3 != 0) {
+            graph.remove_vertex(i);
+        }
+    }
+    const GraphAdjacencyList<int> copy{graph};
+    if (copy.removal_mode() != RemovalMode::Tombstone || copy.size() != graph.size() || copy.size() != 34) {
+        return false;
+    }
+    for (int i = 0; i < vertexCount; i += 3) {
+        for (const int neighbor : copy.neighbors(i)) {
+            if (neighbor % 3 != 0) {
+                return false;
+            }
+        }
+    }
+    for (int i = 0; i < vertexCount; ++i) {
+        if (i % 3 != 0) {
+            graph.add_vertex(vertexCount + i);
+        }
+    }
+    for (int i = 0; i < vertexCount; ++i) {
+        if (i % 3 != 0 && !graph.neighbors(vertexCount + i).empty()) {
+            return false;
+        }
+    }
+    // most of the freed ids must have been reused
+    return graph.size() == vertexCount && graph.id_bound() < vertexCount + 20;
+}
+
+bool test_GraphAdjacencyMatrixCapacity1() {
+    // Test the capacity growth of the adjacency matrix (edges must survive reallocations)
+    GraphAdjacencyMatrix<int> graph;
+    if (graph.capacity() != 0) {
+        return false;
+    }
+    constexpr int vertexCount = 50;
+    for (int i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+        if (i > 0) {
+            graph.set_edge_weight(i - 1, i, i);
+            graph.set_edge_weight(i, 0, -i);
+        }
+    }
+    if (graph.capacity() < vertexCount || graph.capacity() >= 2 * vertexCount || graph.id_bound() != vertexCount) {
+        return false;
+    }
+    for (int i = 1; i < vertexCount; ++i) {
+        if (graph.get_edge_weight(i - 1, i) != i || graph.get_edge_weight(i, 0) != -i || graph.neighbors(i).size() != (i + 1 < vertexCount ? 2U : 1U)) {
+            return false;
+        }
+    }
+
+    // reserving less than the capacity does nothing, reserving more keeps the edges
+    const size_t capacity = graph.capacity();
+    graph.reserve(10);
+    if (graph.capacity() != capacity) {
+        return false;
+    }
+    graph.reserve(200);
+    if (graph.capacity() != 200 || graph.get_edge_weight(48, 49) != 49 || graph.get_edge_weight(49, 0) != -49) {
+        return false;
+    }
+
+    // removals compact the matrix in place, without changing its capacity
+    graph.remove_vertex(0);
+    graph.remove_vertex(25);
+    if (graph.capacity() != 200 || graph.size() != vertexCount - 2 || graph.id_bound() != vertexCount - 2) {
+        return false;
+    }
+    for (int i = 2; i < vertexCount; ++i) {
+        if (i != 25 && i != 26 && graph.get_edge_weight(i - 1, i) != i) {
+            return false;
+        }
+        if (i != 25 && graph.neighbors(i).size() != (i + 1 < vertexCount && i != 24 ? 1U : 0U)) {
+            return false;
+        }
+    }
+    return !graph.adjacent(24, 26) && graph.neighbors(1).size() == 1;
+}
+
+bool test_GraphAdjacencyMatrixCapacity2() {
+    // Test the bulk addition of vertices
+    GraphAdjacencyMatrix<std::string> graph;
+    graph.add_vertex("a");
+    graph.add_edge("a", "a");
+    const std::vector<std::string> names{"b", "c", "d"};
+    const std::vector<VertexId> ids = graph.add_vertices(names);
+    const std::vector<VertexId> expectedIds{1, 2, 3};
+    if (ids != expectedIds || graph.size() != 4 || graph.capacity() != 4 || !graph.adjacent("a", "a") || graph.adjacent("a", "d")) {
+        return false;
+    }
+
+    // a vertex that already exists, or a repeated one, adds nothing
+    const std::vector<std::string> existing{"e", "a"};
+    const std::vector<std::string> repeated{"e", "f", "e"};
+    for (const auto* vertices : {&existing, &repeated}) {
+        try {
+            graph.add_vertices(*vertices);
+            return false;
+        } catch (const VertexAlreadyExistsException&) {
+        }
+        if (graph.size() != 4 || graph.id_bound() != 4 || graph.capacity() != 4 || graph.find_vertex("e") || graph.find_vertex("f")) {
+            return false;
+        }
+    }
+
+    // any range of vertices can be added, freed ids are reused first
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    graph.remove_vertex("b");
+    const std::vector<VertexId> moreIds = graph.add_vertices(std::views::iota(0, 5) | std::views::transform([](int i) { return std::to_string(i); }));
+    return moreIds.front() == 1 && moreIds.back() == 7 && graph.size() == 8 && graph.value_of(7) == "4" && !graph.adjacent("0", "a");
+}
+
+bool test_GraphIncidenceSparse1() {
+    // Test the sparse storage of the incidence matrix
+    GraphIncidenceMatrix<int> graph{IncidenceStorage::Sparse};
+    if (graph.storage() != IncidenceStorage::Sparse || GraphIncidenceMatrix<int>{}.storage() != IncidenceStorage::Dense) {
+        return false;
+    }
+    for (int i = 0; i < 5; ++i) {
+        graph.add_vertex(i);
+    }
+    graph.set_edge_weight(0, 1, 1.5);
+    graph.set_edge_weight(0, 2, 2.5);
+    graph.set_edge_weight(1, 2, 3.5);
+    graph.set_edge_weight(2, 0, 4.5);
+    graph.set_edge_weight(3, 4, 5.5);
+    graph.set_edge_weight(0, 1, 6.5);
+    if (graph.edge_count() != 5 || graph.get_edge_weight(0, 1) != 6.5 || graph.get_edge_weight(1, 0) != 0.0 || !graph.adjacent(2, 0)) {
+        return false;
+    }
+
+    // removing an edge moves the last edge into its place
+    graph.remove_edge(0, 2);
+    if (graph.edge_count() != 4 || graph.adjacent(0, 2) || graph.get_edge_weight(3, 4) != 5.5 || graph.neighbors(3) != std::vector<int>{4}) {
+        return false;
+    }
+    if (graph.neighbors(0) != std::vector<int>{1} || graph.try_get_edge_weight(1, 2) != 3.5 || graph.try_get_edge_weight(0, 2)) {
+        return false;
+    }
+
+    // removing a vertex removes its incident edges, the other ids are renumbered
+    graph.remove_vertex(2);
+    if (graph.edge_count() != 2 || graph.size() != 4 || graph.id_of(4) != 3 || graph.get_edge_weight(3, 4) != 5.5 || !graph.neighbors(1).empty()) {
+        return false;
+    }
+    const GraphIncidenceMatrix<int> copy{graph};
+    graph.remove_edge(0, 1);
+    return copy.storage() == IncidenceStorage::Sparse && copy.edge_count() == 2 && copy.adjacent(0, 1) && graph.edge_count() == 1;
+}
+
+bool test_GraphIncidenceSparse2() {
+    // Test that the sparse and dense storages of the incidence matrix behave the same
+    GraphIncidenceMatrix<int> dense{IncidenceStorage::Dense};
+    GraphIncidenceMatrix<int> sparse{IncidenceStorage::Sparse};
+    constexpr int vertexCount = 20;
+    for (GraphIncidenceMatrix<int>* graph : {&dense, &sparse}) {
+        graph->set_removal_mode(RemovalMode::Tombstone);
+        for (int i = 0; i < vertexCount; ++i) {
+            graph->add_vertex(i);
+        }
+        unsigned int state = 12345;
+        for (int step = 0; step < 400; ++step) {
+            state = state * 1103515245U + 12345U;
+            const int source = static_cast<int>((state >> 8U) % vertexCount);
+            const int target = static_cast<int>((state >> 16U) % vertexCount);
+            const int weight = static_cast<int>((state >> 24U) % 4U);
+            if (source != target && graph->find_vertex(source) && graph->find_vertex(target)) {
+                graph->set_edge_weight(source, target, weight);
+            }
+            if (step % 50 == 49 && graph->find_vertex(source)) {
+                graph->remove_vertex(source);
+                graph->add_vertex(vertexCount + step);
+            }
+        }
+        graph->compact();
+    }
+
+    if (dense.edge_count() != sparse.edge_count() || dense.size() != sparse.size() || dense.id_bound() != sparse.id_bound()) {
+        return false;
+    }
+    for (VertexId id = 0; id < dense.id_bound(); ++id) {
+        if (dense.value_of(id) != sparse.value_of(id)) {
+            return false;
+        }
+        std::vector<VertexId> denseNeighbors = dense.neighbors_by_id(id);
+        std::vector<VertexId> sparseNeighbors = sparse.neighbors_by_id(id);
+        std::ranges::sort(denseNeighbors);
+        std::ranges::sort(sparseNeighbors);
+        if (denseNeighbors != sparseNeighbors) {
+            return false;
+        }
+        for (const VertexId neighbor : denseNeighbors) {
+            if (dense.get_edge_weight_by_id(id, neighbor) != sparse.get_edge_weight_by_id(id, neighbor)) {
+                return false;
+            }
+        }
+    }
+    return dense.edge_count() > 0;
+}
+
+bool test_NeighborRange1() {
+    // Test the neighbor ranges and for_each_neighbor of all representations
+    GraphAdjacencyList<std::string> list;
+    GraphAdjacencyMatrix<std::string> matrix;
+    GraphIncidenceMatrix<std::string> incidence;
+    GraphIncidenceMatrix<std::string> sparseIncidence{IncidenceStorage::Sparse};
+    const std::vector<Graph<std::string>*> graphs{&list, &matrix, &incidence, &sparseIncidence};
+    for (Graph<std::string>* graph : graphs) {
+        for (const char* vertex : {"a", "b", "c", "d"}) {
+            graph->add_vertex(vertex);
+        }
+        graph->set_edge_weight("a", "b", 1.0);
+        graph->set_edge_weight("a", "c", 2.0);
+        graph->set_edge_weight("a", "d", 3.0);
+        graph->set_edge_weight("b", "c", 4.0);
+        graph->remove_edge("a", "c");
+
+        double weightSum = 0.0;
+        graph->for_each_neighbor(graph->id_of("a"), [&weightSum, graph](const VertexId id, const double weight) {
+            weightSum += weight * (graph->value_of(id) == "d" ? 10.0 : 1.0);
+        });
+        if (weightSum != 31.0) {
+            return false;
+        }
+    }
+
+    const auto check = [](const auto& graph) {
+        static_assert(std::ranges::forward_range<decltype(graph.neighbor_range(VertexId{0}))>);
+        std::vector<std::string> values;
+        double weightSum = 0.0;
+        for (const auto [id, value, weight] : graph.neighbor_range(graph.id_of("a"))) {
+            // the values are not copied
+            if (&value != &graph.value_of(id)) {
+                return false;
+            }
+            values.push_back(value);
+            weightSum += weight;
+        }
+        std::ranges::sort(values);
+        return values == std::vector<std::string>{"b", "d"} && weightSum == 4.0 && graph.neighbor_range(graph.id_of("c")).empty() &&
+               std::ranges::distance(graph.neighbor_range(graph.id_of("b"))) == 1;
+    };
+    return check(list) && check(matrix) && check(incidence) && check(sparseIncidence) && check(list.freeze());
+}
+
+bool test_NeighborRange2() {
+    // Test that neighbor ranges skip removed vertices and compose with range adaptors
+    GraphAdjacencyList<int> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (int i = 0; i < 6; ++i) {
+        graph.add_vertex(i);
+    }
+    for (int i = 1; i < 6; ++i) {
+        graph.set_edge_weight(0, i, i);
+    }
+    graph.remove_vertex(2);
+    graph.remove_vertex(5);
+
+    std::vector<int> values;
+    for (const Neighbor<int>& neighbor : graph.neighbor_range(graph.id_of(0)) | std::views::filter([](const Neighbor<int>& neighbor) { return neighbor.weight > 1.0; })) {
+        values.push_back(neighbor.value);
+    }
+    std::ranges::sort(values);
+    if (values != std::vector<int>{3, 4}) {
+        return false;
+    }
+    try {
+        static_cast<void>(graph.neighbor_range(VertexId{2}));
+        return false;
+    } catch (const VertexNotFoundException&) {
+    }
+    try {
+        graph.for_each_neighbor(VertexId{5}, [](VertexId, double) {});
+        return false;
+    } catch (const VertexNotFoundException&) {
+    }
+    return std::ranges::distance(graph.neighbor_range(graph.id_of(0))) == 3;
+}
+
+bool test_TraversalState1() {
+    // Test visiting, unvisiting, and resetting a traversal state
+    TraversalState state{4};
+    if (state.id_bound() != 4 || state.visited(0) || !state.visit(0) || state.visit(0) || !state.visited(0)) {
+        return false;
+    }
+    state.visit(3);
+    state.unvisit(0);
+    if (state.visited(0) || !state.visited(3)) {
+        return false;
+    }
+    state.reset();
+    if (state.visited(3) || !state.visit(3)) {
+        return false;
+    }
+    state.resize(2);
+    state.resize(10);
+    return state.id_bound() == 10 && state.visited(3) && !state.visited(9);
+}
+
+bool test_TraversalState2() {
+    // Test breadth-first and depth-first searches with external traversal states
+    GraphAdjacencyList<int> graph;
+    for (int i = 0; i < 7; ++i) {
+        graph.add_vertex(i);
+    }
+    graph.add_edge(0, 1);
+    graph.add_edge(1, 2);
+    graph.add_edge(2, 3);
+    graph.add_edge(0, 4);
+    graph.add_edge(4, 3);
+    graph.add_edge(5, 6);
+
+    TraversalState state;
+    std::vector<VertexId> order;
+    breadth_first_search(graph, 0, state, [&order](const VertexId id) { order.push_back(id); });
+    // vertices at distance 1 come before the ones at distance 2
+    if (order.size() != 5 || order[0] != 0 || order[1] + order[2] != 5 || order[3] + order[4] != 5 || state.visited(5)) {
+        return false;
+    }
+
+    // the state is kept between searches, so a second search only visits new vertices
+    order.clear();
+    depth_first_search(graph.freeze(), 5, state, [&order](const VertexId id) { order.push_back(id); });
+    if (order != std::vector<VertexId>{5, 6}) {
+        return false;
+    }
+    order.clear();
+    breadth_first_search(graph, 2, state, [&order](const VertexId id) { order.push_back(id); });
+    if (!order.empty()) {
+        return false;
+    }
+
+    // depth-first order follows a path to its end before backtracking
+    state.reset();
+    depth_first_search(graph, 0, state, [&order](const VertexId id) { order.push_back(id); });
+    const bool viaVertex1 = order == std::vector<VertexId>{0, 1, 2, 3, 4};
+    const bool viaVertex4 = order == std::vector<VertexId>{0, 4, 3, 1, 2};
+    return viaVertex1 || viaVertex4;
+}
+
+bool test_TraversalState3() {
+    // Test concurrent traversals of the same graph, each with its own traversal state
+    constexpr size_t vertexCount = 2000;
+    constexpr size_t threadCount = 4;
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_edge(i, (i + 1) % vertexCount);
+        graph.add_edge(i, (i * 7) % vertexCount);
+    }
+
+    std::vector<size_t> visitedCounts(threadCount);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&graph, &visitedCounts, t] {
+            TraversalState state;
+            for (size_t source = t; source < vertexCount; source += vertexCount / 10) {
+                state.reset();
+                breadth_first_search(graph, source, state, [&visitedCounts, t](VertexId) { ++visitedCounts[t]; });
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return std::ranges::all_of(visitedCounts, [](const size_t count) { return count == 10 * vertexCount; });
+}
+
+namespace {
+
+// check a breadth-first tree against the distances of a sequential breadth-first search
+bool check_breadth_first_tree(const GraphCSR<size_t>& graph, const VertexId source, const BreadthFirstTree& tree) {
+    std::vector<size_t> distances(graph.id_bound(), UNREACHABLE);
+    distances[source] = 0;
+    TraversalState state;
+    breadth_first_search(graph, source, state, [&graph, &distances](const VertexId id) {
+        for (const VertexId neighbor : graph.neighbor_ids(id)) {
+            distances[neighbor] = std::min(distances[neighbor], distances[id] + 1);
+        }
+    });
+    if (tree.distances != distances || tree.parents.size() != graph.id_bound() || tree.parents[source] != NO_VERTEX) {
+        return false;
+    }
+    for (VertexId id = 0; id < graph.id_bound(); ++id) {
+        const VertexId parent = tree.parents[id];
+        if (id != source && distances[id] != UNREACHABLE &&
+            (parent == NO_VERTEX || distances[parent] + 1 != distances[id] || !graph.adjacent(parent, id))) {
+            return false;
+        }
+        if (distances[id] == UNREACHABLE && parent != NO_VERTEX) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool test_DirectionOptimizingBfs1() {
+    // Test the direction-optimizing breadth-first search on a small graph and the transpose of a snapshot
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < 6; ++i) {
+        graph.add_vertex(i);
+    }
+    graph.add_edge(0, 1);
+    graph.add_edge(0, 2);
+    graph.add_edge(1, 3);
+    graph.add_edge(2, 3);
+    graph.add_edge(3, 4);
+    graph.add_edge(5, 0);
+    const GraphCSR<size_t> csr = graph.freeze();
+    const GraphCSR<size_t> transpose = csr.transpose();
+    if (transpose.edge_count() != 6 || transpose.neighbor_ids(3).size() != 2 || !transpose.adjacent(3, 1) || transpose.adjacent(1, 3)) {
+        return false;
+    }
+
+    const BreadthFirstTree tree = direction_optimizing_bfs(csr, transpose, 0, 2);
+    const std::vector<size_t> expectedDistances{0, 1, 1, 2, 3, UNREACHABLE};
+    if (tree.distances != expectedDistances || tree.parents[4] != 3 || tree.parents[5] != NO_VERTEX || !check_breadth_first_tree(csr, 0, tree)) {
+        return false;
+    }
+    try {
+        static_cast<void>(direction_optimizing_bfs(csr, 6));
+        return false;
+    } catch (const VertexNotFoundException&) {
+    }
+    return true;
+}
+
+bool test_DirectionOptimizingBfs2() {
+    // Test the direction-optimizing breadth-first search on a larger graph that needs bottom-up steps,
+    // with freed ids and several thread counts
+    constexpr size_t vertexCount = 5000;
+    GraphAdjacencyList<size_t> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::uint64_t state = 42;
+    for (size_t i = 0; i < vertexCount * 8; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        // skewed sources and targets, so a few vertices have a high degree
+        const size_t source = ((state >> 33U) % vertexCount) * ((state >> 20U) % 4 == 0 ? 1 : 0);
+        const size_t target = (state >> 40U) % vertexCount;
+        graph.set_edge_weight(source == 0 ? (state >> 12U) % vertexCount : source, target, 1.0);
+    }
+    for (size_t i = 0; i < vertexCount; i += 97) {
+        graph.remove_vertex(i + 1);
+    }
+
+    const GraphCSR<size_t> csr = graph.freeze();
+    const GraphCSR<size_t> transpose = csr.transpose();
+    for (const size_t threadCount : {1, 3, 0}) {
+        if (!check_breadth_first_tree(csr, 0, direction_optimizing_bfs(csr, transpose, 0, threadCount))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_DirectionOptimizingBfs3() {
+    // Test the direction-optimizing breadth-first search with more threads than frontier vertices and bitmap words,
+    // so some threads get no block in a step
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < 1006; ++i) {
+        graph.add_vertex(i);
+    }
+    for (size_t i = 1; i <= 4; ++i) {
+        graph.add_edge(0, i);
+    }
+    graph.add_edge(4, 5);
+    // a separate chain, so most edges are never reached from the source
+    for (size_t i = 6; i + 1 < 1006; ++i) {
+        graph.add_edge(i, i + 1);
+    }
+
+    const GraphCSR<size_t> csr = graph.freeze();
+    const GraphCSR<size_t> transpose = csr.transpose();
+    for (const size_t threadCount : {2, 4, 8, 64}) {
+        const BreadthFirstTree tree = direction_optimizing_bfs(csr, transpose, 0, threadCount);
+        if (!check_breadth_first_tree(csr, 0, tree) || tree.distances[5] != 2 || std::ranges::count(tree.distances, UNREACHABLE) != 1000) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_ConcurrentGraph1() {
+    // Test snapshots, versions, and failed updates of a concurrent graph
+    ConcurrentGraph<GraphAdjacencyList<int>> graph;
+    graph.update([](GraphAdjacencyList<int>& batch) {
+        batch.add_vertex(1);
+        batch.add_vertex(2);
+    });
+    const std::shared_ptr<const ConcurrentGraph<GraphAdjacencyList<int>>::Snapshot> before = graph.snapshot();
+    if (graph.update([](GraphAdjacencyList<int>& batch) { batch.set_edge_weight(1, 2, 5.0); }) != 2) {
+        return false;
+    }
+
+    // a snapshot never changes while it is held
+    if (before->version != 1 || before->graph.adjacent(1, 2) || graph.snapshot()->graph.get_edge_weight(1, 2) != 5.0) {
+        return false;
+    }
+
+    // a batch that throws publishes nothing
+    try {
+        graph.update([](GraphAdjacencyList<int>& batch) {
+            batch.set_edge_weight(2, 1, 1.0);
+            batch.add_vertex(1);
+        });
+        return false;
+    } catch (const VertexAlreadyExistsException&) {
+    }
+    return graph.version() == 2 && !graph.snapshot()->graph.adjacent(2, 1);
+}
+
+bool test_ConcurrentGraph2() {
+    // Test that concurrent readers never see a partially applied batch
+    constexpr size_t vertexCount = 50;
+    constexpr size_t batchCount = 200;
+    constexpr size_t readerCount = 3;
+    GraphAdjacencyList<size_t> initial;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        initial.add_vertex(i);
+    }
+    ConcurrentGraph<GraphAdjacencyList<size_t>> graph{initial};
+
+    std::atomic<bool> done = false;
+    std::atomic<bool> torn = false;
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < readerCount; ++r) {
+        readers.emplace_back([&graph, &done, &torn] {
+            size_t lastVersion = 0;
+            while (!done.load()) {
+                // every batch sets the weights of all edges to its version, in both directions
+                const auto snapshot = graph.snapshot();
+                if (snapshot->version < lastVersion) {
+                    torn = true;
+                }
+                lastVersion = snapshot->version;
+                for (VertexId id = 0; id < vertexCount; ++id) {
+                    snapshot->graph.for_each_neighbor(id, [&snapshot, &torn, id](const VertexId neighbor, const double weight) {
+                        if (weight != static_cast<double>(snapshot->version) || snapshot->graph.get_edge_weight(neighbor, id) != weight) {
+                            torn = true;
+                        }
+                    });
+                }
+            }
+        });
+    }
+    for (size_t version = 1; version <= batchCount; ++version) {
+        graph.update([version](GraphAdjacencyList<size_t>& batch) {
+            for (size_t i = 0; i < vertexCount; ++i) {
+                for (const size_t neighbor : batch.neighbors(i)) {
+                    batch.set_edge_weight(i, neighbor, static_cast<double>(version));
+                }
+            }
+            const size_t source = (version * 7) % vertexCount;
+            const size_t target = (version * 13 + 1) % vertexCount;
+            if (source != target) {
+                batch.set_edge_weight(source, target, static_cast<double>(version));
+                batch.set_edge_weight(target, source, static_cast<double>(version));
+            }
+        });
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    return !torn && graph.version() == batchCount;
+}
+
+bool test_GraphAdjacencyBitMatrix1() {
+    // Test that the bit matrix stores the same edges as an unweighted adjacency list (across word boundaries,
+    // reallocations, removals, and compaction)
+    GraphAdjacencyBitMatrix<int> bits;
+    GraphAdjacencyList<int, Unweighted> list;
+    constexpr int vertexCount = 150;
+    for (Graph<int, Unweighted>* graph : std::initializer_list<Graph<int, Unweighted>*>{&bits, &list}) {
+        graph->set_removal_mode(RemovalMode::Tombstone);
+        for (int i = 0; i < vertexCount; ++i) {
+            graph->add_vertex(i);
+        }
+        unsigned int state = 7;
+        for (int step = 0; step < 3000; ++step) {
+            state = state * 1103515245U + 12345U;
+            const int source = static_cast<int>((state >> 8U) % vertexCount);
+            const int target = static_cast<int>((state >> 18U) % vertexCount);
+            if (graph->find_vertex(source) && graph->find_vertex(target)) {
+                if (step % 5 != 0) {
+                    graph->set_edge_weight(source, target, Unweighted{});
+                } else if (graph->adjacent(source, target)) {
+                    graph->remove_edge(source, target);
+                }
+            }
+            if (step % 300 == 299 && graph->find_vertex(source)) {
+                graph->remove_vertex(source);
+            }
+        }
+        graph->add_vertex(vertexCount);
+        graph->compact();
+    }
+
+    if (bits.size() != list.size() || bits.id_bound() != bits.size()) {
+        return false;
+    }
+    size_t edgeCount = 0;
+    for (VertexId id = 0; id < bits.id_bound(); ++id) {
+        const int value = bits.value_of(id);
+        std::vector<int> actual = bits.neighbors(value);
+        std::vector<int> expected = list.neighbors(value);
+        std::ranges::sort(actual);
+        std::ranges::sort(expected);
+        if (actual != expected || bits.degree(id) != expected.size()) {
+            return false;
+        }
+        std::vector<VertexId> rangeIds;
+        for (const Neighbor<int, Unweighted>& neighbor : bits.neighbor_range(id)) {
+            rangeIds.push_back(neighbor.id);
+        }
+        if (rangeIds != bits.neighbors_by_id(id)) {
+            return false;
+        }
+        edgeCount += bits.degree(id);
+    }
+    return edgeCount > 1000 && bits.get_edge_weight(VertexId{0}, bits.neighbors(VertexId{0}).front()) == 1.0 &&
+           bits.neighbors(vertexCount).empty();
+}
+
+bool test_GraphAdjacencyBitMatrix2() {
+    // Test the common neighbor count, the Jaccard similarity, and the triangle count
+    GraphAdjacencyBitMatrix<size_t> graph;
+    constexpr size_t vertexCount = 130;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::uint64_t state = 3;
+    for (size_t i = 0; i < vertexCount * 10; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const size_t u = (state >> 20U) % vertexCount;
+        const size_t v = (state >> 40U) % vertexCount;
+        if (u != v) {
+            graph.set_edge_weight(u, v, Unweighted{});
+            graph.set_edge_weight(v, u, Unweighted{});
+        }
+    }
+
+    size_t triangles = 0;
+    for (size_t u = 0; u < vertexCount; ++u) {
+        for (size_t v = 0; v < vertexCount; ++v) {
+            size_t common = 0;
+            size_t either = 0;
+            for (size_t w = 0; w < vertexCount; ++w) {
+                common += graph.adjacent(u, w) && graph.adjacent(v, w) ? 1 : 0;
+                either += graph.adjacent(u, w) || graph.adjacent(v, w) ? 1 : 0;
+                triangles += u < v && v < w && graph.adjacent(u, v) && graph.adjacent(u, w) && graph.adjacent(v, w) ? 1 : 0;
+            }
+            const double jaccard = either == 0 ? 0.0 : static_cast<double>(common) / static_cast<double>(either);
+            if (graph.common_neighbor_count(u, v) != common || graph.jaccard(u, v) != jaccard) {
+                return false;
+            }
+        }
+    }
+    if (graph.triangle_count() != triangles || triangles == 0) {
+        return false;
+    }
+
+    // a triangle and an isolated vertex
+    GraphAdjacencyBitMatrix<char> small;
+    for (const char vertex : {'a', 'b', 'c', 'd'}) {
+        small.add_vertex(vertex);
+    }
+    for (const auto& [u, v] : {std::pair{'a', 'b'}, std::pair{'b', 'c'}, std::pair{'a', 'c'}}) {
+        small.add_edge(u, v);
+        small.add_edge(v, u);
+    }
+    return small.triangle_count() == 1 && small.jaccard(small.id_of('d'), small.id_of('d')) == 0.0 &&
+           small.jaccard(small.id_of('a'), small.id_of('b')) == 1.0 / 3.0 && small.neighbor_bits(small.id_of('a')).size() == 1 &&
+           small.neighbor_bits(small.id_of('a'))[0] == 0b110U;
+}
+
+bool test_BulkEdges1() {
+    // Test the duplicate policies of add_edges
+    GraphAdjacencyList<char> graph;
+    for (const char vertex : {'a', 'b', 'c'}) {
+        graph.add_vertex(vertex);
+    }
+    graph.set_edge_weight('a', 'b', 5.0);
+
+    const std::vector<Edge<char>> repeated = {{'b', 'c', 1.0}, {'c', 'a', 2.0}, {'b', 'c', 3.0}};
+    const std::vector<Edge<char>> existing = {{'a', 'b', 1.0}, {'a', 'c', 2.0}};
+    const std::vector<Edge<char>> missing = {{'a', 'c', 1.0}, {'a', 'z', 1.0}};
+    for (const std::span<const Edge<char>> edges : {std::span<const Edge<char>>(repeated), std::span<const Edge<char>>(existing)}) {
+        try {
+            graph.add_edges(edges);
+            return false;
+        } catch (const EdgeAlreadyExistsException&) {}
+    }
+    try {
+        graph.add_edges(missing, DuplicatePolicy::Sum);
+        return false;
+    } catch (const VertexNotFoundException&) {}
+    // nothing was added by the failed batches
+    if (graph.neighbors('a') != std::vector{'b'} || !graph.neighbors('b').empty() || !graph.neighbors('c').empty()) {
+        return false;
+    }
+
+    GraphAdjacencyList<char> keepFirst = graph;
+    keepFirst.add_edges(repeated, DuplicatePolicy::KeepFirst);
+    keepFirst.add_edges(existing, DuplicatePolicy::KeepFirst);
+    if (keepFirst.get_edge_weight('b', 'c') != 1.0 || keepFirst.get_edge_weight('c', 'a') != 2.0 ||
+        keepFirst.get_edge_weight('a', 'b') != 5.0 || keepFirst.get_edge_weight('a', 'c') != 2.0) {
+        return false;
+    }
+
+    GraphAdjacencyList<char> sum = graph;
+    sum.add_edges(repeated, DuplicatePolicy::Sum);
+    sum.add_edges(existing, DuplicatePolicy::Sum);
+    // a resulting weight of 0 keeps the edge
+    const std::vector<Edge<char>> cancel = {{'c', 'a', -1.0}, {'c', 'a', -1.0}, {'c', 'b', 0.0}};
+    sum.add_edges(cancel, DuplicatePolicy::Sum);
+    return sum.get_edge_weight('b', 'c') == 4.0 && sum.get_edge_weight('a', 'b') == 6.0 && sum.get_edge_weight('a', 'c') == 2.0 &&
+           sum.try_get_edge_weight('c', 'a') == 0.0 && sum.try_get_edge_weight('c', 'b') == 0.0;
+}
+
+bool test_BulkEdges2() {
+    // Test that a batch built in parallel matches the same edges added one by one, for every representation
+    constexpr size_t vertexCount = 300;
+    constexpr size_t edgeCount = 60000;
+    std::vector<Edge<size_t>> edges;
+    std::uint64_t state = 11;
+    for (size_t i = 0; i < edgeCount; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        edges.push_back({(state >> 20U) % vertexCount, (state >> 40U) % vertexCount, static_cast<double>(1 + i % 7)});
+    }
+
+    GraphAdjacencyList<size_t> expected;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        expected.add_vertex(i);
+    }
+    for (const Edge<size_t>& edge : edges) {
+        expected.set_edge_weight(edge.source, edge.target, expected.get_edge_weight(edge.source, edge.target) + edge.weight);
+    }
+    const auto matches = [&expected](const Graph<size_t>& graph) {
+        if (graph.size() != vertexCount) {
+            return false;
+        }
+        for (size_t u = 0; u < vertexCount; ++u) {
+            for (size_t v = 0; v < vertexCount; ++v) {
+                if (graph.get_edge_weight(u, v) != expected.get_edge_weight(u, v)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    GraphBuilder<size_t> builder;
+    builder.add_edges(edges);
+    constexpr size_t threadCount = 4;
+    GraphIncidenceMatrix<size_t> sparse(IncidenceStorage::Sparse);
+    builder.build_into(sparse, DuplicatePolicy::Sum, threadCount);
+    if (!matches(builder.build<GraphAdjacencyList<size_t>>(DuplicatePolicy::Sum, threadCount)) ||
+        !matches(builder.build<GraphAdjacencyMatrix<size_t>>(DuplicatePolicy::Sum, threadCount)) || !matches(sparse)) {
+        return false;
+    }
+
+    // vertices of the edges are added in the order they are first seen, after the explicit ones
+    GraphBuilder<std::string> small;
+    small.add_vertex("isolated").add_edge("x", "y", 2.0).add_edge("y", "x").add_edge("x", "y", 3.0);
+    const auto dense = small.build<GraphIncidenceMatrix<std::string>>(DuplicatePolicy::KeepFirst);
+    return dense.size() == 3 && dense.id_of("isolated") == 0 && dense.id_of("x") == 1 && dense.id_of("y") == 2 &&
+           dense.get_edge_weight("x", "y") == 2.0 && dense.get_edge_weight("y", "x") == 1.0 && dense.neighbors("isolated").empty();
+}
+
+bool test_BinaryFile1() {
+    // Test that a graph loaded from a binary file has the same vertices, ids, and edges as the saved one
+    GraphAdjacencyList<int> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (int i = 0; i < 200; ++i) {
+        graph.add_vertex(i * 7);
+    }
+    for (int i = 0; i < 200; ++i) {
+        graph.set_edge_weight(i * 7, (i * 31 % 200) * 7, 1.0 + i);
+        graph.set_edge_weight(i * 7, (i * 17 % 200) * 7, 0.5);
+    }
+    // ids freed by removals leave holes
+    graph.remove_vertex(21);
+    graph.remove_vertex(700);
+
+    const std::string path = std::filesystem::temp_directory_path() / "graph_test_BinaryFile1.bin";
+    graph.save_binary(path);
+    const GraphCSR<int> expected = graph.freeze();
+    std::optional<GraphCSR<int>> loaded = GraphCSR<int>::load_mmap(path);
+    // copies share the mapping, which stays valid after the original is gone
+    const GraphCSR<int> copy = *loaded;
+    loaded.reset();
+    std::filesystem::remove(path);
+
+    if (copy.size() != expected.size() || copy.id_bound() != expected.id_bound() || copy.edge_count() != expected.edge_count()) {
+        return false;
+    }
+    for (VertexId id = 0; id < expected.id_bound(); ++id) {
+        if (copy.contains_id(id) != expected.contains_id(id)) {
+            return false;
+        }
+        if (expected.contains_id(id) &&
+            (copy.value_of(id) != expected.value_of(id) || copy.id_of(expected.value_of(id)) != id ||
+             !std::ranges::equal(copy.neighbor_ids(id), expected.neighbor_ids(id)) ||
+             !std::ranges::equal(copy.neighbor_weights(id), expected.neighbor_weights(id)))) {
+            return false;
+        }
+    }
+    try {
+        static_cast<void>(copy.id_of(21));
+        return false;
+    } catch (const VertexNotFoundException&) {}
+
+    const GraphCSR<int> transpose = copy.transpose();
+    return transpose.get_edge_weight(31 * 7, 7) == 2.0 && copy.get_edge_weight(7, 31 * 7) == 2.0 &&
+           dijkstra(copy, copy.id_of(0)).distances == dijkstra(expected, expected.id_of(0)).distances;
+}
+
+bool test_BinaryFile2() {
+    // Test that missing, foreign, and truncated files are rejected
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string path = directory / "graph_test_BinaryFile2.bin";
+    const auto rejected = [](const auto load) {
+        try {
+            static_cast<void>(load());
+            return false;
+        } catch (const GraphFileException&) {
+            return true;
+        }
+    };
+    if (!rejected([&directory] { return GraphCSR<int>::load_mmap(directory / "graph_test_missing.bin"); })) {
+        return false;
+    }
+
+    GraphAdjacencyList<std::int64_t> graph;
+    graph.add_vertex(1);
+    graph.add_vertex(2);
+    graph.add_edge(1, 2);
+    graph.save_binary(path);
+    const GraphCSR<std::int64_t> loaded = GraphCSR<std::int64_t>::load_mmap(path);
+    if (loaded.size() != 2 || !loaded.adjacent(std::int64_t{1}, std::int64_t{2}) || loaded.adjacent(std::int64_t{2}, std::int64_t{1})) {
+        return false;
+    }
+    // the vertices have another size
+    if (!rejected([&path] { return GraphCSR<std::int32_t>::load_mmap(path); })) {
+        return false;
+    }
+    // the weights have another size
+    if (!rejected([&path] { return GraphCSR<std::int64_t, float>::load_mmap(path); })) {
+        return false;
+    }
+    // corrupted arrays: the header takes 72 bytes, followed by the offsets (0, 1, 1), the target (1), the weight,
+    // the presence flags, the values, and the hash table of the index
+    const auto corrupted = [&path, &rejected](const std::streamoff position, const std::uint64_t word) {
+        std::ifstream input(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        input.close();
+        std::memcpy(bytes.data() + position, &word, sizeof(word));
+        const std::string copy = path + ".corrupted";
+        std::ofstream(copy, std::ios::binary) << bytes;
+        const bool result = rejected([&copy] { return GraphCSR<std::int64_t>::load_mmap(copy); });
+        std::filesystem::remove(copy);
+        return result;
+    };
+    // rewriting an offset with its own value keeps the file valid
+    if (corrupted(80, 1) || !corrupted(80, 2) || !corrupted(96, 2) || !corrupted(136, 2)) {
+        return false;
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    if (!rejected([&path] { return GraphCSR<std::int64_t>::load_mmap(path); })) {
+        return false;
+    }
+    std::ofstream(path, std::ios::trunc) << "not a graph, but long enough to hold a whole header of a graph file";
+    const bool garbage = rejected([&path] { return GraphCSR<std::int64_t>::load_mmap(path); });
+    std::filesystem::remove(path);
+
+    // an empty graph round-trips too
+    GraphAdjacencyMatrix<char> empty;
+    empty.save_binary(path);
+    const GraphCSR<char> emptyLoaded = GraphCSR<char>::load_mmap(path);
+    std::filesystem::remove(path);
+    return garbage && emptyLoaded.empty() && emptyLoaded.id_bound() == 0 && emptyLoaded.edge_count() == 0 &&
+           !emptyLoaded.contains_id(0);
+}
+
+bool test_EdgeListReader1() {
+    // Test reading a SNAP edge list, with small chunks and several threads
+    const std::string path = std::filesystem::temp_directory_path() / "graph_test_EdgeListReader1.txt";
+    std::ofstream(path) << "# Directed graph\n# FromNodeId\tToNodeId\n"
+                        << "1 2\n2\t3 2.5\r\n\n  3 1 -1e-1 1700000000\n# comment\n4 4\n";
+    GraphBuilder<int> builder;
+    const EdgeListStats stats = EdgeListReader<int>(EdgeListFormat::Snap, 1).read(path, builder);
+    const auto graph = builder.build<GraphAdjacencyList<int>>();
+    if (stats.edges != 4 || stats.bytes != std::filesystem::file_size(path) || graph.size() != 4 ||
+        graph.get_edge_weight(1, 2) != 1.0 || graph.get_edge_weight(2, 3) != 2.5 || graph.get_edge_weight(3, 1) != -0.1 ||
+        graph.get_edge_weight(4, 4) != 1.0 || graph.id_of(1) != 0 || graph.id_of(2) != 1) {
+        return false;
+    }
+
+    // lines split between chunks and threads give the same edges
+    std::ofstream file(path, std::ios::trunc);
+    std::uint64_t state = 5;
+    for (size_t i = 0; i < 5000; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        file << (state >> 20U) % 1000 << (i % 2 == 0 ? " " : "\t") << (state >> 40U) % 1000 << ' ' << i % 13 + 1 << '\n';
+        if (i % 100 == 0) {
+            file << "# checkpoint " << i << '\n';
+        }
+    }
+    file.close();
+    GraphBuilder<std::uint32_t> sequential;
+    GraphBuilder<std::uint32_t> parallel;
+    static_cast<void>(EdgeListReader<std::uint32_t>(EdgeListFormat::Snap, 1).read(path, sequential));
+    const EdgeListStats parallelStats = EdgeListReader<std::uint32_t>(EdgeListFormat::Snap, 3, 777).read(path, parallel);
+    const auto expected = sequential.build<GraphAdjacencyList<std::uint32_t>>(DuplicatePolicy::Sum);
+    const auto actual = parallel.build<GraphAdjacencyList<std::uint32_t>>(DuplicatePolicy::Sum);
+    if (parallelStats.edges != 5000 || actual.size() != expected.size() || parallelStats.megabytes_per_second() <= 0.0) {
+        return false;
+    }
+    for (VertexId id = 0; id < expected.id_bound(); ++id) {
+        for (const std::uint32_t neighbor : expected.neighbors(expected.value_of(id))) {
+            if (actual.get_edge_weight(expected.value_of(id), neighbor) != expected.get_edge_weight(expected.value_of(id), neighbor)) {
+                return false;
+            }
+        }
+        if (actual.neighbors(expected.value_of(id)).size() != expected.neighbors(expected.value_of(id)).size()) {
+            return false;
+        }
+    }
+
+    std::ofstream(path, std::ios::trunc) << "1 2\n3 x\n";
+    try {
+        GraphBuilder<int> malformed;
+        static_cast<void>(EdgeListReader<int>().read(path, malformed));
+        return false;
+    } catch (const GraphFileException&) {}
+    std::filesystem::remove(path);
+    return true;
+}
+
+bool test_EdgeListReader2() {
+    // Test reading Matrix Market files
+    const std::string path = std::filesystem::temp_directory_path() / "graph_test_EdgeListReader2.mtx";
+    std::ofstream(path) << "%%MatrixMarket matrix coordinate real symmetric\n% comment\n\n5 4 3\n2 1 1.5\n3 3 2\n4 1 -2\n";
+    GraphBuilder<size_t> builder;
+    const EdgeListStats stats = EdgeListReader<size_t>(EdgeListFormat::MatrixMarket).read(path, builder);
+    const auto symmetric = builder.build<GraphAdjacencyList<size_t>>();
+    // vertex 5 has no edges, but is a row of the matrix
+    if (stats.edges != 5 || symmetric.size() != 5 || symmetric.get_edge_weight(2, 1) != 1.5 || symmetric.get_edge_weight(1, 2) != 1.5 ||
+        symmetric.get_edge_weight(3, 3) != 2.0 || symmetric.get_edge_weight(1, 4) != -2.0 || !symmetric.neighbors(size_t{5}).empty()) {
+        return false;
+    }
+
+    std::ofstream(path, std::ios::trunc) << "%%MatrixMarket Matrix Coordinate Pattern Skew-Symmetric\n5 5 1\n1 2\n";
+    GraphBuilder<size_t> patternBuilder;
+    static_cast<void>(EdgeListReader<size_t>(EdgeListFormat::MatrixMarket).read(path, patternBuilder));
+    const auto pattern = patternBuilder.build<GraphAdjacencyMatrix<size_t>>();
+    if (pattern.size() != 5 || pattern.get_edge_weight(1, 2) != 1.0 || pattern.get_edge_weight(2, 1) != -1.0) {
+        return false;
+    }
+
+    for (const std::string contents : {"%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n4\n", "1 2\n", "%%MatrixMarket matrix coordinate real general\n"}) {
+        std::ofstream(path, std::ios::trunc) << contents;
+        try {
+            GraphBuilder<size_t> rejected;
+            static_cast<void>(EdgeListReader<size_t>(EdgeListFormat::MatrixMarket).read(path, rejected));
+            return false;
+        } catch (const GraphFileException&) {}
+    }
+    std::filesystem::remove(path);
+    return true;
+}
+
+bool test_ConnectedComponents1() {
+    // Test the components of a small directed graph, with removed vertices
+    GraphAdjacencyList<char> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (const char vertex : {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'}) {
+        graph.add_vertex(vertex);
+    }
+    // {a, b, c} (only weakly connected), {d, e}, {f}, {h}, and g is removed
+    graph.add_edge('b', 'a');
+    graph.add_edge('b', 'c');
+    graph.add_edge('e', 'd');
+    graph.add_edge('e', 'e');
+    graph.add_edge('g', 'h');
+    graph.add_edge('f', 'g');
+    graph.remove_vertex('g');
+
+    const Components components = connected_components(graph, 3);
+    const auto label = [&graph, &components](const char vertex) {
+        return components.labels[graph.id_of(vertex)];
+    };
+    const std::vector<size_t> expected{0, 0, 0, 1, 1, 2, 3};
+    std::vector<size_t> labels;
+    for (const char vertex : {'a', 'b', 'c', 'd', 'e', 'f', 'h'}) {
+        labels.push_back(label(vertex));
+    }
+    return components.count == 4 && labels == expected && components.labels.size() == graph.id_bound() &&
+           components.labels[6] == NO_COMPONENT;
+}
+
+bool test_ConnectedComponents2() {
+    // Test that the parallel search matches a sequential one on a random sparse graph, for every thread count
+    constexpr size_t vertexCount = 20000;
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::uint64_t state = 17;
+    for (size_t i = 0; i < vertexCount * 6 / 10; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        graph.set_edge_weight((state >> 20U) % vertexCount, (state >> 40U) % vertexCount, 1.0);
+    }
+    const GraphCSR<size_t> csr = graph.freeze();
+    const GraphCSR<size_t> transpose = csr.transpose();
+
+    // label by breadth-first searches following edges in both directions
+    std::vector<size_t> expected(vertexCount, NO_COMPONENT);
+    size_t count = 0;
+    for (VertexId start = 0; start < vertexCount; ++start) {
+        if (expected[start] != NO_COMPONENT) {
+            continue;
+        }
+        std::vector<VertexId> queue{start};
+        expected[start] = count;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            for (const GraphCSR<size_t>* side : {&csr, &transpose}) {
+                for (const VertexId neighbor : side->neighbor_ids(queue[head])) {
+                    if (expected[neighbor] == NO_COMPONENT) {
+                        expected[neighbor] = count;
+                        queue.push_back(neighbor);
+                    }
+                }
+            }
+        }
+        ++count;
+    }
+
+    for (const size_t threads : {1, 2, 4, 7}) {
+        const Components components = connected_components(csr, threads);
+        if (components.count != count || components.labels != expected) {
+            return false;
+        }
+    }
+    UnionFind sets(4);
+    return count > 1000 && count < vertexCount && sets.unite(3, 1) && !sets.unite(1, 3) && sets.find(3) == 1 && sets.find(2) == 2;
+}
+
+bool test_FloydWarshall1() {
+    // Test distances and paths with negative weights, on an adjacency matrix and an adjacency list
+    GraphAdjacencyMatrix<char> matrix;
+    GraphAdjacencyList<char> list;
+    for (const char vertex : {'a', 'b', 'c', 'd', 'e'}) {
+        matrix.add_vertex(vertex);
+        list.add_vertex(vertex);
+    }
+    for (const auto& [vertex1, vertex2, weight] : {std::tuple{'a', 'b', 4.0}, std::tuple{'a', 'c', 1.0}, std::tuple{'c', 'b', -2.0},
+                                                   std::tuple{'b', 'd', 3.0}, std::tuple{'d', 'a', 2.0}, std::tuple{'a', 'a', 5.0},
+                                                   std::tuple{'e', 'd', 0.0}}) {
+        matrix.set_edge_weight(vertex1, vertex2, weight);
+        list.set_edge_weight(vertex1, vertex2, weight);
+    }
+    const AllPairsShortestPaths paths = floyd_warshall(matrix, 2);
+    const AllPairsShortestPaths listPaths = floyd_warshall(list);
+    if (paths.distances != listPaths.distances || paths.next != listPaths.next || paths.size != 5) {
+        return false;
+    }
+    const auto id = [&matrix](const char vertex) {
+        return matrix.id_of(vertex);
+    };
+    const std::vector<VertexId> expectedPath{id('d'), id('a'), id('c'), id('b')};
+    return paths.distance(id('a'), id('b')) == -1.0 && paths.distance(id('d'), id('b')) == 1.0 && paths.distance(id('b'), id('a')) == 5.0 &&
+           paths.distance(id('a'), id('a')) == 0.0 && paths.distance(id('a'), id('e')) == std::numeric_limits<double>::infinity() &&
+           reconstruct_path(paths, id('d'), id('b')) == expectedPath && reconstruct_path(paths, id('a'), id('e')).empty() &&
+           reconstruct_path(paths, id('e'), id('e')) == std::vector{id('e')} && paths.distance(id('e'), id('d')) == 0.0 &&
+           paths.distance(id('e'), id('b')) == 1.0;
+}
+
+bool test_FloydWarshall2() {
+    // Test that the tiled search matches Dijkstra's algorithm on a random graph spanning several tiles
+    constexpr size_t vertexCount = 150;
+    GraphAdjacencyMatrix<size_t> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::uint64_t state = 23;
+    for (size_t i = 0; i < vertexCount * 4; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        graph.set_edge_weight((state >> 20U) % vertexCount, (state >> 40U) % vertexCount, static_cast<double>(1 + (state >> 60U)));
+    }
+    graph.remove_vertex(70);
+
+    for (const size_t threads : {1, 3}) {
+        const AllPairsShortestPaths paths = floyd_warshall(graph, threads);
+        for (VertexId source = 0; source < vertexCount; ++source) {
+            if (!graph.contains_id(source)) {
+                continue;
+            }
+            const ShortestPaths expected = dijkstra(graph, source);
+            for (VertexId target = 0; target < vertexCount; ++target) {
+                const double distance = paths.distance(source, target);
+                if (target == 70 ? distance != std::numeric_limits<double>::infinity() : distance != expected.distances[target]) {
+                    return false;
+                }
+                // the reconstructed path has the same length
+                const std::vector<VertexId> path = reconstruct_path(paths, source, target);
+                double length = 0.0;
+                for (size_t i = 0; i + 1 < path.size(); ++i) {
+                    length += graph.get_edge_weight(path[i], path[i + 1]);
+                }
+                if (!path.empty() && length != distance) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool test_PageRank1() {
+    // Test the ranks of small graphs: a cycle, and a graph with a dangling vertex, an isolated vertex and a removed vertex
+    GraphAdjacencyList<int> cycle;
+    for (int i = 0; i < 3; ++i) {
+        cycle.add_vertex(i);
+    }
+    for (int i = 0; i < 3; ++i) {
+        cycle.add_edge(i, (i + 1) % 3);
+    }
+    const PageRanks cycleRanks = pagerank(cycle.freeze(), 0.85, 1e-12, 100, 2);
+    for (const double rank : cycleRanks.ranks) {
+        if (std::abs(rank - 1.0 / 3.0) > 1e-12) {
+            return false;
+        }
+    }
+
+    GraphAdjacencyList<int> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (int i = 0; i < 5; ++i) {
+        graph.add_vertex(i);
+    }
+    graph.add_edge(0, 1);
+    graph.add_edge(0, 2);
+    graph.add_edge(1, 2);
+    graph.add_edge(3, 0);
+    graph.add_edge(4, 0);
+    graph.remove_vertex(4);
+    // 2 is dangling and 3 has no incoming edges, so with teleport t = 0.15 / 4 and dangling share s = 0.85 * r2 / 4:
+    // r3 = t + s, r0 = r3 + 0.85 * r3, r1 = r3 + 0.85 * r0 / 2, r2 = r3 + 0.85 * (r0 / 2 + r1)
+    const PageRanks ranks = pagerank(graph.freeze(), 0.85, 1e-12, 1000, 3);
+    const std::vector<double>& r = ranks.ranks;
+    const double sum = std::reduce(r.begin(), r.end());
+    const double r3 = 0.15 / 4 + 0.85 * r[2] / 4;
+    return ranks.converged && ranks.iterations < 1000 && ranks.residual < 1e-12 && r.size() == 5 && r[4] == 0.0 &&
+           std::abs(sum - 1.0) < 1e-9 && std::abs(r[3] - r3) < 1e-9 && std::abs(r[0] - 1.85 * r3) < 1e-9 &&
+           std::abs(r[1] - (r3 + 0.85 * r[0] / 2)) < 1e-9 && std::abs(r[2] - (r3 + 0.85 * (r[0] / 2 + r[1]))) < 1e-9 &&
+           ranks.seconds.size() == ranks.iterations && ranks.edges == 4;
+}
+
+bool test_PageRank2() {
+    // Test multiply() and the parallel ranks against sequential computations on a random graph with skewed degrees
+    constexpr size_t vertexCount = 5000;
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::uint64_t state = 5;
+    for (size_t i = 0; i < vertexCount * 8; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        // sources are skewed towards small ids, so a few vertices have most of the edges
+        const size_t source = ((state >> 20U) % vertexCount) * ((state >> 50U) % 16) / 16;
+        graph.set_edge_weight(source, (state >> 34U) % vertexCount, static_cast<double>(i % 5));
+    }
+    const GraphCSR<size_t> csr = graph.freeze();
+
+    std::vector<double> x(vertexCount);
+    std::vector<double> expected(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        x[i] = static_cast<double>(i % 7) - 3.0;
+    }
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const std::span<const VertexId> targets = csr.neighbor_ids(i);
+        const std::span<const double> weights = csr.neighbor_weights(i);
+        for (size_t j = 0; j < targets.size(); ++j) {
+            expected[i] += weights[j] * x[targets[j]];
+        }
+    }
+    for (const size_t threads : {1, 3, 8}) {
+        std::vector<double> y(vertexCount, -1.0);
+        csr.multiply(x, y, threads);
+        if (y != expected) {
+            return false;
+        }
+    }
+
+    // push-based power iteration
+    std::vector<double> ranks(vertexCount, 1.0 / static_cast<double>(vertexCount));
+    for (size_t iteration = 0; iteration < 30; ++iteration) {
+        std::vector<double> next(vertexCount, 0.15 / static_cast<double>(vertexCount));
+        for (size_t i = 0; i < vertexCount; ++i) {
+            const std::span<const VertexId> targets = csr.neighbor_ids(i);
+            for (const VertexId target : targets) {
+                next[target] += 0.85 * ranks[i] / static_cast<double>(targets.size());
+            }
+            if (targets.empty()) {
+                for (double& rank : next) {
+                    rank += 0.85 * ranks[i] / static_cast<double>(vertexCount);
+                }
+            }
+        }
+        ranks = std::move(next);
+    }
+    for (const size_t threads : {1, 2, 5}) {
+        const PageRanks result = pagerank(csr, 0.85, 0.0, 30, threads);
+        if (result.converged || result.iterations != 30) {
+            return false;
+        }
+        for (size_t i = 0; i < vertexCount; ++i) {
+            if (std::abs(result.ranks[i] - ranks[i]) > 1e-12) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool test_AStar1() {
+    // Test A* on a grid with random weights against Dijkstra's algorithm, and that a good heuristic settles fewer vertices
+    constexpr int width = 40;
+    GraphAdjacencyList<int> graph;
+    for (int i = 0; i < width * width; ++i) {
+        graph.add_vertex(i);
+    }
+    std::uint64_t state = 3;
+    for (int i = 0; i < width * width; ++i) {
+        for (const int neighbor : {i + 1, i + width}) {
+            if ((neighbor == i + 1 && neighbor % width == 0) || neighbor >= width * width) {
+                continue;
+            }
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            // weights in [1, 2), so the Manhattan distance never overestimates
+            const double weight = 1.0 + static_cast<double>(state >> 40U) / static_cast<double>(1ULL << 24U);
+            graph.set_edge_weight(i, neighbor, weight);
+            graph.set_edge_weight(neighbor, i, weight);
+        }
+    }
+    const auto manhattan = [&graph](const VertexId target) {
+        return [&graph, target](const VertexId id) {
+            const int from = graph.value_of(id);
+            const int to = graph.value_of(target);
+            return static_cast<double>(std::abs(from % width - to % width) + std::abs(from / width - to / width));
+        };
+    };
+
+    for (const auto& [source, target] : {std::pair{0, width * width - 1}, std::pair{5 * width + 7, 30 * width + 2}, std::pair{12, 12}}) {
+        const VertexId sourceId = graph.id_of(source);
+        const VertexId targetId = graph.id_of(target);
+        const double expected = dijkstra(graph, sourceId).distances[targetId];
+        const PointToPointPath guided = a_star(graph, sourceId, targetId, manhattan(targetId));
+        const PointToPointPath blind = a_star(graph, sourceId, targetId, [](VertexId) {
+            return 0.0;
+        });
+        if (std::abs(guided.distance - expected) > 1e-9 || std::abs(blind.distance - expected) > 1e-9 ||
+            guided.vertices.front() != sourceId || guided.vertices.back() != targetId || guided.settled > blind.settled) {
+            return false;
+        }
+        double length = 0.0;
+        for (size_t i = 0; i + 1 < guided.vertices.size(); ++i) {
+            length += graph.get_edge_weight_by_id(guided.vertices[i], guided.vertices[i + 1]);
+        }
+        if (std::abs(length - expected) > 1e-9) {
+            return false;
+        }
+    }
+    const PointToPointPath guided = a_star(graph, 5 * width + 7, 30 * width + 2, manhattan(30 * width + 2));
+    const PointToPointPath blind = a_star(graph, 5 * width + 7, 30 * width + 2, [](VertexId) {
+        return 0.0;
+    });
+    if (guided.settled * 2 > blind.settled) {
+        return false;
+    }
+
+    // unreachable target, and errors
+    graph.add_vertex(-1);
+    const PointToPointPath unreachable = a_star(graph, 0, graph.id_of(-1), [](VertexId) {
+        return 0.0;
+    });
+    if (unreachable.distance != std::numeric_limits<double>::infinity() || !unreachable.vertices.empty() || unreachable.settled != static_cast<size_t>(width * width)) {
+        return false;
+    }
+    graph.set_edge_weight(0, 1, -1.0);
+    bool negativeThrown = false;
+    bool missingThrown = false;
+    try {
+        static_cast<void>(a_star(graph, 0, 5, [](VertexId) {
+            return 0.0;
+        }));
+    } catch (const NegativeEdgeWeightException&) {
+        negativeThrown = true;
+    }
+    try {
+        static_cast<void>(a_star(graph, 0, graph.id_bound(), [](VertexId) {
+            return 0.0;
+        }));
+    } catch (const VertexNotFoundException&) {
+        missingThrown = true;
+    }
+    return negativeThrown && missingThrown;
+}
+
+bool test_BidirectionalDijkstra1() {
+    // Test bidirectional Dijkstra against Dijkstra's algorithm on a random graph, on the graph and on its snapshot
+    constexpr size_t vertexCount = 3000;
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::uint64_t state = 11;
+    for (size_t i = 0; i < vertexCount * 3; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        graph.set_edge_weight((state >> 20U) % vertexCount, (state >> 40U) % vertexCount, static_cast<double>(state % 10));
+    }
+    const GraphCSR<size_t> csr = graph.freeze();
+    const GraphCSR<size_t> transpose = csr.transpose();
+
+    size_t reached = 0;
+    size_t settled = 0;
+    for (size_t query = 0; query < 40; ++query) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const VertexId source = (state >> 20U) % vertexCount;
+        const VertexId target = (state >> 40U) % vertexCount;
+        const double expected = dijkstra(graph, source).distances[target];
+        const PointToPointPath path = bidirectional_dijkstra(csr, transpose, source, target);
+        if (path.distance != expected || bidirectional_dijkstra(graph, source, target).distance != expected) {
+            return false;
+        }
+        if (expected == std::numeric_limits<double>::infinity()) {
+            if (!path.vertices.empty()) {
+                return false;
+            }
+            continue;
+        }
+        double length = 0.0;
+        for (size_t i = 0; i + 1 < path.vertices.size(); ++i) {
+            if (!csr.adjacent(path.vertices[i], path.vertices[i + 1])) {
+                return false;
+            }
+            length += csr.get_edge_weight(path.vertices[i], path.vertices[i + 1]);
+        }
+        if (path.vertices.front() != source || path.vertices.back() != target || length != expected) {
+            return false;
+        }
+        ++reached;
+        settled += path.settled;
+    }
+
+    const PointToPointPath same = bidirectional_dijkstra(csr, transpose, 7, 7);
+    bool missingThrown = false;
+    try {
+        static_cast<void>(bidirectional_dijkstra(csr, transpose, 0, vertexCount));
+    } catch (const VertexNotFoundException&) {
+        missingThrown = true;
+    }
+    // on average, far fewer vertices are settled than the whole graph
+    return reached > 20 && settled < reached * vertexCount / 4 && same.distance == 0.0 && same.vertices == std::vector<VertexId>{7} &&
+           missingThrown;
+}
+
+bool test_ContractionHierarchy1() {
+    // Test queries on a small directed graph, with a removed vertex, a self-loop and an unreachable vertex
+    GraphAdjacencyList<char> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (const char vertex : {'a', 'b', 'c', 'd', 'e', 'f', 'g'}) {
+        graph.add_vertex(vertex);
+    }
+    graph.set_edge_weight('a', 'b', 1.0);
+    graph.set_edge_weight('b', 'c', 2.0);
+    graph.set_edge_weight('c', 'd', 1.0);
+    graph.set_edge_weight('a', 'd', 5.0);
+    graph.set_edge_weight('d', 'e', 1.0);
+    graph.set_edge_weight('e', 'a', 1.0);
+    graph.set_edge_weight('b', 'b', 1.0);
+    graph.set_edge_weight('a', 'g', 1.0);
+    graph.set_edge_weight('g', 'e', 1.0);
+    graph.remove_vertex('g');
+
+    const ContractionHierarchy hierarchy(graph);
+    ContractionHierarchy::Query query(hierarchy);
+    const auto ids = [&graph](const std::string& vertices) {
+        std::vector<VertexId> result;
+        for (const char vertex : vertices) {
+            result.push_back(graph.id_of(vertex));
+        }
+        return result;
+    };
+    const PointToPointPath ad = query.shortest_path(graph.id_of('a'), graph.id_of('d'));
+    const PointToPointPath ea = query.shortest_path(graph.id_of('e'), graph.id_of('a'));
+    const PointToPointPath ca = query.shortest_path(graph.id_of('c'), graph.id_of('a'));
+    const PointToPointPath af = query.shortest_path(graph.id_of('a'), graph.id_of('f'));
+    const PointToPointPath bb = query.shortest_path(graph.id_of('b'), graph.id_of('b'));
+    bool missingThrown = false;
+    try {
+        static_cast<void>(query.shortest_path(graph.id_of('a'), 6));
+    } catch (const VertexNotFoundException&) {
+        missingThrown = true;
+    }
+    std::vector<size_t> ranks;
+    for (const VertexId id : ids("abcdef")) {
+        ranks.push_back(hierarchy.rank_of(id));
+    }
+    std::ranges::sort(ranks);
+    return ad.distance == 4.0 && ad.vertices == ids("abcd") && ea.distance == 1.0 && ea.vertices == ids("ea") && ca.distance == 3.0 &&
+           ca.vertices == ids("cdea") && af.distance == std::numeric_limits<double>::infinity() && af.vertices.empty() && bb.distance == 0.0 &&
+           bb.vertices == ids("b") && missingThrown && !hierarchy.contains_id(6) && ranks == std::vector<size_t>{0, 1, 2, 3, 4, 5};
+}
+
+bool test_ContractionHierarchy2() {
+    // Test queries against Dijkstra's algorithm on a grid with random weights and one-way streets
+    constexpr size_t width = 30;
+    constexpr size_t vertexCount = width * width;
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::uint64_t state = 23;
+    const auto next = [&state] {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 33U;
+    };
+    for (size_t i = 0; i < vertexCount; ++i) {
+        for (const size_t neighbor : {i + 1, i + width}) {
+            if ((neighbor == i + 1 && neighbor % width == 0) || neighbor >= vertexCount) {
+                continue;
+            }
+            // integer weights, so distances are exact and ties are frequent
+            graph.set_edge_weight(i, neighbor, static_cast<double>(1 + next() % 9));
+            if (next() % 5 != 0) {
+                graph.set_edge_weight(neighbor, i, static_cast<double>(1 + next() % 9));
+            }
+        }
+    }
+
+    const ContractionHierarchy hierarchy(graph);
+    ContractionHierarchy::Query query(hierarchy);
+    size_t settled = 0;
+    for (size_t i = 0; i < 200; ++i) {
+        const VertexId source = next() % vertexCount;
+        const VertexId target = next() % vertexCount;
+        const double expected = dijkstra(graph, source).distances[target];
+        const PointToPointPath path = query.shortest_path(source, target);
+        if (path.distance != expected || path.vertices.front() != source || path.vertices.back() != target) {
+            return false;
+        }
+        double length = 0.0;
+        for (size_t j = 0; j + 1 < path.vertices.size(); ++j) {
+            if (!graph.adjacent(path.vertices[j], path.vertices[j + 1])) {
+                return false;
+            }
+            length += graph.get_edge_weight(path.vertices[j], path.vertices[j + 1]);
+        }
+        if (length != expected) {
+            return false;
+        }
+        settled += path.settled;
+    }
+    return hierarchy.shortcut_count() > 0 && settled < 200 * vertexCount / 10;
+}
+
+bool test_StronglyConnectedComponents1() {
+    // Test the components of a small graph and their order, and of a chain too deep for a recursive search
+    GraphAdjacencyList<char> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (const char vertex : {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'}) {
+        graph.add_vertex(vertex);
+    }
+    // {a, b, c} -> {d, e} -> {f}, {a, b, c} -> {h}, g is removed
+    graph.add_edge('a', 'b');
+    graph.add_edge('b', 'c');
+    graph.add_edge('c', 'a');
+    graph.add_edge('c', 'd');
+    graph.add_edge('d', 'e');
+    graph.add_edge('e', 'd');
+    graph.add_edge('e', 'f');
+    graph.add_edge('f', 'f');
+    graph.add_edge('b', 'h');
+    graph.add_edge('g', 'a');
+    graph.add_edge('f', 'g');
+    graph.remove_vertex('g');
+
+    const Components components = strongly_connected_components(graph);
+    const auto label = [&graph, &components](const char vertex) {
+        return components.labels[graph.id_of(vertex)];
+    };
+    if (components.count != 4 || label('a') != label('b') || label('b') != label('c') || label('d') != label('e') ||
+        label('a') == label('d') || label('f') == label('d') || label('h') == label('a') || label('a') > label('d') ||
+        label('d') > label('f') || label('a') > label('h') || components.labels[6] != NO_COMPONENT) {
+        return false;
+    }
+
+    // a cycle through a million vertices, on the graph and on its snapshot
+    constexpr size_t chainLength = 1000000;
+    GraphAdjacencyList<size_t> chain;
+    for (size_t i = 0; i < chainLength; ++i) {
+        chain.add_vertex(i);
+    }
+    for (size_t i = 0; i + 1 < chainLength; ++i) {
+        chain.add_edge(i, i + 1);
+    }
+    const Components path = strongly_connected_components(chain);
+    chain.add_edge(chainLength - 1, 0);
+    const Components cycle = strongly_connected_components(chain.freeze());
+    return path.count == chainLength && path.labels.front() == 0 && path.labels.back() == chainLength - 1 && cycle.count == 1 &&
+           std::ranges::all_of(cycle.labels, [](const size_t label) {
+               return label == 0;
+           });
+}
+
+bool test_StronglyConnectedComponents2() {
+    // Test the components of a random graph against reachability in both directions, and the topological sort of DAGs
+    constexpr size_t vertexCount = 300;
+    GraphAdjacencyList<size_t> graph;
+    GraphAdjacencyList<size_t> dag;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+        dag.add_vertex(i);
+    }
+    std::uint64_t state = 29;
+    for (size_t i = 0; i < vertexCount * 3 / 2; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const size_t source = (state >> 20U) % vertexCount;
+        const size_t target = (state >> 40U) % vertexCount;
+        graph.set_edge_weight(source, target, 1.0);
+        // edges that go up in a permutation of the ids make a DAG
+        if (source != target) {
+            dag.set_edge_weight((std::min(source, target) * 7) % vertexCount, (std::max(source, target) * 7) % vertexCount, 1.0);
+        }
+    }
+
+    const Components components = strongly_connected_components(graph);
+    TraversalState state1(vertexCount);
+    TraversalState state2(vertexCount);
+    for (VertexId source = 0; source < vertexCount; ++source) {
+        state1.reset();
+        depth_first_search(graph, source, state1, [](VertexId) {});
+        for (VertexId target = 0; target < vertexCount; ++target) {
+            state2.reset();
+            depth_first_search(graph, target, state2, [](VertexId) {});
+            const bool together = state1.visited(target) && state2.visited(source);
+            if (together != (components.labels[source] == components.labels[target])) {
+                return false;
+            }
+        }
+        bool ordered = true;
+        graph.for_each_neighbor(source, [&components, &ordered, source](const VertexId neighbor, double) {
+            ordered = ordered && components.labels[source] <= components.labels[neighbor];
+        });
+        if (!ordered) {
+            return false;
+        }
+    }
+
+    const std::optional<std::vector<VertexId>> order = topological_sort(dag);
+    if (!order || order->size() != vertexCount) {
+        return false;
+    }
+    std::vector<size_t> positions(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        positions[(*order)[i]] = i;
+    }
+    for (VertexId id = 0; id < vertexCount; ++id) {
+        bool ordered = true;
+        dag.for_each_neighbor(id, [&positions, &ordered, id](const VertexId neighbor, double) {
+            ordered = ordered && positions[id] < positions[neighbor];
+        });
+        if (!ordered) {
+            return false;
+        }
+    }
+    GraphAdjacencyList<int> loop;
+    loop.add_vertex(1);
+    loop.add_edge(1, 1);
+    return components.count > 1 && components.count < vertexCount && !topological_sort(graph).has_value() && !topological_sort(loop).has_value() &&
+           topological_sort(dag.freeze()).has_value();
+}
+
+bool test_MinimumSpanningForest1() {
+    // Test both algorithms on a small graph with two components, a self-loop, an edge in both directions and a removed vertex
+    GraphAdjacencyList<char> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (const char vertex : {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'}) {
+        graph.add_vertex(vertex);
+    }
+    graph.set_edge_weight('a', 'b', 4.0);
+    graph.set_edge_weight('b', 'a', 1.0);
+    graph.set_edge_weight('a', 'c', 3.0);
+    graph.set_edge_weight('b', 'c', 2.0);
+    graph.set_edge_weight('c', 'd', 5.0);
+    graph.set_edge_weight('b', 'd', 6.0);
+    graph.set_edge_weight('d', 'd', 0.5);
+    graph.set_edge_weight('e', 'f', 7.0);
+    graph.set_edge_weight('f', 'h', 2.0);
+    graph.set_edge_weight('e', 'h', 1.0);
+    graph.set_edge_weight('g', 'a', 0.1);
+    graph.set_edge_weight('g', 'e', 0.1);
+    graph.remove_vertex('g');
+
+    // {b-a 1, b-c 2, c-d 5} and {e-h 1, f-h 2}
+    const auto weights = [](const SpanningForest& forest) {
+        std::vector<double> result;
+        for (const Edge<VertexId>& edge : forest.edges) {
+            result.push_back(edge.weight);
+        }
+        std::ranges::sort(result);
+        return result;
+    };
+    const std::vector<double> expected{1.0, 1.0, 2.0, 2.0, 5.0};
+    for (const size_t threads : {1, 3}) {
+        const SpanningForest sorted = kruskal(graph, threads);
+        const SpanningForest merged = boruvka(graph, threads);
+        if (sorted.weight != 11.0 || merged.weight != 11.0 || weights(sorted) != expected || weights(merged) != expected ||
+            !std::ranges::is_sorted(sorted.edges, {}, &Edge<VertexId>::weight)) {
+            return false;
+        }
+    }
+    return kruskal(GraphAdjacencyList<int>{}).edges.empty() && boruvka(GraphAdjacencyList<int>{}).edges.empty() &&
+           edge_list(graph, 2).size() == 10;
+}
+
+bool test_MinimumSpanningForest2() {
+    // Test both algorithms against Prim's algorithm on a random graph with many equal weights, for several thread counts
+    constexpr size_t vertexCount = 2000;
+    GraphAdjacencyList<size_t> graph;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        graph.add_vertex(i);
+    }
+    std::uint64_t state = 31;
+    for (size_t i = 0; i < vertexCount * 2; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        graph.set_edge_weight((state >> 20U) % vertexCount, (state >> 40U) % vertexCount, static_cast<double>(state % 8));
+    }
+
+    // Prim's algorithm from every vertex not yet in a tree, on the undirected graph
+    std::vector<std::vector<std::pair<VertexId, double>>> undirected(vertexCount);
+    for (VertexId id = 0; id < vertexCount; ++id) {
+        graph.for_each_neighbor(id, [&undirected, id](const VertexId neighbor, const double weight) {
+            undirected[id].emplace_back(neighbor, weight);
+            undirected[neighbor].emplace_back(id, weight);
+        });
+    }
+    double expected = 0.0;
+    std::vector<bool> inTree(vertexCount);
+    for (VertexId root = 0; root < vertexCount; ++root) {
+        if (inTree[root]) {
+            continue;
+        }
+        AddressableMinHeap heap(vertexCount);
+        heap.push_or_decrease(root, 0.0);
+        while (!heap.empty()) {
+            const auto [weight, id] = heap.pop();
+            inTree[id] = true;
+            expected += weight;
+            for (const auto& [neighbor, edgeWeight] : undirected[id]) {
+                if (!inTree[neighbor]) {
+                    heap.push_or_decrease(neighbor, edgeWeight);
+                }
+            }
+        }
+    }
+
+    const size_t treeCount = connected_components(graph, 1).count;
+    for (const size_t threads : {1, 2, 5}) {
+        for (const SpanningForest& forest : {kruskal(graph, threads), boruvka(graph, threads)}) {
+            UnionFind sets(vertexCount);
+            double weight = 0.0;
+            for (const Edge<VertexId>& edge : forest.edges) {
+                if (!sets.unite(edge.source, edge.target) || graph.get_edge_weight(edge.source, edge.target) != edge.weight) {
+                    return false;
+                }
+                weight += edge.weight;
+            }
+            if (forest.weight != expected || weight != expected || forest.edges.size() != vertexCount - treeCount) {
+                return false;
+            }
+        }
+    }
+    return treeCount > 1;
+}
+
+bool test_MinimumSpanningForest3() {
+    // Test Borůvka's algorithm with more threads than vertices and than candidate edges
+    GraphAdjacencyList<int> graph;
+    for (int i = 0; i < 3; ++i) {
+        graph.add_vertex(i);
+    }
+    for (const auto& [source, target, weight] : {std::tuple{0, 1, 1.0}, std::tuple{1, 2, 2.0}, std::tuple{0, 2, 3.0}}) {
+        graph.set_edge_weight(source, target, weight);
+        graph.set_edge_weight(target, source, weight);
+    }
+    for (const size_t threads : {1, 2, 4, 8, 64}) {
+        const SpanningForest forest = boruvka(graph, threads);
+        if (forest.edges.size() != 2 || forest.weight != 3.0 || forest.weight != kruskal(graph, threads).weight) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_EdgeWeights1() {
+    // Test edges of weight 0 and narrow weight types on all representations, and their snapshots
+    GraphAdjacencyList<int, std::uint32_t> list;
+    GraphAdjacencyMatrix<int, std::uint32_t> matrix;
+    GraphIncidenceMatrix<int, std::uint32_t> dense;
+    GraphIncidenceMatrix<int, std::uint32_t> sparse(IncidenceStorage::Sparse);
+    GraphAdjacencyList<int> expected;
+    constexpr int vertexCount = 40;
+    for (Graph<int, std::uint32_t>* graph : std::initializer_list<Graph<int, std::uint32_t>*>{&list, &matrix, &dense, &sparse}) {
+        for (int i = 0; i < vertexCount; ++i) {
+            graph->add_vertex(i);
+        }
+        graph->set_edge_weight(0, 1, 0U);
+        graph->set_edge_weight(1, 1, 0U);
+        if (!graph->adjacent(0, 1) || graph->try_get_edge_weight(0, 1) != 0U || graph->neighbors(1) != std::vector<int>{1} ||
+            graph->try_get_edge_weight(1, 0).has_value()) {
+            return false;
+        }
+        graph->remove_edge(0, 1);
+        graph->remove_edge(1, 1);
+        if (graph->adjacent(0, 1) || graph->adjacent(1, 1) || graph->get_edge_weight(0, 1) != 0U) {
+            return false;
+        }
+        try {
+            graph->remove_edge(0, 1);
+            return false;
+        } catch (const EdgeNotFoundException&) {}
+
+        std::vector<Edge<int, std::uint32_t>> edges;
+        std::uint64_t state = 5;
+        for (int i = 0; i < vertexCount * 6; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            edges.push_back({static_cast<int>((state >> 20U) % vertexCount), static_cast<int>((state >> 40U) % vertexCount),
+                             static_cast<std::uint32_t>((state >> 33U) % 4)});
+        }
+        graph->add_edges(edges, DuplicatePolicy::Sum);
+        if (graph == &list) {
+            for (int i = 0; i < vertexCount; ++i) {
+                expected.add_vertex(i);
+            }
+            for (const Edge<int, std::uint32_t>& edge : edges) {
+                expected.set_edge_weight(edge.source, edge.target, expected.get_edge_weight(edge.source, edge.target) + edge.weight);
+            }
+        }
+    }
+
+    // edges of weight 0 are kept, and the shortest paths are the same as with double weights
+    const auto matches = [&expected](const auto& graph) {
+        for (int u = 0; u < vertexCount; ++u) {
+            for (int v = 0; v < vertexCount; ++v) {
+                const std::optional<double> weight = expected.try_get_edge_weight(u, v);
+                const auto actual = graph.try_get_edge_weight(u, v);
+                if (weight.has_value() != actual.has_value() || (weight && *weight != *actual)) {
+                    return false;
+                }
+            }
+        }
+        return dijkstra(graph, graph.id_of(0)).distances == dijkstra(expected, expected.id_of(0)).distances;
+    };
+    size_t zeroWeights = 0;
+    for (int u = 0; u < vertexCount; ++u) {
+        for (int v = 0; v < vertexCount; ++v) {
+            zeroWeights += expected.try_get_edge_weight(u, v) == 0.0 ? 1 : 0;
+        }
+    }
+    const GraphCSR<int, std::uint32_t> csr = matrix.freeze();
+    return zeroWeights > 0 && matches(list) && matches(matrix) && matches(dense) && matches(sparse) &&
+           csr.edge_count() == expected.freeze().edge_count() && csr.neighbor_weights(0).size() == csr.degree(0) &&
+           dijkstra(csr, csr.id_of(0)).distances == dijkstra(expected, expected.id_of(0)).distances;
+}
+
+bool test_EdgeWeights2() {
+    // Test unweighted graphs, and the memory taken by the adjacency matrix with every weight type
+    GraphAdjacencyList<int, Unweighted> list;
+    GraphAdjacencyMatrix<int, Unweighted> matrix;
+    constexpr int side = 12;
+    for (Graph<int, Unweighted>* graph : std::initializer_list<Graph<int, Unweighted>*>{&list, &matrix}) {
+        GraphBuilder<int, Unweighted> builder;
+        for (int i = 0; i < side * side; ++i) {
+            if (i % side != side - 1) {
+                builder.add_edge(i, i + 1).add_edge(i + 1, i);
+            }
+            if (i + side < side * side) {
+                builder.add_edge(i, i + side).add_edge(i + side, i);
+            }
+        }
+        builder.build_into(*graph, DuplicatePolicy::Sum);
+    }
+    // unweighted edges have a length of 1
+    const ShortestPaths paths = dijkstra(matrix, matrix.id_of(0));
+    const SpanningForest forest = kruskal(list);
+    if (paths.distances[matrix.id_of(side * side - 1)] != 2.0 * (side - 1) || forest.weight != side * side - 1.0 ||
+        dijkstra(list, list.id_of(0)).distances != paths.distances || list.freeze().edge_count() != 4 * side * (side - 1) ||
+        !matrix.adjacent(0, 1) || matrix.try_get_edge_weight(0, 2).has_value()) {
+        return false;
+    }
+
+    const auto bytes = [](auto graph) {
+        graph.reserve(1000);
+        return graph.matrix_bytes();
+    };
+    const size_t doubles = bytes(GraphAdjacencyMatrix<int>{});
+    const size_t floats = bytes(GraphAdjacencyMatrix<int, float>{});
+    const size_t bytesPerEdge = bytes(GraphAdjacencyMatrix<int, std::uint8_t>{});
+    const size_t bits = bytes(GraphAdjacencyMatrix<int, Unweighted>{});
+    return bits == 1000 * 16 * sizeof(std::uint64_t) && doubles == bits + 1000 * 1000 * sizeof(double) &&
+           floats == bits + 1000 * 1000 * sizeof(float) && bytesPerEdge == bits + 1000 * 1000 && doubles > 7 * bytesPerEdge;
+}
+
+bool test_PredecessorIndex1() {
+    // Test the predecessor queries with and without the index through weight updates, edge and vertex removals
+    GraphAdjacencyList<char> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (const char vertex : {'a', 'b', 'c', 'd'}) {
+        graph.add_vertex(vertex);
+    }
+    graph.set_edge_weight('a', 'c', 1.0);
+    graph.set_edge_weight('b', 'c', 2.0);
+    graph.set_edge_weight('c', 'c', 3.0);
+    graph.set_edge_weight('c', 'd', 4.0);
+    graph.remove_vertex('d');
+
+    const auto sorted = [](std::vector<char> vertices) {
+        std::ranges::sort(vertices);
+        return vertices;
+    };
+    // without the index, the queries probe every neighbor map
+    if (graph.has_predecessor_index() || sorted(graph.predecessors('c')) != std::vector<char>{'a', 'b', 'c'} || graph.in_degree(graph.id_of('c')) != 3 ||
+        graph.in_degree(graph.id_of('a')) != 0) {
+        return false;
+    }
+
+    // enabling the index purges the edge to the removed vertex, whose id is then reused
+    graph.set_predecessor_index(true);
+    const VertexId e = graph.add_vertex('e');
+    if (e != 3 || graph.in_degree(e) != 0 || graph.neighbors('c').size() != 1) {
+        return false;
+    }
+    graph.set_edge_weight('b', 'c', 5.0);
+    graph.set_edge_weight('e', 'a', 6.0);
+    graph.remove_edge('a', 'c');
+    double weightFromB = 0.0;
+    graph.for_each_predecessor(graph.id_of('c'), [&weightFromB](const VertexId id, const double weight) {
+        if (id == 1) {
+            weightFromB = weight;
+        }
+    });
+    if (sorted(graph.predecessors('c')) != std::vector<char>{'b', 'c'} || graph.in_degree(graph.id_of('c')) != 2 || weightFromB != 5.0 ||
+        graph.predecessors('a') != std::vector<char>{'e'}) {
+        return false;
+    }
+
+    // removing a vertex with the index deletes its edges in both directions and frees its id at once
+    graph.remove_vertex('c');
+    if (graph.in_degree(graph.id_of('b')) != 0 || !graph.neighbors('b').empty() || graph.add_vertex('f') != 2 || graph.in_degree(graph.id_of('f')) != 0) {
+        return false;
+    }
+
+    // renumbering keeps the index consistent
+    graph.set_edge_weight('f', 'e', 7.0);
+    graph.set_removal_mode(RemovalMode::Renumber);
+    graph.remove_vertex('a');
+    if (graph.id_of('e') != 2 || graph.predecessors('e') != std::vector<char>{'f'} || graph.in_degree(graph.id_of('f')) != 0) {
+        return false;
+    }
+    try {
+        static_cast<void>(graph.in_degree(VertexId{3}));
+        return false;
+    } catch (const VertexNotFoundException&) {
+    }
+
+    // a copy keeps the index, disabling it falls back to scanning
+    GraphAdjacencyList<char> copy = graph;
+    graph.set_predecessor_index(false);
+    return copy.has_predecessor_index() && copy.predecessors('e') == std::vector<char>{'f'} && graph.predecessors('e') == std::vector<char>{'f'} &&
+           graph.in_degree(graph.id_of('e')) == 1;
+}
+
+bool test_PredecessorIndex2() {
+    // Test the index against the outgoing edges after random updates in both removal modes, and reverse searches on it
+    constexpr size_t vertexCount = 300;
+    for (const RemovalMode mode : {RemovalMode::Tombstone, RemovalMode::Renumber}) {
+        GraphAdjacencyList<size_t> graph;
+        graph.set_removal_mode(mode);
+        for (size_t i = 0; i < vertexCount; ++i) {
+            graph.add_vertex(i);
+        }
+        std::uint64_t state = 47;
+        const auto next = [&state](const size_t bound) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return static_cast<size_t>((state >> 33U) % bound);
+        };
+        std::vector<Edge<size_t>> batch;
+        for (size_t i = 0; i < vertexCount * 4; ++i) {
+            batch.push_back({next(vertexCount), next(vertexCount), static_cast<double>(1 + next(9))});
+        }
+        graph.set_predecessor_index(true);
+        graph.add_edges(batch, DuplicatePolicy::Sum);
+        std::vector<size_t> values(vertexCount);
+        std::iota(values.begin(), values.end(), 0);
+        for (size_t step = 0; step < 2000; ++step) {
+            const size_t index = next(values.size());
+            const size_t u = values[index];
+            const size_t v = values[next(values.size())];
+            const size_t action = next(10);
+            if (action < 5) {
+                graph.set_edge_weight(u, v, static_cast<double>(1 + next(9)));
+            } else if (action < 8) {
+                if (graph.adjacent(u, v)) {
+                    graph.remove_edge(u, v);
+                }
+            } else if (action < 9 && u != v) {
+                graph.remove_vertex(u);
+                values[index] = values.back();
+                values.pop_back();
+            } else {
+                values.push_back(vertexCount + step);
+                graph.add_vertex(values.back());
+            }
+        }
+
+        // every outgoing edge must be indexed with its weight, and nothing else
+        std::vector<std::vector<std::pair<VertexId, double>>> expected(graph.id_bound());
+        for (VertexId id = 0; id < graph.id_bound(); ++id) {
+            if (graph.contains_id(id)) {
+                graph.for_each_neighbor(id, [&expected, id](const VertexId neighbor, const double weight) {
+                    expected[neighbor].emplace_back(id, weight);
+                });
+            }
+        }
+        for (VertexId id = 0; id < graph.id_bound(); ++id) {
+            if (!graph.contains_id(id)) {
+                continue;
+            }
+            std::vector<std::pair<VertexId, double>> actual;
+            graph.for_each_predecessor(id, [&actual](const VertexId predecessor, const double weight) {
+                actual.emplace_back(predecessor, weight);
+            });
+            std::ranges::sort(actual);
+            std::ranges::sort(expected[id]);
+            if (actual != expected[id] || graph.in_degree(id) != actual.size()) {
+                return false;
+            }
+        }
+
+        for (size_t query = 0; query < 20; ++query) {
+            const VertexId source = graph.id_of(values[next(values.size())]);
+            const VertexId target = graph.id_of(values[next(values.size())]);
+            const double distance = dijkstra(graph, source).distances[target];
+            if (bidirectional_dijkstra(graph, graph.reverse_view(), source, target).distance != distance ||
+                bidirectional_dijkstra(graph, source, target).distance != distance) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool test_NeighborTable1() {
+    // Test the flat neighbor table against std::unordered_map across the switches between scanning and hashing
+    std::uint64_t state = 59;
+    const auto next = [&state](const size_t bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<size_t>((state >> 33U) % bound);
+    };
+    NeighborTable<double> table;
+    std::unordered_map<VertexId, double> expected;
+    const auto same = [&table, &expected] {
+        if (table.size() != expected.size()) {
+            return false;
+        }
+        for (const std::pair<VertexId, double>& entry : table) {
+            const auto expectedIt = expected.find(entry.first);
+            if (expectedIt == expected.end() || expectedIt->second != entry.second || table.find(entry.first) == nullptr ||
+                *table.find(entry.first) != entry.second) {
+                return false;
+            }
+        }
+        return true;
+    };
+    // grow past the hashing threshold and shrink back below it several times, with clustered and spread out ids
+    for (size_t round = 0; round < 6; ++round) {
+        const size_t range = round % 2 == 0 ? 64 : 1000000;
+        const size_t target = round % 3 == 0 ? 12 : 300;
+        for (size_t step = 0; step < 4000; ++step) {
+            const VertexId id = next(range);
+            if (next(3) != 0 || expected.size() < target) {
+                table.insert_or_assign(id, static_cast<double>(step));
+                expected.insert_or_assign(id, static_cast<double>(step));
+            } else if (table.erase(id) != (expected.erase(id) == 1)) {
+                return false;
+            }
+            if (table.contains(id) != expected.contains(id)) {
+                return false;
+            }
+        }
+        if (!same()) {
+            return false;
+        }
+        while (expected.size() > round) {
+            const VertexId id = expected.begin()->first;
+            if (!table.erase(id) || table.erase(id)) {
+                return false;
+            }
+            expected.erase(id);
+        }
+        if (!same() || table.contains(1000001) || table.find(1000001) != nullptr) {
+            return false;
+        }
+    }
+
+    // renumbering drops the entries of removed ids
+    NeighborTable<int> numbered;
+    numbered.reserve(100);
+    for (VertexId id = 0; id < 100; ++id) {
+        numbered.insert_or_assign(id, static_cast<int>(id));
+    }
+    std::vector<VertexId> newIds(100, NO_VERTEX);
+    for (VertexId id = 0; id < 100; id += 2) {
+        newIds[id] = id / 2;
+    }
+    numbered.renumber(newIds);
+    if (numbered.size() != 50 || numbered.erase_if([](const std::pair<VertexId, int>& entry) { return entry.first >= 10; }) != 40) {
+        return false;
+    }
+    for (VertexId id = 0; id < 10; ++id) {
+        if (numbered.find(id) == nullptr || *numbered.find(id) != static_cast<int>(2 * id)) {
+            return false;
+        }
+    }
+
+    // a vertex with a hashed neighbor table through removals and renumbering
+    GraphAdjacencyList<int> graph;
+    for (int i = 0; i < 200; ++i) {
+        graph.add_vertex(i);
+        graph.set_edge_weight(0, i, i);
+    }
+    for (int i = 1; i < 200; i += 3) {
+        graph.remove_vertex(i);
+    }
+    size_t count = 0;
+    bool weightsMatch = true;
+    graph.for_each_neighbor(graph.id_of(0), [&](const VertexId id, const double weight) {
+        ++count;
+        weightsMatch = weightsMatch && weight == static_cast<double>(graph.value_of(id));
+    });
+    return count == graph.size() && weightsMatch && graph.get_edge_weight(0, 198) == 198.0 && !graph.try_get_edge_weight(0, 199).has_value();
+}
+
+bool test_BinaryFile3() {
+    // Test that graphs of strings and of string views round-trip through a binary file
+    GraphAdjacencyList<std::string> graph;
+    graph.set_removal_mode(RemovalMode::Tombstone);
+    for (int i = 0; i < 100; ++i) {
+        graph.add_vertex("vertex " + std::to_string(i * 3));
+    }
+    graph.add_vertex("");
+    for (int i = 0; i < 100; ++i) {
+        graph.set_edge_weight("vertex " + std::to_string(i * 3), "vertex " + std::to_string(i * 7 % 100 * 3), 1.0 + i);
+    }
+    graph.set_edge_weight("", "vertex 0", 0.5);
+    // the freed id gets an empty string in the file
+    graph.remove_vertex("vertex 30");
+
+    const std::string path = std::filesystem::temp_directory_path() / "graph_test_BinaryFile3.bin";
+    graph.save_binary(path);
+    const GraphCSR<std::string> expected = graph.freeze();
+    std::optional<GraphCSR<std::string>> loaded = GraphCSR<std::string>::load_mmap(path);
+    // the strings are copied, but the other vertex arrays stay mapped after the original is gone
+    const GraphCSR<std::string> transpose = loaded->transpose();
+    const GraphCSR<std::string> copy = *loaded;
+    loaded.reset();
+    const GraphCSR<std::string_view> views = GraphCSR<std::string_view>::load_mmap(path);
+    std::filesystem::remove(path);
+
+    if (copy.size() != expected.size() || copy.id_bound() != expected.id_bound() || views.size() != expected.size()) {
+        return false;
+    }
+    for (VertexId id = 0; id < expected.id_bound(); ++id) {
+        if (copy.contains_id(id) != expected.contains_id(id)) {
+            return false;
+        }
+        if (expected.contains_id(id) &&
+            (copy.value_of(id) != expected.value_of(id) || copy.id_of(expected.value_of(id)) != id || views.id_of(expected.value_of(id)) != id ||
+             !std::ranges::equal(copy.neighbor_ids(id), expected.neighbor_ids(id)) ||
+             !std::ranges::equal(views.neighbor_weights(id), expected.neighbor_weights(id)))) {
+            return false;
+        }
+    }
+    try {
+        static_cast<void>(copy.id_of("vertex 30"));
+        return false;
+    } catch (const VertexNotFoundException&) {}
+    try {
+        static_cast<void>(views.id_of("vertex 1"));
+        return false;
+    } catch (const VertexNotFoundException&) {}
+    return transpose.get_edge_weight("vertex 0", "") == 0.5 && copy.get_edge_weight("", "vertex 0") == 0.5;
+}
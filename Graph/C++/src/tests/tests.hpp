@@ -19,4 +19,85 @@ bool test_GraphIncidenceMatrix3();
 bool test_GraphIncidenceMatrix4();
 bool test_GraphIncidenceMatrix5();
 
+bool test_Dijkstra1();
+bool test_Dijkstra2();
+bool test_Dijkstra3();
+
+bool test_GraphCSR1();
+bool test_GraphCSR2();
+
+bool test_GraphLookup1();
+bool test_GraphLookup2();
+
+bool test_GraphIds1();
+bool test_GraphIds2();
+
+bool test_GraphTombstone1();
+bool test_GraphTombstone2();
+bool test_GraphTombstone3();
+
+bool test_GraphAdjacencyMatrixCapacity1();
+bool test_GraphAdjacencyMatrixCapacity2();
+
+bool test_GraphIncidenceSparse1();
+bool test_GraphIncidenceSparse2();
+
+bool test_NeighborRange1();
+bool test_NeighborRange2();
+
+bool test_TraversalState1();
+bool test_TraversalState2();
+bool test_TraversalState3();
+
+bool test_DirectionOptimizingBfs1();
+bool test_DirectionOptimizingBfs2();
+bool test_DirectionOptimizingBfs3();
+
+bool test_ConcurrentGraph1();
+bool test_ConcurrentGraph2();
+
+bool test_GraphAdjacencyBitMatrix1();
+bool test_GraphAdjacencyBitMatrix2();
+
+bool test_BulkEdges1();
+bool test_BulkEdges2();
+
+bool test_BinaryFile1();
+bool test_BinaryFile2();
+
+bool test_EdgeListReader1();
+bool test_EdgeListReader2();
+
+bool test_ConnectedComponents1();
+bool test_ConnectedComponents2();
+
+bool test_FloydWarshall1();
+bool test_FloydWarshall2();
+
+bool test_PageRank1();
+bool test_PageRank2();
+
+bool test_AStar1();
+bool test_BidirectionalDijkstra1();
+
+bool test_ContractionHierarchy1();
+bool test_ContractionHierarchy2();
+
+bool test_StronglyConnectedComponents1();
+bool test_StronglyConnectedComponents2();
+
+bool test_MinimumSpanningForest1();
+bool test_MinimumSpanningForest2();
+bool test_MinimumSpanningForest3();
+
+bool test_EdgeWeights1();
+bool test_EdgeWeights2();
+
+bool test_PredecessorIndex1();
+bool test_PredecessorIndex2();
+
+bool test_NeighborTable1();
+
+bool test_BinaryFile3();
+
 #endif // GRAPH_TESTS_HPP